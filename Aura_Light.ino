@@ -7,7 +7,17 @@
 #include "button_manager.h"
 #include "music_mode.h"
 #include "audio_analyzer.h"
+#include "audio_telemetry.h"
+#include "presence.h"
 #include "weather_animation.h"
+#include "palette.h"
+#include "curves.h"
+#include "payload_parser.h"
+#include "binary_command.h"
+#include "render_clock.h"
+#include "frame_dump.h"
+#include "profiler.h"
+#include "metrics.h"
 
 #define NUM_PIXELS 8
 #define SYSTEM_VERSION "2.2.0"
@@ -26,188 +36,543 @@ WeatherManager weatherManager;
 ButtonManager buttonManager;
 MusicMode musicMode;
 AudioAnalyzer audioAnalyzer;
+AudioTelemetry audioTelemetry;
+PresenceTracker presence;
 WeatherAnimation weatherAnimation;
+PaletteManager palettes;
 String systemCity = "London";
 ControllerMode currentController = MODE_LOCAL;
+unsigned long metricsIntervalS = METRICS_DEFAULT_INTERVAL_S;
 
-void mqttMessageReceived(char *topic, byte *payload, unsigned int length)
+// ============ MQTT 主题处理函数（在 registerTopicHandlers() 中注册）============
+
+void onController(const byte *payload, unsigned int length, uint8_t)
 {
-  String topicStr = String(topic);
+  PayloadSpan msg = PayloadSpan(payload, length).trim();
 
-  if (topicStr.endsWith("/controller"))
+  if (msg.equalsIgnoreCase("local"))
   {
-    char message[length + 1];
-    memcpy(message, payload, length);
-    message[length] = '\0';
-    String msg = String(message);
-    msg.toLowerCase();
+    currentController = MODE_LOCAL;
+    lightControl.setActive(true);
+    luminaireControl.setActive(false);
 
-    if (msg == "local")
-    {
-      currentController = MODE_LOCAL;
-      lightControl.setActive(true);
-      luminaireControl.setActive(false);
+    mqtt.publishInfo("controller", "local", true);
 
-      mqtt.publishInfo("controller", "local", true);
+    const char *currentState = lightControl.getStateString();
+    const char *currentMode = lightControl.getModeString();
+    mqtt.publish("status", currentState, true);
+    mqtt.publish("mode", currentMode, true);
 
-      const char *currentState = lightControl.getStateString();
-      const char *currentMode = lightControl.getModeString();
-      mqtt.publish("status", currentState, true);
-      mqtt.publish("mode", currentMode, true);
+    mqtt.publishInfo_Lighter_Number(lightControl.getNumPixels());
 
-      mqtt.publishInfo("lighter/number", String(lightControl.getNumPixels()).c_str(), true);
+    Serial.println("[System] Switched to LOCAL controller");
+    Serial.print("[System] State: ");
+    Serial.print(currentState);
+    Serial.print(", Mode: ");
+    Serial.println(currentMode);
 
-      Serial.println("[System] Switched to LOCAL controller");
-      Serial.print("[System] State: ");
-      Serial.print(currentState);
-      Serial.print(", Mode: ");
-      Serial.println(currentMode);
+    // 更新状态LED（Local模式下熄灭）
+    buttonManager.updateStatusLED();
+  }
+  else if (msg.equalsIgnoreCase("luminaire"))
+  {
+    currentController = MODE_LUMINAIRE;
+    lightControl.setActive(false);
+    luminaireControl.setActive(true);
 
-      // 更新状态LED（Local模式下熄灭）
-      buttonManager.updateStatusLED();
-    }
-    else if (msg == "luminaire")
-    {
-      currentController = MODE_LUMINAIRE;
-      lightControl.setActive(false);
-      luminaireControl.setActive(true);
+    mqtt.publishInfo("controller", "luminaire", true);
+
+    const char *currentState = luminaireControl.getStateString();
+    const char *currentMode = luminaireControl.getModeString();
+    mqtt.publish("status", currentState, true);
+    mqtt.publish("mode", currentMode, true);
 
-      mqtt.publishInfo("controller", "luminaire", true);
+    mqtt.publishInfo_Lighter_Number(luminaireControl.getNumLEDs());
 
-      const char *currentState = luminaireControl.getStateString();
-      const char *currentMode = luminaireControl.getModeString();
-      mqtt.publish("status", currentState, true);
-      mqtt.publish("mode", currentMode, true);
+    Serial.println("[System] Switched to LUMINAIRE controller");
+    Serial.print("[System] State: ");
+    Serial.print(currentState);
+    Serial.print(", Mode: ");
+    Serial.println(currentMode);
 
-      mqtt.publishInfo("lighter/number", String(luminaireControl.getNumLEDs()).c_str(), true);
+    // 更新状态LED（显示Luminaire状态）
+    buttonManager.updateStatusLED();
+  }
+}
 
-      Serial.println("[System] Switched to LUMINAIRE controller");
-      Serial.print("[System] State: ");
-      Serial.print(currentState);
-      Serial.print(", Mode: ");
-      Serial.println(currentMode);
+// 音频系统设置（全局，不分控制器）
+void onVolumeRange(const byte *payload, unsigned int length, uint8_t)
+{
+  PayloadSpan msg(payload, length);
 
-      // 更新状态LED（显示Luminaire状态）
-      buttonManager.updateStatusLED();
+  // 期望格式: "30,120" (minDb,maxDb)
+  PayloadSpan minStr, maxStr;
+  float minDb, maxDb;
+  if (msg.split(',', minStr, maxStr) && minStr.toFloat(minDb) && maxStr.toFloat(maxDb))
+  {
+    if (minDb >= 20 && minDb < maxDb && maxDb <= 130)
+    {
+      char echo[24];
+      msg.trim().copyTo(echo, sizeof(echo));
+      audioAnalyzer.setVolumeRange(minDb, maxDb);
+      mqtt.publishInfo("audio/volume_range", echo, true);
+
+      Serial.print("[Audio] Volume range updated: ");
+      Serial.print(minDb);
+      Serial.print(" - ");
+      Serial.print(maxDb);
+      Serial.println(" dB");
+    }
+    else
+    {
+      Serial.println("[Audio] Invalid volume range (must be 20-130 dB)");
     }
-    return;
   }
+}
 
-  // 音频系统设置（全局，不分控制器）
-  if (topicStr.endsWith("/audio/volume_range"))
+// 音频遥测发送频率（Hz，0 = 关闭，最高为分析频率）
+void onAudioRate(const byte *payload, unsigned int length, uint8_t)
+{
+  long hz;
+  if (!PayloadSpan(payload, length).trim().toInt(hz))
   {
-    char message[length + 1];
-    memcpy(message, payload, length);
-    message[length] = '\0';
-    String msg = String(message);
+    Serial.println("[Audio] Invalid telemetry rate");
+    return;
+  }
 
-    // 期望格式: "30,120" (minDb,maxDb)
-    int commaIndex = msg.indexOf(',');
-    if (commaIndex > 0)
-    {
-      float minDb = msg.substring(0, commaIndex).toFloat();
-      float maxDb = msg.substring(commaIndex + 1).toFloat();
+  char echo[8];
+  snprintf(echo, sizeof(echo), "%u", audioTelemetry.setRate(hz));
+  mqtt.publishInfo("audio/rate", echo, true);
 
-      if (minDb >= 20 && minDb < maxDb && maxDb <= 130)
-      {
-        audioAnalyzer.setVolumeRange(minDb, maxDb);
-        mqtt.publishInfo("audio/volume_range", msg.c_str(), true);
-
-        Serial.print("[Audio] Volume range updated: ");
-        Serial.print(minDb);
-        Serial.print(" - ");
-        Serial.print(maxDb);
-        Serial.println(" dB");
-      }
-      else
-      {
-        Serial.println("[Audio] Invalid volume range (must be 20-130 dB)");
-      }
-    }
+  Serial.print("[Audio] Telemetry rate: ");
+  Serial.print(echo);
+  Serial.println(" Hz");
+}
+
+// 运行指标发布间隔（秒，0 = 关闭，限制在 METRICS_MIN_INTERVAL_S..METRICS_MAX_INTERVAL_S）
+void onMetricsInterval(const byte *payload, unsigned int length, uint8_t)
+{
+  long seconds;
+  if (!PayloadSpan(payload, length).trim().toInt(seconds) || seconds < 0)
+  {
+    Serial.println("[Metrics] Invalid interval");
     return;
   }
 
-  // IDLE 颜色设置（全局，应用到两个控制器）
-  if (topicStr.endsWith("/idle/color"))
+  if (seconds > 0 && seconds < METRICS_MIN_INTERVAL_S)
   {
-    char message[length + 1];
-    memcpy(message, payload, length);
-    message[length] = '\0';
-    String colorStr = String(message);
+    seconds = METRICS_MIN_INTERVAL_S;
+  }
+  metricsIntervalS = seconds < METRICS_MAX_INTERVAL_S ? seconds : METRICS_MAX_INTERVAL_S;
 
-    // 验证颜色格式 #RRGGBB
-    if (colorStr.length() == 7 && colorStr.charAt(0) == '#')
-    {
-      // 转换为 uint32_t
-      long colorValue = strtol(colorStr.substring(1).c_str(), NULL, 16);
-      uint32_t color = (uint32_t)colorValue;
+  char echo[12];
+  snprintf(echo, sizeof(echo), "%lu", metricsIntervalS);
+  mqtt.publishInfo("metrics/interval", echo, true);
+
+  Serial.print("[Metrics] Interval: ");
+  Serial.print(echo);
+  Serial.println(" s");
+}
+
+// Dashboard 在线心跳："<viewerId>:1" / "<viewerId>:0"（见 presence.h）
+void onPresence(const byte *payload, unsigned int length, uint8_t)
+{
+  if (!presence.handleMessage(PayloadSpan(payload, length), millis()))
+  {
+    Serial.println("[Presence] Invalid message");
+  }
+}
 
-      // 同时应用到两个控制器
-      // 1. Local controller 通过它自己的 handleMQTTMessage 处理
-      lightControl.handleMQTTMessage(topic, payload, length);
+// IDLE 颜色设置（全局，应用到两个控制器）
+void onIdleColor(const byte *payload, unsigned int length, uint8_t)
+{
+  PayloadSpan colorStr = PayloadSpan(payload, length).trim();
+  uint32_t color;
 
-      // 2. Luminaire controller 直接设置颜色
-      luminaireControl.setIdleColor(color);
+  // 验证颜色格式 #RRGGBB
+  if (colorStr.length == 7 && colorStr[0] == '#' && colorStr.toHexColor(color))
+  {
 
-      // 如果 Luminaire 当前是 IDLE 模式且开启，立即更新显示
-      if (luminaireControl.isOn() && luminaireControl.getMode() == LUMI_MODE_IDLE)
-      {
-        // 重新应用 IDLE 颜色
-        int r = (color >> 16) & 0xFF;
-        int g = (color >> 8) & 0xFF;
-        int b = color & 0xFF;
-        luminaireControl.sendRGBToAll(r, g, b);
-
-        Serial.print("[Luminaire] IDLE color updated to: ");
-        Serial.println(colorStr);
-      }
+    // 同时应用到两个控制器
+    // 1. Local controller 通过它自己的 handleIdleColor 处理
+    lightControl.handleIdleColor(payload, length);
 
-      Serial.print("[System] IDLE color set to: ");
-      Serial.print(colorStr);
-      Serial.println(" (applied to both controllers)");
-    }
-    else
+    // 2. Luminaire controller 直接设置颜色
+    luminaireControl.setIdleColor(color);
+
+    // 如果 Luminaire 当前是 IDLE 模式且开启，立即更新显示
+    if (luminaireControl.isOn() && luminaireControl.getMode() == LUMI_MODE_IDLE)
     {
-      Serial.print("[System] Invalid IDLE color format: ");
-      Serial.println(colorStr);
+      // 重新应用 IDLE 颜色
+      int r = (color >> 16) & 0xFF;
+      int g = (color >> 8) & 0xFF;
+      int b = color & 0xFF;
+      luminaireControl.sendRGBToAll(r, g, b);
+
+      Serial.print("[Luminaire] IDLE color updated to: ");
+      colorStr.printTo(Serial);
+      Serial.println();
     }
-    return;
+
+    Serial.print("[System] IDLE color set to: ");
+    colorStr.printTo(Serial);
+    Serial.println(" (applied to both controllers)");
   }
+  else
+  {
+    Serial.print("[System] Invalid IDLE color format: ");
+    colorStr.printTo(Serial);
+    Serial.println();
+  }
+}
 
-  // 天气数据转发给Luminaire控制器（用于Weather模式可视化）
-  if (topicStr.endsWith("/info/weather"))
+// 调色板设置（全局，两个控制器共用）
+// 主题: /palette/<vu|spectrum|temperature|humidity|cloud>（每个用途单独注册，arg = PaletteRole）
+// 内容: 内置名称（如 "fire"、"default"），或 "#RRGGBB,#RRGGBB,..."（2-16 个颜色）
+void onPalette(const byte *payload, unsigned int length, uint8_t arg)
+{
+  PaletteRole role = (PaletteRole)arg;
+  if (palettes.handleMessage(role, PayloadSpan(payload, length)))
   {
-    char message[length + 1];
-    memcpy(message, payload, length);
-    message[length] = '\0';
-    String weatherJson = String(message);
+    char topic[32];
+    snprintf(topic, sizeof(topic), "palette/%s", PaletteManager::roleName(role));
+    mqtt.publishInfo(topic, palettes.getName(role), true);
+  }
+}
+
+// 呼吸 / 脉动曲线（全局）
+// 主题: /curve
+// 内容: "<idle|sun>:<linear|sine|ease|expo|heartbeat>"
+void onCurve(const byte *payload, unsigned int length, uint8_t)
+{
+  if (Curves::handleMessage(PayloadSpan(payload, length)))
+  {
+    for (uint8_t e = 0; e < CURVE_EFFECT_COUNT; e++)
+    {
+      CurveEffect effect = (CurveEffect)e;
+      char topic[24];
+      snprintf(topic, sizeof(topic), "curve/%s", Curves::effectName(effect));
+      mqtt.publishInfo(topic, Curves::curveName(Curves::selected(effect)), true);
+    }
+  }
+}
 
-    // 解析天气JSON并更新Luminaire控制器
-    Serial.println("[System] Weather data received, updating Luminaire...");
+// 伞灯帧录制 / 回放（start | stop | clear | status | replay [speed]）
+void onRecorder(const byte *payload, unsigned int length, uint8_t)
+{
+  luminaireControl.handleRecorderCommand(PayloadSpan(payload, length));
+}
 
-    // 简单解析主要字段（完整解析可以用ArduinoJson，这里简化处理）
-    // 格式示例: {"temp_C":"20","FeelsLikeC":"18","humidity":"65",...}
+// 伞灯组配置（一台设备驱动多把伞灯）
+// 主题: /luminaire/units
+// 内容: "<id>[@<画布起点>][:<旋转>][m],..."，例如 "16,17:3,18@30m"（m = 镜像）
+// 控制器渲染 伞灯数 × 12 条伞骨宽的画布，每把伞默认取画布的下一段
+void onLuminaireUnits(const byte *payload, unsigned int length, uint8_t)
+{
+  luminaireControl.handleUnitsCommand(PayloadSpan(payload, length));
+}
 
-    // 由于Arduino内存限制，这里直接调用updateWeatherData
-    // 实际解析在luminaire_controller中处理，或者这里提取关键值
-    luminaireControl.updateWeatherData(weatherJson);
+// 天气数据转发给Luminaire控制器（用于Weather模式可视化）
+void onWeather(const byte *payload, unsigned int length, uint8_t)
+{
+  // 解析天气JSON并更新Luminaire控制器
+  Serial.println("[System] Weather data received, updating Luminaire...");
 
-    Serial.println("[System] Weather data forwarded to Luminaire controller");
-    return;
+  // 格式示例: {"temp_C":"20","FeelsLikeC":"18","humidity":"65",...}
+  // 直接把原始字节交给 luminaire_controller 解析，不复制
+  luminaireControl.updateWeatherData(PayloadSpan(payload, length));
+
+  Serial.println("[System] Weather data forwarded to Luminaire controller");
+}
+
+// 刷新请求（Dashboard）："info" 重新发布 INFO，"all" 同时重新发布状态和模式
+void onRefresh(const byte *payload, unsigned int length, uint8_t)
+{
+  PayloadSpan msg = PayloadSpan(payload, length).trim();
+
+  mqtt.publishAllInfo(currentController == MODE_LOCAL ? lightControl.getNumPixels() : luminaireControl.getNumLEDs(),
+                      NEOPIXEL_PIN, SYSTEM_VERSION, systemCity.c_str());
+  mqtt.publishInfo("controller", currentController == MODE_LOCAL ? "local" : "luminaire", true);
+  char idleColor[8];
+  mqtt.publishInfo("idle/color", lightControl.getIdleColor(idleColor, sizeof(idleColor)), true);
+
+  char rate[8];
+  snprintf(rate, sizeof(rate), "%u", audioTelemetry.getRate());
+  mqtt.publishInfo("audio/rate", rate, true);
+
+  char interval[12];
+  snprintf(interval, sizeof(interval), "%lu", metricsIntervalS);
+  mqtt.publishInfo("metrics/interval", interval, true);
+
+  if (msg.equalsIgnoreCase("all"))
+  {
+    mqtt.publish(TOPIC_STATUS, currentController == MODE_LOCAL ? lightControl.getStateString() : luminaireControl.getStateString(), true);
+    mqtt.publish(TOPIC_MODE, currentController == MODE_LOCAL ? lightControl.getModeString() : luminaireControl.getModeString(), true);
   }
+}
+
+// 由当前控制器处理的命令（arg = ControllerCommand）
+enum ControllerCommand
+{
+  CMD_STATUS,
+  CMD_MODE,
+  CMD_DEBUG_COLOR,
+  CMD_DEBUG_BRIGHTNESS,
+  CMD_DEBUG_INDEX,
+  CMD_POWER_BUDGET
+};
 
+void onControllerCommand(const byte *payload, unsigned int length, uint8_t arg)
+{
   if (currentController == MODE_LOCAL)
   {
-    lightControl.handleMQTTMessage(topic, payload, length);
+    switch (arg)
+    {
+    case CMD_STATUS:
+      lightControl.handleStatus(payload, length);
+      break;
+    case CMD_MODE:
+      lightControl.handleMode(payload, length);
+      break;
+    case CMD_DEBUG_COLOR:
+      lightControl.handleDebugColor(payload, length);
+      break;
+    case CMD_DEBUG_BRIGHTNESS:
+      lightControl.handleDebugBrightness(payload, length);
+      break;
+    case CMD_DEBUG_INDEX:
+      lightControl.handleDebugIndex(payload, length);
+      break;
+    case CMD_POWER_BUDGET:
+      lightControl.handlePowerBudget(payload, length);
+      break;
+    }
   }
   else if (currentController == MODE_LUMINAIRE)
   {
-    luminaireControl.handleMQTTMessage(topic, payload, length);
+    switch (arg)
+    {
+    case CMD_STATUS:
+      luminaireControl.handleStatus(payload, length);
+      break;
+    case CMD_MODE:
+      luminaireControl.handleMode(payload, length);
+      break;
+    case CMD_DEBUG_COLOR:
+      luminaireControl.handleDebugColor(payload, length);
+      break;
+    case CMD_DEBUG_BRIGHTNESS:
+      luminaireControl.handleDebugBrightness(payload, length);
+      break;
+    case CMD_DEBUG_INDEX:
+      luminaireControl.handleDebugIndex(payload, length);
+      break;
+    case CMD_POWER_BUDGET:
+      luminaireControl.handlePowerBudget(payload, length);
+      break;
+    }
     // Luminaire 状态/模式可能已改变，更新状态LED
     buttonManager.updateStatusLED();
   }
 }
 
+// 以文本命令的形式交给已有的处理函数（二进制命令与文本主题行为一致）
+static void forwardText(void (*handler)(const byte *, unsigned int, uint8_t), const char *text, uint8_t arg = 0)
+{
+  handler((const byte *)text, strlen(text), arg);
+}
+
+// 二进制命令（格式见 binary_command.h）：一条消息里的所有命令按顺序执行
+void onBinaryCommand(const byte *payload, unsigned int length, uint8_t)
+{
+  static const char *STATUS_NAMES[] = {"off", "on"};
+  static const char *MODE_NAMES[] = {"timer", "weather", "idle", "music"};
+  static const char *CONTROLLER_NAMES[] = {"local", "luminaire"};
+
+  BinaryCommandReader reader(payload, length);
+  if (!reader.isValid())
+  {
+    Serial.print("[BinCmd] ✗ Unsupported version: ");
+    Serial.println(reader.getVersion());
+    return;
+  }
+
+  BinaryCommand cmd;
+  uint8_t applied = 0;
+  uint8_t skipped = 0;
+  bool stateChanged = false;
+
+  while (reader.next(cmd))
+  {
+    if (!BinaryCommandReader::hasValidLength(cmd))
+    {
+      Serial.print("[BinCmd] ✗ Skipped ");
+      Serial.print(BinaryCommandReader::typeName(cmd.type));
+      Serial.print(" (type 0x");
+      Serial.print(cmd.type, HEX);
+      Serial.print(", ");
+      Serial.print(cmd.length);
+      Serial.println(" bytes)");
+      skipped++;
+      continue;
+    }
+
+    const byte *v = cmd.value;
+    bool local = currentController == MODE_LOCAL;
+    bool ok = true;
+
+    switch (cmd.type)
+    {
+    case BIN_CMD_STATUS:
+      ok = v[0] <= 1;
+      if (ok)
+      {
+        forwardText(onControllerCommand, STATUS_NAMES[v[0]], CMD_STATUS);
+        stateChanged = true;
+      }
+      break;
+    case BIN_CMD_MODE:
+      ok = v[0] <= 3;
+      if (ok)
+      {
+        forwardText(onControllerCommand, MODE_NAMES[v[0]], CMD_MODE);
+        stateChanged = true;
+      }
+      break;
+    case BIN_CMD_CONTROLLER:
+      ok = v[0] <= 1;
+      if (ok)
+      {
+        forwardText(onController, CONTROLLER_NAMES[v[0]]);
+      }
+      break;
+    case BIN_CMD_IDLE_COLOR:
+    {
+      char hex[8];
+      snprintf(hex, sizeof(hex), "#%02X%02X%02X", v[0], v[1], v[2]);
+      forwardText(onIdleColor, hex);
+      break;
+    }
+    case BIN_CMD_VOLUME_RANGE:
+    {
+      char range[8];
+      snprintf(range, sizeof(range), "%u,%u", v[0], v[1]);
+      forwardText(onVolumeRange, range);
+      break;
+    }
+    case BIN_CMD_DEBUG_PIXELS:
+      if (local)
+      {
+        lightControl.debugSetPixels(v[0], v + 1, (cmd.length - 1) / 3);
+      }
+      else
+      {
+        luminaireControl.debugSetPixels(v[0], v + 1, (cmd.length - 1) / 3);
+      }
+      break;
+    case BIN_CMD_DEBUG_FILL:
+      if (local)
+      {
+        lightControl.debugFillRange(v[0], v[1], rgbPack(v[2], v[3], v[4]));
+      }
+      else
+      {
+        luminaireControl.debugFillRange(v[0], v[1], rgbPack(v[2], v[3], v[4]));
+      }
+      break;
+    case BIN_CMD_DEBUG_BRIGHTNESS:
+      if (local)
+      {
+        lightControl.debugBrightnessRange(v[0], v[1], v[2]);
+      }
+      else
+      {
+        luminaireControl.debugBrightnessRange(v[0], v[1], v[2]);
+      }
+      break;
+    case BIN_CMD_DEBUG_CLEAR:
+      if (local)
+      {
+        lightControl.clearDebugMode();
+      }
+      else
+      {
+        luminaireControl.clearDebug();
+      }
+      break;
+    }
+
+    if (ok)
+    {
+      applied++;
+    }
+    else
+    {
+      skipped++;
+    }
+  }
+
+  // 文本 status / mode 主题是保留消息，同步为新状态，避免重连时被旧值覆盖
+  if (stateChanged)
+  {
+    bool local = currentController == MODE_LOCAL;
+    mqtt.publish(TOPIC_STATUS, local ? lightControl.getStateString() : luminaireControl.getStateString(), true);
+    mqtt.publish(TOPIC_MODE, local ? lightControl.getModeString() : luminaireControl.getModeString(), true);
+  }
+
+  Serial.print("[BinCmd] ✓ ");
+  Serial.print(applied);
+  Serial.print(" commands applied");
+  if (skipped > 0 || reader.isTruncated())
+  {
+    Serial.print(", ");
+    Serial.print(skipped);
+    Serial.print(" skipped");
+    if (reader.isTruncated())
+    {
+      Serial.print(", truncated");
+    }
+  }
+  Serial.println();
+}
+
+// MQTT 重连完成：重新发布 INFO（状态 / 模式是保留消息，broker 上已有）
+void onMqttConnected()
+{
+  Serial.println("[System] ✓ MQTT reconnected, republishing info");
+  forwardText(onRefresh, "info");
+}
+
+// 注册所有订阅主题（连接 / 重连时由 MQTTManager 订阅）
+void registerTopicHandlers()
+{
+  mqtt.on("status", onControllerCommand, CMD_STATUS);
+  mqtt.on("mode", onControllerCommand, CMD_MODE);
+  mqtt.on("controller", onController);
+
+  mqtt.on("debug/color", onControllerCommand, CMD_DEBUG_COLOR);
+  mqtt.on("debug/brightness", onControllerCommand, CMD_DEBUG_BRIGHTNESS);
+  mqtt.on("debug/index", onControllerCommand, CMD_DEBUG_INDEX);
+  mqtt.on("power/budget", onControllerCommand, CMD_POWER_BUDGET);
+
+  mqtt.on("idle/color", onIdleColor);
+  mqtt.on("audio/volume_range", onVolumeRange);
+  mqtt.on("audio/rate", onAudioRate);
+  mqtt.on("presence", onPresence);
+  mqtt.on("metrics/interval", onMetricsInterval);
+  mqtt.on("info/weather", onWeather);
+  mqtt.on("refresh", onRefresh);
+  mqtt.on("cmd/bin", onBinaryCommand);
+
+  for (uint8_t role = 0; role < PALETTE_ROLE_COUNT; role++)
+  {
+    mqtt.on("palette/", onPalette, role, PaletteManager::roleName((PaletteRole)role));
+  }
+  mqtt.on("curve", onCurve);
+  mqtt.on("recorder", onRecorder);
+  mqtt.on("luminaire/units", onLuminaireUnits);
+}
+
 // 开机进度条 - 基于启动阶段
 Adafruit_NeoPixel *bootStrip = nullptr;
 int currentBootProgress = 0;
@@ -311,16 +676,11 @@ void setup()
   Serial.println("========================================\n");
 
   mqtt.begin();
-  mqtt.setCallback(mqttMessageReceived);
+  registerTopicHandlers();
 
   if (mqtt.connect())
   {
     Serial.println("[System] ✓ MQTT connected\n");
-
-    String controllerTopic = String(TOPIC_BASE) + "/controller";
-    mqtt.subscribe(controllerTopic.c_str());
-    Serial.print("[MQTT] ✓ Subscribed to: ");
-    Serial.println(controllerTopic);
   }
   else
   {
@@ -339,8 +699,9 @@ void setup()
   luminaireControl.setActive(false);
 
   // 同步两个控制器的 IDLE 颜色（使用 lightControl 的默认颜色）
-  String defaultIdleColor = lightControl.getIdleColor();
-  long colorValue = strtol(defaultIdleColor.substring(1).c_str(), NULL, 16);
+  char defaultIdleColor[8];
+  lightControl.getIdleColor(defaultIdleColor, sizeof(defaultIdleColor));
+  long colorValue = strtol(defaultIdleColor + 1, NULL, 16);
   luminaireControl.setIdleColor((uint32_t)colorValue);
   Serial.print("[System] IDLE color synchronized: ");
   Serial.println(defaultIdleColor);
@@ -358,6 +719,8 @@ void setup()
   // 配置控制器的 Music 模式
   lightControl.setMusicMode(&musicMode, &audioAnalyzer);
   luminaireControl.setMusicMode(&musicMode, &audioAnalyzer);
+  lightControl.setPaletteManager(&palettes);
+  luminaireControl.setPaletteManager(&palettes);
   updateBootProgress("Audio initialized");
   
   // 初始化并配置天气动画
@@ -376,9 +739,13 @@ void setup()
     mqtt.publishInfo("controller", "local", true);
 
     // 发布 IDLE 模式的初始颜色
-    mqtt.publishInfo("idle/color", lightControl.getIdleColor().c_str(), true);
+    char idleColor[8];
+    mqtt.publishInfo("idle/color", lightControl.getIdleColor(idleColor, sizeof(idleColor)), true);
   }
 
+  // 之后每次重连都重新发布 INFO（首次连接的发布在上面完成）
+  mqtt.setConnectCallback(onMqttConnected);
+
   Serial.println("\n[System] Initializing weather manager...");
   weatherManager.begin(&mqtt, systemCity);
   updateBootProgress("Weather initialized");
@@ -465,6 +832,7 @@ void setup()
 
 void loop()
 {
+  Metrics::loopTick();
 
   static unsigned long lastWiFiCheck = 0;
   if (millis() - lastWiFiCheck > 30000)
@@ -473,19 +841,7 @@ void loop()
     {
       Serial.println("\n[System] ✗ WiFi connection lost!");
       reconnectWiFi();
-
-      if (checkWiFiConnection() && !mqtt.isConnected())
-      {
-        Serial.println("[System] Reconnecting to MQTT...");
-        if (mqtt.reconnect())
-        {
-          Serial.println("[System] ✓ MQTT reconnected!");
-
-          mqtt.publishAllInfo(lightControl.getNumPixels(), NEOPIXEL_PIN, SYSTEM_VERSION, systemCity.c_str());
-          lightControl.publishState();
-          mqtt.publishInfo("controller", currentController == MODE_LOCAL ? "local" : "luminaire", true);
-        }
-      }
+      // MQTT 由 mqtt.loop() 的连接状态机自动重连，连上后 onMqttConnected() 重新发布 INFO
     }
     lastWiFiCheck = millis();
   }
@@ -532,18 +888,106 @@ void loop()
       mqtt.publishAllInfo(lightControl.getNumPixels(), NEOPIXEL_PIN, SYSTEM_VERSION, systemCity.c_str());
       Serial.println("[System] ✓ INFO re-published!");
     }
+    else if (command == "frame" || command == "f")
+    {
+      FrameDump::writeGrid(Serial, luminaireControl.getFrame(), luminaireControl.getLastRenderMicros());
+    }
+    else if (command == "polar" || command == "fp")
+    {
+      FrameDump::writePolar(Serial, luminaireControl.getFrame(), luminaireControl.getLastRenderMicros());
+    }
+#if PROFILER_ENABLED
+    else if (command == "profile" || command == "p")
+    {
+      Profiler::print(Serial);
+
+      char json[384];
+      Profiler::toJson(json, sizeof(json));
+      mqtt.publishInfo("profile", json, false);
+    }
+    else if (command == "profile reset" || command == "p reset")
+    {
+      Profiler::reset();
+      Serial.println("[System] ✓ Profile counters reset");
+    }
+#endif
+    else if (command == "queue" || command == "q")
+    {
+      mqtt.printConnectionStatus(Serial);
+      mqtt.printQueueStatus(Serial);
+    }
+    else if (command == "metrics" || command == "m")
+    {
+      char json[METRICS_JSON_SIZE];
+      Metrics::toJson(json, sizeof(json), 0);
+      Serial.println(json);
+    }
+    else if (command.startsWith("rec "))
+    {
+      luminaireControl.handleRecorderCommand(command.c_str() + 4);
+    }
+    else if (command.startsWith("tick"))
+    {
+      // "tick 50" 冻结渲染时钟并前进 50ms，"tick real" 恢复实时
+      PayloadSpan arg = PayloadSpan(command.c_str() + 4).trim();
+      long ms = 0;
+      if (arg.equals("real"))
+      {
+        renderClock.useRealTime();
+        Serial.println("[System] Render clock: real time");
+      }
+      else if (arg.isEmpty() || (arg.toInt(ms) && ms >= 0))
+      {
+        renderClock.advance(ms);
+        Serial.print("[System] Render clock frozen at ");
+        Serial.print(renderClock.now());
+        Serial.println(" ms");
+      }
+      else
+      {
+        Serial.println("[System] ✗ Usage: tick <ms> | tick real");
+      }
+    }
     else if (command == "help" || command == "h")
     {
       Serial.println("\n=== Serial Commands ===");
       Serial.println("  r / republish  - Re-publish status and mode");
       Serial.println("  i / info       - Re-publish all INFO");
+      Serial.println("  f / frame      - Dump luminaire frame as PPM (grid)");
+      Serial.println("  fp / polar     - Dump luminaire frame as PPM (umbrella view)");
+      Serial.println("  tick <ms>      - Freeze render clock and step forward");
+      Serial.println("  tick real      - Resume real-time rendering");
+      Serial.println("  rec <cmd>      - Recorder: start|stop|clear|status|replay [speed]");
+      Serial.println("  q / queue      - Show MQTT publish queue statistics");
+      Serial.println("  m / metrics    - Print current metrics window");
+#if PROFILER_ENABLED
+      Serial.println("  p / profile    - Print render timings (and publish info/profile)");
+      Serial.println("  p reset        - Reset render timings");
+#endif
       Serial.println("  h / help       - Show this help");
       Serial.println("=======================\n");
     }
   }
 
+  // 有 Dashboard 在看时发送高频遥测，没有时降到低频
+  static uint8_t lastViewers = 0;
+  uint8_t viewers = presence.update(millis());
+  if (viewers != lastViewers)
+  {
+    Serial.print("[Presence] Viewers: ");
+    Serial.println(viewers);
+    audioTelemetry.setLowRate(viewers == 0);
+    if (mqtt.isConnected())
+    {
+      char count[4];
+      snprintf(count, sizeof(count), "%u", viewers);
+      mqtt.publishInfo("presence/viewers", count, true);
+    }
+    lastViewers = viewers;
+  }
+
   static unsigned long lastHeartbeat = 0;
-  if (millis() - lastHeartbeat > 300000)
+  if (millis() - lastHeartbeat > (viewers > 0 ? 60000UL : 1800000UL))
   {
     if (mqtt.isConnected())
     {
@@ -552,31 +996,38 @@ void loop()
     lastHeartbeat = millis();
   }
 
-  // 发布音频数据到 Dashboard（每 200ms）
-  static unsigned long lastAudioPublish = 0;
-  if (millis() - lastAudioPublish > 200)
+  // 定期发布运行指标（loop 延迟、发送/丢弃、内存、信号，格式见 metrics.cpp）
+  // 没有观看者时间隔至少 METRICS_IDLE_INTERVAL_S，窗口随之变长（文档里的 win 字段）
+  static unsigned long lastMetrics = 0;
+  unsigned long metricsPeriodS = metricsIntervalS;
+  if (viewers == 0 && metricsPeriodS > 0 && metricsPeriodS < METRICS_IDLE_INTERVAL_S)
+  {
+    metricsPeriodS = METRICS_IDLE_INTERVAL_S;
+  }
+  if (metricsPeriodS > 0 && millis() - lastMetrics >= metricsPeriodS * 1000UL)
   {
     if (mqtt.isConnected())
     {
-      // 获取音频数据
-      int rawADC = audioAnalyzer.getRawADC();
-      float volumeDb = audioAnalyzer.getVolumeDecibel();
-      int vuLevel = musicMode.getVULevel();
+      Metrics::set(MET_RSSI, WiFi.RSSI());
+      Metrics::set(MET_RECONNECTS, mqtt.getConnectCount() > 0 ? mqtt.getConnectCount() - 1 : 0);
+      Metrics::set(MET_QUEUE_DROPPED, mqtt.getDroppedCount());
 
-      // 获取虚拟频谱数据
-      float spectrum[12];
-      musicMode.getSpectrumData(spectrum);
+      char json[METRICS_JSON_SIZE];
+      Metrics::toJson(json, sizeof(json), millis() - lastMetrics);
+      mqtt.publishInfo("metrics", json, true);
+    }
+    Metrics::resetWindow();
+    lastMetrics = millis();
+  }
 
-      // 构建消息: "raw,volume,vuLevel,band0,band1,...,band11"
-      String audioMsg = String(rawADC) + "," + String(volumeDb, 1) + "," + String(vuLevel);
-      for (int i = 0; i < 12; i++)
-      {
-        audioMsg += "," + String(spectrum[i], 2);
-      }
+  // 发布音频遥测帧到 Dashboard（频率由 audio/rate 设置，格式见 audio_telemetry.h）
+  if (mqtt.isConnected() && audioTelemetry.due(audioAnalyzer.getAnalysisCount(), millis()))
+  {
+    float spectrum[NUM_BANDS];
+    musicMode.getSpectrumData(spectrum);
 
-      // 发布到 MQTT
-      mqtt.publishInfo("audio/data", audioMsg.c_str(), false);
-    }
-    lastAudioPublish = millis();
+    uint8_t frame[AUDIO_FRAME_SIZE];
+    audioTelemetry.encode(frame, audioAnalyzer.getRawADC(), audioAnalyzer.getVolumeDecibel(), musicMode.getVULevel(), spectrum);
+    mqtt.publish(TOPIC_BASE "/info/audio/frame", frame, sizeof(frame), false);
   }
 }
@@ -1,9 +1,11 @@
 #include "audio_analyzer.h"
+#include "metrics.h"
 
 AudioAnalyzer::AudioAnalyzer()
     : minDecibel(MIN_DB),
       maxDecibel(MAX_DB),
       lastFFTTime(0),
+      analysisCount(0),
       currentVolume(0.0),
       smoothedVolume(0.0),
       lastRawADC(0),
@@ -53,12 +55,15 @@ void AudioAnalyzer::loop()
     unsigned long currentTime = millis();
 
     // 每 30-50ms 执行一次 FFT（避免过于频繁）
-    if (currentTime - lastFFTTime >= 40)
+    if (currentTime - lastFFTTime >= AUDIO_ANALYSIS_INTERVAL_MS)
     {
         lastFFTTime = currentTime;
+        analysisCount++;
+        unsigned long analysisStart = micros();
         performFFT();
         updateBands();
         currentVolume = calculateVolume();
+        Metrics::time(MET_FFT, micros() - analysisStart);
 
         // 平滑总音量
         smoothedVolume = smoothedVolume * 0.7 + currentVolume * 0.3;
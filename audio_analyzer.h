@@ -12,6 +12,7 @@
 #define SAMPLES 64              // 采样点数，必须为 2 的整数次幂
 #define SAMPLING_FREQUENCY 4000 // 采样频率 4000 Hz（参考项目使用）
 #define NUM_BANDS 12            // 频段数量
+#define AUDIO_ANALYSIS_INTERVAL_MS 40 // 两次 FFT 之间的最短间隔（分析频率 25 Hz）
 
 class AudioAnalyzer
 {
@@ -26,6 +27,7 @@ private:
     double vImag[SAMPLES];           // FFT 虚部输入/输出
     unsigned int sampling_period_us; // 采样周期（微秒）
     unsigned long lastFFTTime;       // 上次 FFT 计算时间
+    uint32_t analysisCount;          // 已完成的分析次数（遥测据此判断是否有新数据）
 
     // 频段数据（12 频段）
     float spectrumBands[NUM_BANDS]; // 真实 FFT 频段强度（0.0 - 1.0）
@@ -61,6 +63,8 @@ public:
     // 获取频段数据（用于 Luminaire）
     void getVirtualBands(float bands[NUM_BANDS]) const;
     float getVirtualBand(int index) const;
+
+    uint32_t getAnalysisCount() const { return analysisCount; }
 };
 
 #endif
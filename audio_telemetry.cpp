@@ -0,0 +1,57 @@
+#include "audio_telemetry.h"
+
+AudioTelemetry::AudioTelemetry()
+    : seq(0),
+      rateHz(AUDIO_TELEMETRY_DEFAULT_HZ),
+      lowRate(true),
+      lastPublish(0),
+      lastAnalysis(0)
+{
+}
+
+uint8_t AudioTelemetry::setRate(int hz)
+{
+    rateHz = constrain(hz, 0, AUDIO_TELEMETRY_MAX_HZ);
+    return rateHz;
+}
+
+bool AudioTelemetry::due(uint32_t analysisCount, unsigned long now)
+{
+    if (rateHz == 0 || analysisCount == lastAnalysis)
+    {
+        return false;
+    }
+
+    unsigned long interval = lowRate ? AUDIO_TELEMETRY_IDLE_MS : 1000UL / rateHz;
+    if (now - lastPublish < interval)
+    {
+        return false;
+    }
+    lastPublish = now;
+    lastAnalysis = analysisCount;
+    return true;
+}
+
+static void writeInt16(uint8_t *out, int value)
+{
+    int16_t v = constrain(value, -32768, 32767);
+    out[0] = v & 0xFF;
+    out[1] = (v >> 8) & 0xFF;
+}
+
+void AudioTelemetry::encode(uint8_t *out, int raw, float volumeDb, int vuLevel, const float bands[NUM_BANDS])
+{
+    out[0] = AUDIO_FRAME_VERSION;
+    out[1] = seq & 0xFF;
+    out[2] = seq >> 8;
+    seq++;
+
+    writeInt16(out + 3, raw);
+    writeInt16(out + 5, (int)(volumeDb * 100.0f + (volumeDb >= 0 ? 0.5f : -0.5f)));
+    writeInt16(out + 7, vuLevel);
+
+    for (uint8_t i = 0; i < NUM_BANDS; i++)
+    {
+        out[9 + i] = (uint8_t)(constrain(bands[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
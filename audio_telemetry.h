@@ -0,0 +1,48 @@
+#ifndef AUDIO_TELEMETRY_H
+#define AUDIO_TELEMETRY_H
+
+#include <Arduino.h>
+#include "audio_analyzer.h"
+
+// 音频遥测帧（主题 <base>/info/audio/frame，二进制，小端）
+// 替代原来的 CSV 字符串（15 次 String 拼接 / 浮点转换），固定 21 字节：
+//   [0]      版本 = AUDIO_FRAME_VERSION
+//   [1-2]    序号 uint16（Dashboard 据此统计丢帧）
+//   [3-4]    原始 ADC 峰峰值 int16
+//   [5-6]    音量 int16，单位 0.01 dB
+//   [7-8]    VU 级别 int16（0-7）
+//   [9-20]   12 个频段 uint8（0-255 对应 0.0-1.0）
+// Dashboard 解码：dashboard/js/app.js（DataView）
+#define AUDIO_FRAME_VERSION 1
+#define AUDIO_FRAME_SIZE (9 + NUM_BANDS)
+#define AUDIO_TELEMETRY_DEFAULT_HZ 5 // 与原来的 200 ms 间隔相同
+#define AUDIO_TELEMETRY_MAX_HZ (1000 / AUDIO_ANALYSIS_INTERVAL_MS)
+#define AUDIO_TELEMETRY_IDLE_MS 10000 // 没有 Dashboard 在看时的发送间隔（见 presence.h）
+
+class AudioTelemetry
+{
+private:
+    uint16_t seq;
+    uint8_t rateHz; // 0 = 关闭
+    bool lowRate;   // 没有观看者：每 AUDIO_TELEMETRY_IDLE_MS 发送一帧
+    unsigned long lastPublish;
+    uint32_t lastAnalysis; // 上一帧对应的分析次数，没有新分析结果时不重复发送
+
+public:
+    AudioTelemetry();
+
+    // 发送频率（Hz），超过分析频率时取分析频率；返回实际值
+    uint8_t setRate(int hz);
+    uint8_t getRate() const { return rateHz; }
+
+    void setLowRate(bool low) { lowRate = low; }
+    bool isLowRate() const { return lowRate; }
+
+    // 有新的分析结果且到了发送间隔时返回 true
+    bool due(uint32_t analysisCount, unsigned long now);
+
+    // 编码一帧（序号自增）
+    void encode(uint8_t *out, int raw, float volumeDb, int vuLevel, const float bands[NUM_BANDS]);
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "binary_command.h"
+
+BinaryCommandReader::BinaryCommandReader(const byte *payload, unsigned int length)
+    : payload(payload),
+      length(length),
+      pos(1),
+      truncated(false)
+{
+}
+
+bool BinaryCommandReader::isValid() const
+{
+    return length > 0 && payload[0] == BINARY_COMMAND_VERSION;
+}
+
+bool BinaryCommandReader::next(BinaryCommand &command)
+{
+    if (!isValid() || pos >= length)
+    {
+        return false;
+    }
+
+    // 命令头或参数不完整：停止读取
+    if (pos + 2 > length || pos + 2 + payload[pos + 1] > length)
+    {
+        truncated = true;
+        pos = length;
+        return false;
+    }
+
+    command.type = payload[pos];
+    command.length = payload[pos + 1];
+    command.value = payload + pos + 2;
+    pos += 2 + command.length;
+    return true;
+}
+
+bool BinaryCommandReader::hasValidLength(const BinaryCommand &command)
+{
+    switch (command.type)
+    {
+    case BIN_CMD_STATUS:
+    case BIN_CMD_MODE:
+    case BIN_CMD_CONTROLLER:
+        return command.length == 1;
+    case BIN_CMD_IDLE_COLOR:
+        return command.length == 3;
+    case BIN_CMD_VOLUME_RANGE:
+        return command.length == 2;
+    case BIN_CMD_DEBUG_PIXELS:
+        return command.length >= 4 && (command.length - 1) % 3 == 0;
+    case BIN_CMD_DEBUG_FILL:
+        return command.length == 5;
+    case BIN_CMD_DEBUG_BRIGHTNESS:
+        return command.length == 3;
+    case BIN_CMD_DEBUG_CLEAR:
+        return command.length == 0;
+    default:
+        return false;
+    }
+}
+
+const char *BinaryCommandReader::typeName(uint8_t type)
+{
+    switch (type)
+    {
+    case BIN_CMD_STATUS:
+        return "status";
+    case BIN_CMD_MODE:
+        return "mode";
+    case BIN_CMD_CONTROLLER:
+        return "controller";
+    case BIN_CMD_IDLE_COLOR:
+        return "idle color";
+    case BIN_CMD_VOLUME_RANGE:
+        return "volume range";
+    case BIN_CMD_DEBUG_PIXELS:
+        return "debug pixels";
+    case BIN_CMD_DEBUG_FILL:
+        return "debug fill";
+    case BIN_CMD_DEBUG_BRIGHTNESS:
+        return "debug brightness";
+    case BIN_CMD_DEBUG_CLEAR:
+        return "debug clear";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef BINARY_COMMAND_H
+#define BINARY_COMMAND_H
+
+#include <Arduino.h>
+
+// 二进制控制协议（主题 <base>/cmd/bin，与文本主题并存）
+// 消息格式：
+//   version (uint8) = BINARY_COMMAND_VERSION
+//   之后是任意条 TLV 命令，按顺序执行：type (uint8) + len (uint8) + len 字节参数
+// 一条消息可以带多条命令（批量），例如一次写入 72 个调试像素，而不是 72 条文本消息。
+// 未知 type 按 len 跳过（新版本命令对旧固件无害）；长度不对的命令被忽略。
+// 整条消息（含主题）必须放得进 MQTT 接收缓冲区（512 字节，见 mqtt_manager.cpp）。
+// 主机端编码器：tools/aura_command.h，Dashboard：dashboard/js/binary.js
+#define BINARY_COMMAND_VERSION 1
+
+enum BinaryCommandType : uint8_t
+{
+    BIN_CMD_STATUS = 0x01,           // [on]                     0 = off, 1 = on
+    BIN_CMD_MODE = 0x02,             // [mode]                   0 timer, 1 weather, 2 idle, 3 music
+    BIN_CMD_CONTROLLER = 0x03,       // [controller]             0 local, 1 luminaire
+    BIN_CMD_IDLE_COLOR = 0x04,       // [r, g, b]
+    BIN_CMD_VOLUME_RANGE = 0x05,     // [minDb, maxDb]           整数 dB
+    BIN_CMD_DEBUG_PIXELS = 0x10,     // [start, r0, g0, b0, ...] 从 start 起逐像素写入颜色
+    BIN_CMD_DEBUG_FILL = 0x11,       // [start, count, r, g, b]  一段像素填同一颜色
+    BIN_CMD_DEBUG_BRIGHTNESS = 0x12, // [start, count, value]    一段像素设置亮度 0-255
+    BIN_CMD_DEBUG_CLEAR = 0x13       // []                       退出调试
+};
+
+struct BinaryCommand
+{
+    uint8_t type;
+    uint8_t length;
+    const byte *value; // 指向原始消息，只在处理函数执行期间有效
+};
+
+// 逐条读取命令（不复制数据）
+class BinaryCommandReader
+{
+private:
+    const byte *payload;
+    unsigned int length;
+    unsigned int pos;
+    bool truncated;
+
+public:
+    BinaryCommandReader(const byte *payload, unsigned int length);
+
+    // 版本号是否匹配（不匹配时 next() 直接返回 false）
+    bool isValid() const;
+    uint8_t getVersion() const { return length > 0 ? payload[0] : 0; }
+
+    // 读取下一条命令，没有更多时返回 false
+    bool next(BinaryCommand &command);
+
+    // 消息末尾有不完整的命令
+    bool isTruncated() const { return truncated; }
+
+    // 参数长度是否符合该命令的定义（未知命令返回 false）
+    static bool hasValidLength(const BinaryCommand &command);
+    static const char *typeName(uint8_t type);
+};
+
+#endif
@@ -236,7 +236,7 @@ void ButtonManager::handleShortPress()
             break;
         }
 
-        // 发送MQTT消息（LuminaireController通过handleMQTTMessage处理）
+        // 发送MQTT消息（LuminaireController 通过 /mode 主题的处理函数处理）
         mqtt->publishMode(nextModeStr.c_str());
 
         Serial.print("[Button]    ✓ Luminaire mode: ");
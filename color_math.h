@@ -0,0 +1,111 @@
+#ifndef COLOR_MATH_H
+#define COLOR_MATH_H
+
+#include <Arduino.h>
+
+// 定点颜色运算库
+// MKR WiFi 1010 (SAMD21) 没有 FPU，渲染路径上每像素的浮点乘法都是软件模拟，
+// 这里全部用 8 位定点替代：比例 0-255 表示 0.0-1.0。
+
+// value * scale / 256（scale = 255 时返回 value 本身）
+static inline uint8_t scale8(uint8_t value, uint8_t scale)
+{
+    return ((uint16_t)value * ((uint16_t)scale + 1)) >> 8;
+}
+
+// a 到 b 的线性插值，amount = 0 返回 a，255 返回 b
+static inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amount)
+{
+    int16_t weight = amount + (amount >> 7); // 0 - 256
+    return a + ((((int16_t)b - a) * weight) >> 8);
+}
+
+// 饱和加法
+static inline uint8_t qadd8(uint8_t a, uint8_t b)
+{
+    uint16_t sum = (uint16_t)a + b;
+    return sum > 255 ? 255 : (uint8_t)sum;
+}
+
+// 饱和减法
+static inline uint8_t qsub8(uint8_t a, uint8_t b)
+{
+    return a > b ? a - b : 0;
+}
+
+// 整数正弦：theta 0-255 为一整圈，返回 0-255（128 为零点）
+// 四分之一波表 + 对称展开，替代 sin() 浮点运算
+static inline uint8_t sin8(uint8_t theta)
+{
+    static const uint8_t QUARTER[65] = {
+        0, 3, 6, 9, 12, 16, 19, 22, 25, 28, 31, 34, 37, 40, 43, 46,
+        49, 51, 54, 57, 60, 63, 65, 68, 71, 73, 76, 78, 81, 83, 85, 88,
+        90, 92, 94, 96, 98, 100, 102, 104, 106, 107, 109, 111, 112, 113, 115, 116,
+        117, 118, 120, 121, 122, 122, 123, 124, 125, 125, 126, 126, 126, 127, 127, 127,
+        127};
+
+    uint8_t offset = theta & 0x3F;
+    uint8_t quadrant = theta >> 6;
+    uint8_t v = (quadrant & 1) ? QUARTER[64 - offset] : QUARTER[offset];
+    return (quadrant & 2) ? 128 - v : 128 + v;
+}
+
+// 缓入缓出（smoothstep：3t² - 2t³），0 和 255 处斜率为 0
+static inline uint8_t ease8InOut(uint8_t t)
+{
+    uint16_t t2 = ((uint16_t)t * t) >> 8;
+    return (uint8_t)((t2 * (768 - 2 * (uint16_t)t)) >> 8);
+}
+
+// ===== 打包 RGB888（0x00RRGGBB）=====
+
+static inline uint32_t rgbPack(uint8_t r, uint8_t g, uint8_t b)
+{
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+static inline uint8_t rgbRed(uint32_t color) { return (color >> 16) & 0xFF; }
+static inline uint8_t rgbGreen(uint32_t color) { return (color >> 8) & 0xFF; }
+static inline uint8_t rgbBlue(uint32_t color) { return color & 0xFF; }
+
+// 三通道同时缩放：R 和 B 放在同一个 32 位字里一次乘完
+static inline uint32_t rgbScale8(uint32_t color, uint8_t scale)
+{
+    uint32_t s = (uint32_t)scale + 1;
+    uint32_t rb = (((color & 0xFF00FF) * s) >> 8) & 0xFF00FF;
+    uint32_t g = (((color & 0x00FF00) * s) >> 8) & 0x00FF00;
+    return rb | g;
+}
+
+// 两个颜色线性插值，amount = 0 返回 c1，255 返回 c2
+static inline uint32_t rgbBlend8(uint32_t c1, uint32_t c2, uint8_t amount)
+{
+    uint32_t w2 = amount + (amount >> 7); // 0 - 256
+    uint32_t w1 = 256 - w2;
+    uint32_t rb = (((c1 & 0xFF00FF) * w1 + (c2 & 0xFF00FF) * w2) >> 8) & 0xFF00FF;
+    uint32_t g = (((c1 & 0x00FF00) * w1 + (c2 & 0x00FF00) * w2) >> 8) & 0x00FF00;
+    return rb | g;
+}
+
+// 逐通道饱和加法
+static inline uint32_t rgbAdd(uint32_t c1, uint32_t c2)
+{
+    return rgbPack(qadd8(rgbRed(c1), rgbRed(c2)),
+                   qadd8(rgbGreen(c1), rgbGreen(c2)),
+                   qadd8(rgbBlue(c1), rgbBlue(c2)));
+}
+
+// 写入 / 读取 RGB 帧缓冲中的一个像素
+static inline void rgbWrite(byte *pixel, uint32_t color)
+{
+    pixel[0] = rgbRed(color);
+    pixel[1] = rgbGreen(color);
+    pixel[2] = rgbBlue(color);
+}
+
+static inline uint32_t rgbRead(const byte *pixel)
+{
+    return rgbPack(pixel[0], pixel[1], pixel[2]);
+}
+
+#endif
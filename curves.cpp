@@ -0,0 +1,123 @@
+#include "curves.h"
+
+static const uint8_t CURVE_TABLE_SIZE = 64;
+
+// 线性三角波（原呼吸灯）
+static const uint8_t TABLE_LINEAR[CURVE_TABLE_SIZE] = {
+    0, 8, 16, 24, 32, 40, 48, 56, 64, 72, 80, 88, 96, 104, 112, 120,
+    128, 135, 143, 151, 159, 167, 175, 183, 191, 199, 207, 215, 223, 231, 239, 247,
+    255, 247, 239, 231, 223, 215, 207, 199, 191, 183, 175, 167, 159, 151, 143, 135,
+    128, 120, 112, 104, 96, 88, 80, 72, 64, 56, 48, 40, 32, 24, 16, 8};
+
+// 正弦 (1 - cos) / 2
+static const uint8_t TABLE_SINE[CURVE_TABLE_SIZE] = {
+    0, 1, 2, 5, 10, 15, 21, 29, 37, 47, 57, 67, 79, 90, 103, 115,
+    127, 140, 152, 165, 176, 188, 198, 208, 218, 226, 234, 240, 245, 250, 253, 254,
+    255, 254, 253, 250, 245, 240, 234, 226, 218, 208, 198, 188, 176, 165, 152, 140,
+    128, 115, 103, 90, 79, 67, 57, 47, 37, 29, 21, 15, 10, 5, 2, 1};
+
+// 缓入缓出三角波（smoothstep）
+static const uint8_t TABLE_EASE[CURVE_TABLE_SIZE] = {
+    0, 1, 3, 6, 11, 17, 24, 31, 40, 49, 59, 70, 81, 92, 104, 116,
+    128, 139, 151, 163, 174, 185, 196, 206, 215, 224, 231, 238, 244, 249, 252, 254,
+    255, 254, 252, 249, 244, 238, 231, 224, 215, 206, 196, 185, 174, 163, 151, 139,
+    128, 116, 104, 92, 81, 70, 59, 49, 40, 31, 24, 17, 11, 6, 3, 1};
+
+// 指数呼吸 exp(sin)，暗部停留更久，更接近人眼感受
+static const uint8_t TABLE_EXPO[CURVE_TABLE_SIZE] = {
+    0, 0, 1, 2, 3, 5, 7, 10, 14, 18, 22, 28, 34, 41, 49, 58,
+    69, 80, 92, 105, 119, 134, 149, 165, 180, 195, 209, 222, 233, 243, 249, 254,
+    255, 254, 249, 243, 233, 222, 209, 195, 180, 165, 149, 134, 119, 105, 92, 80,
+    69, 58, 49, 41, 34, 28, 22, 18, 14, 10, 7, 5, 3, 2, 1, 0};
+
+// 心跳：两次快速搏动后静止
+static const uint8_t TABLE_HEARTBEAT[CURVE_TABLE_SIZE] = {
+    1, 9, 37, 104, 199, 254, 219, 126, 49, 13, 3, 4, 13, 35, 74, 124,
+    163, 168, 137, 87, 44, 17, 5, 1, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+static const uint8_t *const TABLES[CURVE_TYPE_COUNT] = {
+    TABLE_LINEAR,
+    TABLE_SINE,
+    TABLE_EASE,
+    TABLE_EXPO,
+    TABLE_HEARTBEAT};
+
+static const char *const CURVE_NAMES[CURVE_TYPE_COUNT] = {"linear", "sine", "ease", "expo", "heartbeat"};
+static const char *const EFFECT_NAMES[CURVE_EFFECT_COUNT] = {"idle", "sun"};
+
+// 每个效果当前使用的曲线（默认值与原来的效果一致）
+static CurveType selectedCurves[CURVE_EFFECT_COUNT] = {CURVE_EASE, CURVE_SINE};
+
+// index 为表项（0-63），amount 为到下一项的插值比例；表是周期的，最后一项回绕到第一项
+static inline uint8_t lerpTable(const uint8_t *table, uint8_t index, uint8_t amount)
+{
+    uint8_t a = table[index];
+    uint8_t b = table[(index + 1) & (CURVE_TABLE_SIZE - 1)];
+    return a + ((((int16_t)b - a) * amount) >> 8);
+}
+
+uint8_t Curves::sample8(CurveType curve, uint8_t phase)
+{
+    return lerpTable(TABLES[curve], phase >> 2, (phase & 0x03) << 6);
+}
+
+uint8_t Curves::forEffect(CurveEffect effect, uint8_t phase)
+{
+    return sample8(selectedCurves[effect], phase);
+}
+
+void Curves::select(CurveEffect effect, CurveType curve)
+{
+    selectedCurves[effect] = curve;
+}
+
+CurveType Curves::selected(CurveEffect effect)
+{
+    return selectedCurves[effect];
+}
+
+bool Curves::handleMessage(const PayloadSpan &payload)
+{
+    PayloadSpan effectStr, curveStr;
+    if (payload.split(':', effectStr, curveStr))
+    {
+        effectStr = effectStr.trim();
+        curveStr = curveStr.trim();
+
+        for (uint8_t e = 0; e < CURVE_EFFECT_COUNT; e++)
+        {
+            if (!effectStr.equalsIgnoreCase(EFFECT_NAMES[e]))
+                continue;
+
+            for (uint8_t c = 0; c < CURVE_TYPE_COUNT; c++)
+            {
+                if (curveStr.equalsIgnoreCase(CURVE_NAMES[c]))
+                {
+                    selectedCurves[e] = (CurveType)c;
+                    Serial.print("[Curves] ✓ ");
+                    Serial.print(EFFECT_NAMES[e]);
+                    Serial.print(" -> ");
+                    Serial.println(CURVE_NAMES[c]);
+                    return true;
+                }
+            }
+        }
+    }
+
+    Serial.print("[Curves] ✗ Invalid curve setting: ");
+    payload.printTo(Serial);
+    Serial.println();
+    return false;
+}
+
+const char *Curves::curveName(CurveType curve)
+{
+    return CURVE_NAMES[curve];
+}
+
+const char *Curves::effectName(CurveEffect effect)
+{
+    return EFFECT_NAMES[effect];
+}
@@ -0,0 +1,45 @@
+#ifndef CURVES_H
+#define CURVES_H
+
+#include <Arduino.h>
+#include "payload_parser.h"
+
+// 周期亮度曲线（Flash 查找表，64 项，相邻项线性插值）
+// 输入一个周期内的相位（0-255），输出 0-255 亮度；相位 0 处均为最暗，可以无缝循环。
+// 每个效果可以通过 MQTT 单独选择曲线，运行时没有三角函数运算。
+enum CurveType
+{
+    CURVE_LINEAR,
+    CURVE_SINE,
+    CURVE_EASE,
+    CURVE_EXPO,
+    CURVE_HEARTBEAT,
+    CURVE_TYPE_COUNT
+};
+
+// 使用曲线的效果
+enum CurveEffect
+{
+    CURVE_EFFECT_IDLE, // IDLE 呼吸灯（本地灯带 + 伞灯）
+    CURVE_EFFECT_SUN,  // 晴天太阳脉动
+    CURVE_EFFECT_COUNT
+};
+
+namespace Curves
+{
+    uint8_t sample8(CurveType curve, uint8_t phase);
+
+    // 按效果当前选择的曲线取样
+    uint8_t forEffect(CurveEffect effect, uint8_t phase);
+
+    void select(CurveEffect effect, CurveType curve);
+    CurveType selected(CurveEffect effect);
+
+    // 处理 MQTT 消息 "<effect>:<curve>"，例如 "idle:heartbeat"
+    bool handleMessage(const PayloadSpan &payload);
+
+    const char *curveName(CurveType curve);
+    const char *effectName(CurveEffect effect);
+}
+
+#endif
@@ -4,10 +4,18 @@ import mqttManager from './mqtt.js';
 import ui from './ui.js';
 import { MQTT_CONFIG } from './config.js';
 import WeatherManager from './weather.js';
+import BinaryCommand from './binary.js';
+
+// 音频遥测帧（格式见固件 audio_telemetry.h）
+const AUDIO_FRAME_VERSION = 1;
+const AUDIO_FRAME_SIZE = 21;
+const AUDIO_BANDS = 12;
 
 class AuraLightDashboard {
     constructor() {
         this.weatherManager = new WeatherManager();
+        this.audioSeq = null;    // 上一帧音频遥测的序号
+        this.audioDropped = 0;   // 序号跳变累计的丢帧数
         this.init();
     }
 
@@ -47,7 +55,13 @@ class AuraLightDashboard {
         });
 
 
-        mqttManager.on('message', (topic, message) => {
+        mqttManager.on('message', (topic, message, raw) => {
+            // 音频帧是二进制、最高 25 帧/秒：直接解码，不写日志
+            if (topic.endsWith('/info/audio/frame')) {
+                this.handleAudioFrame(raw);
+                return;
+            }
+
             console.log('========================================');
             console.log('[App] RAW MESSAGE RECEIVED');
             console.log('[App] Topic:', topic);
@@ -142,6 +156,19 @@ class AuraLightDashboard {
         }
 
 
+        // 设备运行指标（JSON，见固件 metrics.cpp）
+        else if (topic.endsWith('/info/metrics')) {
+            try {
+                ui.updateMetrics(JSON.parse(message));
+            } catch (error) {
+                console.error('[App] Error parsing metrics:', error);
+            }
+        }
+
+        else if (topic.endsWith('/info/metrics/interval')) {
+            ui.elements.metricsIntervalInput.value = message;
+        }
+
         else if (topic.includes('/info/')) {
             console.log('[App] → INFO message');
 
@@ -156,31 +183,51 @@ class AuraLightDashboard {
     }
 
 
-    // 处理音频数据
+    // 音频遥测帧：21 字节小端，DataView 按固定偏移读取
+    handleAudioFrame(bytes) {
+        if (!bytes || bytes.byteLength < AUDIO_FRAME_SIZE) {
+            console.warn('[App] Audio frame too short:', bytes ? bytes.byteLength : 0);
+            return;
+        }
+
+        const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+        if (view.getUint8(0) !== AUDIO_FRAME_VERSION) {
+            console.warn('[App] Unknown audio frame version:', view.getUint8(0));
+            return;
+        }
+
+        // 序号 uint16 回绕；跳变很大视为设备重启
+        const seq = view.getUint16(1, true);
+        if (this.audioSeq !== null) {
+            const gap = (seq - this.audioSeq - 1) & 0xFFFF;
+            if (gap > 0 && gap < 1000) {
+                this.audioDropped += gap;
+                console.log(`[App] Audio frames dropped: ${gap} (total ${this.audioDropped})`);
+            }
+        }
+        this.audioSeq = seq;
+
+        const audioData = {
+            seq,
+            raw: view.getInt16(3, true),
+            volume: view.getInt16(5, true) / 100,
+            vuLevel: view.getInt16(7, true),
+            spectrum: []
+        };
+        for (let i = 0; i < AUDIO_BANDS; i++) {
+            audioData.spectrum.push(view.getUint8(9 + i) / 255);
+        }
+
+        ui.updateAudioMonitor(audioData);
+    }
+
+
+    // 处理音频文本消息（音量范围 / 遥测频率）
     handleAudioMessage(topic, message) {
         console.log('[App] handleAudioMessage called with:', topic, message);
         try {
-            if (topic.endsWith('/info/audio/data') || topic.endsWith('/audio/data')) {
-                console.log('[App] Processing audio/data...');
-                // 期望格式: "raw,volume,vuLevel,band0,band1,...,band11"
-                // 例如: "512,65.2,3,0.4,0.5,0.6,0.7,0.6,0.5,0.4,0.3,0.2,0.1,0.05,0.03"
-                const parts = message.split(',');
-                console.log('[App] Message parts:', parts);
-
-                const audioData = {
-                    raw: parseInt(parts[0]),
-                    volume: parseFloat(parts[1]),
-                    vuLevel: parseInt(parts[2]),
-                    spectrum: []
-                };
-
-                // 提取 12 个频段数据
-                for (let i = 3; i < 15 && i < parts.length; i++) {
-                    audioData.spectrum.push(parseFloat(parts[i]));
-                }
-
-                console.log('[App] Parsed audio data:', audioData);
-                ui.updateAudioMonitor(audioData);
+            if (topic.endsWith('/info/audio/rate')) {
+                console.log('[App] Audio telemetry rate:', message, 'Hz');
             } else if (topic.endsWith('/info/audio/volume_range') || topic.endsWith('/audio/volume_range')) {
                 // 音量范围更新: "30,120"
                 const parts = message.split(',');
@@ -312,6 +359,11 @@ class AuraLightDashboard {
         });
 
 
+        ui.elements.applyMetricsIntervalBtn.addEventListener('click', () => {
+            this.applyMetricsInterval();
+        });
+
+
         ui.elements.usernameInput.addEventListener('keypress', (e) => {
             if (e.key === 'Enter') {
                 this.connect();
@@ -333,14 +385,28 @@ class AuraLightDashboard {
             return;
         }
 
-        const message = `${range.minDb},${range.maxDb}`;
-        if (mqttManager.publish('/audio/volume_range', message)) {
-            ui.addLog('sent', 'audio/volume_range', message);
+        const command = new BinaryCommand().volumeRange(range.minDb, range.maxDb);
+        if (mqttManager.publishBinary(MQTT_CONFIG.topics.binaryCommand, command)) {
+            ui.addLog('sent', 'cmd/bin', `volume range ${range.minDb},${range.maxDb}`);
             console.log('[App] Volume range updated:', range);
         }
     }
 
 
+    applyMetricsInterval() {
+        const seconds = ui.getMetricsInterval();
+
+        if (isNaN(seconds) || seconds < 0) {
+            alert('Interval must be 0 (off) or a number of seconds');
+            return;
+        }
+
+        if (mqttManager.publish(MQTT_CONFIG.topics.metricsInterval, String(seconds))) {
+            ui.addLog('sent', 'metrics/interval', String(seconds));
+        }
+    }
+
+
     async connect() {
         const username = ui.getUsername();
 
@@ -420,23 +486,25 @@ class AuraLightDashboard {
     applyDebug() {
         const settings = ui.getDebugSettings();
 
+        // 颜色 + 亮度合并为一条二进制消息；"all" 一次覆盖全部像素
+        const all = settings.index === 'all';
+        const start = all ? 0 : parseInt(settings.index);
+        const count = all ? ui.state.pixelCount : 1;
 
-        const colorMsg = `${settings.index}:${settings.color}`;
-        mqttManager.publish(MQTT_CONFIG.topics.debugColor, colorMsg);
-        ui.addLog('sent', 'debug/color', colorMsg);
-
-
-        const brightnessMsg = `${settings.index}:${settings.brightness}`;
-        mqttManager.publish(MQTT_CONFIG.topics.debugBrightness, brightnessMsg);
-        ui.addLog('sent', 'debug/brightness', brightnessMsg);
+        const command = new BinaryCommand()
+            .debugFill(start, count, settings.color)
+            .debugBrightness(start, count, parseInt(settings.brightness));
 
-        ui.updateDebugStatus(true);
+        if (mqttManager.publishBinary(MQTT_CONFIG.topics.binaryCommand, command)) {
+            ui.addLog('sent', 'cmd/bin', `debug ${settings.index}: ${settings.color} @ ${settings.brightness}`);
+            ui.updateDebugStatus(true);
+        }
     }
 
 
     clearDebug() {
-        if (mqttManager.publish(MQTT_CONFIG.topics.debugIndex, 'clear')) {
-            ui.addLog('sent', 'debug/index', 'clear');
+        if (mqttManager.publishBinary(MQTT_CONFIG.topics.binaryCommand, new BinaryCommand().debugClear())) {
+            ui.addLog('sent', 'cmd/bin', 'debug clear');
             ui.updateDebugStatus(false);
         }
     }
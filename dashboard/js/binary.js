@@ -0,0 +1,86 @@
+// 二进制控制协议编码（格式见固件 binary_command.h，主题 /cmd/bin）
+// 消息 = 版本号 + 若干条 TLV 命令（type, len, value），一条消息里的命令按顺序执行
+
+export const BINARY_VERSION = 1;
+
+export const BinaryType = {
+    status: 0x01,
+    mode: 0x02,
+    controller: 0x03,
+    idleColor: 0x04,
+    volumeRange: 0x05,
+    debugPixels: 0x10,
+    debugFill: 0x11,
+    debugBrightness: 0x12,
+    debugClear: 0x13
+};
+
+const MODES = ['timer', 'weather', 'idle', 'music'];
+const CONTROLLERS = ['local', 'luminaire'];
+const MAX_PIXELS_PER_COMMAND = 84; // (255 - 1) / 3
+
+// "#RRGGBB" 或 0xRRGGBB → [r, g, b]
+function toRGB(color) {
+    const value = typeof color === 'string' ? parseInt(color.replace('#', ''), 16) : color;
+    return [(value >> 16) & 0xFF, (value >> 8) & 0xFF, value & 0xFF];
+}
+
+export class BinaryCommand {
+    constructor() {
+        this.bytes = [BINARY_VERSION];
+        this.count = 0; // 命令条数（日志用）
+    }
+
+    add(type, values = []) {
+        this.bytes.push(type, values.length, ...values);
+        this.count++;
+        return this;
+    }
+
+    status(on) {
+        return this.add(BinaryType.status, [on === true || on === 'on' ? 1 : 0]);
+    }
+
+    mode(name) {
+        return this.add(BinaryType.mode, [MODES.indexOf(name)]);
+    }
+
+    controller(name) {
+        return this.add(BinaryType.controller, [CONTROLLERS.indexOf(name)]);
+    }
+
+    idleColor(color) {
+        return this.add(BinaryType.idleColor, toRGB(color));
+    }
+
+    volumeRange(minDb, maxDb) {
+        return this.add(BinaryType.volumeRange, [minDb, maxDb]);
+    }
+
+    // colors: 颜色数组（"#RRGGBB" 或 0xRRGGBB），超过 84 个自动拆成多条命令
+    debugPixels(start, colors) {
+        for (let i = 0; i < colors.length; i += MAX_PIXELS_PER_COMMAND) {
+            const chunk = colors.slice(i, i + MAX_PIXELS_PER_COMMAND);
+            this.add(BinaryType.debugPixels, [start + i, ...chunk.flatMap(toRGB)]);
+        }
+        return this;
+    }
+
+    debugFill(start, count, color) {
+        return this.add(BinaryType.debugFill, [start, count, ...toRGB(color)]);
+    }
+
+    debugBrightness(start, count, value) {
+        return this.add(BinaryType.debugBrightness, [start, count, value]);
+    }
+
+    debugClear() {
+        return this.add(BinaryType.debugClear);
+    }
+
+    toBytes() {
+        return Uint8Array.from(this.bytes);
+    }
+}
+
+export default BinaryCommand;
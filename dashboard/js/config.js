@@ -12,6 +12,9 @@ export const MQTT_CONFIG = {
 
     getTopicBase: (username) => `student/CASA0014/${username}`,
 
+    // 观看者心跳间隔（设备 75 秒没收到就视为离开，见固件 presence.h）
+    presenceIntervalMs: 30000,
+
 
     topics: {
         status: '/status',
@@ -20,6 +23,10 @@ export const MQTT_CONFIG = {
         debugColor: '/debug/color',
         debugBrightness: '/debug/brightness',
         debugIndex: '/debug/index',
+        binaryCommand: '/cmd/bin',
+        audioRate: '/audio/rate',
+        presence: '/presence',
+        metricsInterval: '/metrics/interval',
 
 
         infoWifiSSID: '/info/wifi/ssid',
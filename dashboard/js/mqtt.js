@@ -7,6 +7,9 @@ class MQTTManager {
         this.client = null;
         this.username = '';
         this.connected = false;
+        this.viewerId = '';
+        this.presenceTimer = null;
+        this.unloadHooked = false;
         this.callbacks = {
             onConnect: null,
             onDisconnect: null,
@@ -26,15 +29,23 @@ class MQTTManager {
 
             
             try {
+                this.viewerId = `dashboard_${username}_${Date.now()}`;
                 const options = {
                     username: MQTT_CONFIG.username,
                     password: MQTT_CONFIG.password,
-                    clientId: `dashboard_${username}_${Date.now()}`,
+                    clientId: this.viewerId,
                     clean: true,
                     reconnectPeriod: 5000,
                     connectTimeout: 10000,
                     keepalive: 60,
-                    protocolVersion: 4  
+                    protocolVersion: 4,
+                    // 页面异常断开时由 broker 通知设备：这个观看者已离开
+                    will: {
+                        topic: MQTT_CONFIG.getFullTopic(username, MQTT_CONFIG.topics.presence),
+                        payload: `${this.viewerId}:0`,
+                        qos: 0,
+                        retain: false
+                    }
                 };
 
                 this.client = mqtt.connect(mqttUrl, options);
@@ -54,6 +65,7 @@ class MQTTManager {
 
                 
                 this.subscribeAll();
+                this.startPresence();
 
                 if (this.callbacks.onConnect) {
                     this.callbacks.onConnect();
@@ -67,8 +79,14 @@ class MQTTManager {
                 const msg = message.toString();
                 console.log(`[MQTT] ← Received: ${topic} = ${msg}`);
 
+                // 设备刚上线（重启 / 重连）时不知道有谁在看，立即发一次心跳
+                if (topic.endsWith('/status') && msg === 'online') {
+                    this.announcePresence(true);
+                }
+
+                // 第三个参数是原始字节（二进制主题用）
                 if (this.callbacks.onMessage) {
-                    this.callbacks.onMessage(topic, msg);
+                    this.callbacks.onMessage(topic, msg, message);
                 }
             });
 
@@ -85,6 +103,7 @@ class MQTTManager {
             this.client.on('close', () => {
                 console.log('[MQTT] ✗ Connection closed');
                 this.connected = false;
+                this.stopPresence();
                 if (this.callbacks.onDisconnect) {
                     this.callbacks.onDisconnect();
                 }
@@ -137,6 +156,8 @@ class MQTTManager {
     
     disconnect() {
         if (this.client) {
+            this.announcePresence(false);
+            this.stopPresence();
             this.client.end();
             this.connected = false;
         }
@@ -161,6 +182,56 @@ class MQTTManager {
         return true;
     }
 
+    // 观看者心跳（见固件 presence.h）：设备只在有观看者时发送高频遥测
+    announcePresence(online) {
+        if (!this.connected || !this.viewerId) {
+            return;
+        }
+        const topic = MQTT_CONFIG.getFullTopic(this.username, MQTT_CONFIG.topics.presence);
+        this.client.publish(topic, `${this.viewerId}:${online ? 1 : 0}`, { retain: false });
+    }
+
+    startPresence() {
+        this.stopPresence();
+        this.announcePresence(true);
+        this.presenceTimer = setInterval(() => this.announcePresence(true), MQTT_CONFIG.presenceIntervalMs);
+
+        // 正常关闭页面时不会触发 LWT，主动通知一次
+        if (!this.unloadHooked) {
+            window.addEventListener('beforeunload', () => this.announcePresence(false));
+            this.unloadHooked = true;
+        }
+    }
+
+    stopPresence() {
+        if (this.presenceTimer) {
+            clearInterval(this.presenceTimer);
+            this.presenceTimer = null;
+        }
+    }
+
+    // 二进制命令（BinaryCommand，见 binary.js），不保留
+    publishBinary(topicSuffix, command) {
+        if (!this.connected) {
+            console.error('[MQTT] Not connected');
+            return false;
+        }
+
+        const fullTopic = MQTT_CONFIG.getFullTopic(this.username, topicSuffix);
+        const bytes = command.toBytes();
+        // mqtt.js 的浏览器包提供 Buffer 时用 Buffer，否则直接发送 Uint8Array
+        const payload = typeof Buffer !== 'undefined' ? Buffer.from(bytes) : bytes;
+        this.client.publish(fullTopic, payload, { retain: false }, (err) => {
+            if (err) {
+                console.error(`[MQTT] Publish failed: ${fullTopic}`, err);
+            } else {
+                console.log(`[MQTT] Published: ${fullTopic} = ${command.count} commands, ${bytes.length} bytes`);
+            }
+        });
+
+        return true;
+    }
+
     
     on(event, callback) {
         if (this.callbacks.hasOwnProperty(`on${event.charAt(0).toUpperCase()}${event.slice(1)}`)) {
@@ -49,6 +49,18 @@ class UIManager {
         this.elements.infoSystemUptime = document.getElementById('infoSystemUptime');
         this.elements.infoLocationCity = document.getElementById('infoLocationCity');
 
+        // 设备运行指标
+        this.elements.metricsLoop = document.getElementById('metricsLoop');
+        this.elements.metricsFFT = document.getElementById('metricsFFT');
+        this.elements.metricsFrames = document.getElementById('metricsFrames');
+        this.elements.metricsPublish = document.getElementById('metricsPublish');
+        this.elements.metricsHeap = document.getElementById('metricsHeap');
+        this.elements.metricsLink = document.getElementById('metricsLink');
+        this.elements.metricsChart = document.getElementById('metricsChart');
+        this.elements.metricsIntervalInput = document.getElementById('metricsIntervalInput');
+        this.elements.applyMetricsIntervalBtn = document.getElementById('applyMetricsIntervalBtn');
+        this.metricsHistory = [];
+
 
         this.elements.lightVisualization = document.getElementById('lightVisualization');
 
@@ -143,6 +155,7 @@ class UIManager {
 
 
             this.elements.refreshInfoBtn.disabled = false;
+            this.elements.applyMetricsIntervalBtn.disabled = false;
             this.elements.turnOnBtn.disabled = false;
             this.elements.turnOffBtn.disabled = false;
             this.elements.modeButtons.forEach(btn => btn.disabled = false);
@@ -169,6 +182,7 @@ class UIManager {
 
 
             this.elements.refreshInfoBtn.disabled = true;
+            this.elements.applyMetricsIntervalBtn.disabled = true;
             this.elements.turnOnBtn.disabled = true;
             this.elements.turnOffBtn.disabled = true;
             this.elements.modeButtons.forEach(btn => btn.disabled = true);
@@ -295,6 +309,10 @@ class UIManager {
 
     updatePixelSelector() {
         this.elements.debugPixelIndex.innerHTML = '';
+        const allOption = document.createElement('option');
+        allOption.value = 'all';
+        allOption.textContent = 'All pixels';
+        this.elements.debugPixelIndex.appendChild(allOption);
         for (let i = 0; i < this.state.pixelCount; i++) {
             const option = document.createElement('option');
             option.value = i;
@@ -635,6 +653,97 @@ class UIManager {
     }
 
 
+    // 设备运行指标：{"loop":[n,p50,p99,max], "fft":[...], "frames":{...}, "pub":{...}, "heap", "heap_min", ...}
+    // 时间单位为微秒（p50 / p99 是 log2 分桶的上界估计）
+    updateMetrics(data) {
+        const ms = (us) => (us / 1000).toFixed(1);
+
+        if (data.loop) {
+            this.elements.metricsLoop.textContent = `${ms(data.loop[1])} / ${ms(data.loop[2])} / ${ms(data.loop[3])} ms`;
+        }
+        if (data.fft) {
+            this.elements.metricsFFT.textContent = `${ms(data.fft[1])} / ${ms(data.fft[2])} ms`;
+        }
+        if (data.frames) {
+            this.elements.metricsFrames.textContent = `${data.frames.local} / ${data.frames.luminaire} / ${data.frames.sent}`;
+        }
+        if (data.pub) {
+            this.elements.metricsPublish.textContent = `${data.pub.ok} / ${data.pub.fail} / ${data.pub.drop}`;
+        }
+        if (data.heap !== undefined) {
+            this.elements.metricsHeap.textContent = `${data.heap} B (${data.heap_min} B)`;
+        }
+        if (data.rssi !== undefined) {
+            this.elements.metricsLink.textContent = `${data.rssi} dBm / ${data.reconnects}`;
+        }
+
+        // 同一条保留消息（重连后再次收到）不重复记录
+        const last = this.metricsHistory[this.metricsHistory.length - 1];
+        if (!last || last.up !== data.up) {
+            this.metricsHistory.push({
+                up: data.up,
+                loopP99: data.loop ? data.loop[2] / 1000 : 0,
+                heap: (data.heap_min || 0) / 1024
+            });
+            if (this.metricsHistory.length > 60) {
+                this.metricsHistory.shift();
+            }
+        }
+
+        this.drawMetricsChart();
+    }
+
+
+    // 两条折线各自按最大值缩放：loop p99（蓝）、内存低水位（绿）
+    drawMetricsChart() {
+        const canvas = this.elements.metricsChart;
+        if (!canvas) {
+            return;
+        }
+
+        const ctx = canvas.getContext('2d');
+        const width = canvas.width;
+        const height = canvas.height;
+        const history = this.metricsHistory;
+
+        ctx.clearRect(0, 0, width, height);
+        ctx.strokeStyle = '#d1d5db';
+        ctx.strokeRect(0, 0, width, height);
+
+        if (history.length < 2) {
+            return;
+        }
+
+        const drawLine = (key, color) => {
+            const max = Math.max(...history.map(point => point[key]), 1);
+            ctx.strokeStyle = color;
+            ctx.lineWidth = 2;
+            ctx.beginPath();
+            history.forEach((point, i) => {
+                const x = (i / (history.length - 1)) * (width - 8) + 4;
+                const y = height - 4 - (point[key] / max) * (height - 8);
+                if (i === 0) {
+                    ctx.moveTo(x, y);
+                } else {
+                    ctx.lineTo(x, y);
+                }
+            });
+            ctx.stroke();
+            ctx.fillStyle = color;
+            ctx.font = '11px monospace';
+            ctx.fillText(max.toFixed(1), 6, key === 'loopP99' ? 14 : 28);
+        };
+
+        drawLine('loopP99', '#3498db');
+        drawLine('heap', '#27ae60');
+    }
+
+
+    getMetricsInterval() {
+        return parseInt(this.elements.metricsIntervalInput.value);
+    }
+
+
     getVolumeRange() {
         return {
             minDb: parseInt(this.elements.minDbInput.value),
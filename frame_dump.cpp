@@ -0,0 +1,85 @@
+#include "frame_dump.h"
+#include "render_clock.h"
+
+// 极坐标图：每个位置占 2 像素半径，外圈留 1 像素边
+static const uint8_t POLAR_STEP = 2;
+static const uint8_t POLAR_SIZE = (Umbrella::NUM_POSITIONS + 1) * POLAR_STEP * 2 + 1;
+
+static void writeHeader(Print &out, int width, int height, unsigned long renderMicros)
+{
+    out.println("P3");
+    out.print("# aura luminaire frame t=");
+    out.print(renderClock.now());
+    out.print("ms render_us=");
+    out.println(renderMicros);
+    out.print(width);
+    out.print(' ');
+    out.println(height);
+    out.println("255");
+}
+
+static void writePixel(Print &out, const byte *p)
+{
+    out.print(p[0]);
+    out.print(' ');
+    out.print(p[1]);
+    out.print(' ');
+    out.print(p[2]);
+    out.print(' ');
+}
+
+void FrameDump::writeGrid(Print &out, const byte *frame, unsigned long renderMicros)
+{
+    writeHeader(out, Umbrella::NUM_RIBS, Umbrella::NUM_POSITIONS, renderMicros);
+
+    for (uint8_t pos = 0; pos < Umbrella::NUM_POSITIONS; pos++)
+    {
+        for (uint8_t rib = 0; rib < Umbrella::NUM_RIBS; rib++)
+        {
+            writePixel(out, frame + Umbrella::index(rib, pos) * 3);
+        }
+        out.println();
+    }
+}
+
+void FrameDump::writePolar(Print &out, const byte *frame, unsigned long renderMicros)
+{
+    // 预先计算每个 LED 在图像中的坐标（仅调试用，浮点三角函数无妨）
+    uint8_t xs[Umbrella::NUM_LEDS];
+    uint8_t ys[Umbrella::NUM_LEDS];
+    const int center = POLAR_SIZE / 2;
+
+    for (uint8_t rib = 0; rib < Umbrella::NUM_RIBS; rib++)
+    {
+        float angle = rib * 2 * PI / Umbrella::NUM_RIBS;
+        for (uint8_t pos = 0; pos < Umbrella::NUM_POSITIONS; pos++)
+        {
+            float radius = (pos + 1) * POLAR_STEP;
+            uint16_t led = Umbrella::index(rib, pos);
+            xs[led] = (uint8_t)(center + (int)round(radius * sin(angle)));
+            ys[led] = (uint8_t)(center - (int)round(radius * cos(angle)));
+        }
+    }
+
+    static const byte BACKGROUND[3] = {0, 0, 0};
+
+    writeHeader(out, POLAR_SIZE, POLAR_SIZE, renderMicros);
+
+    for (uint8_t y = 0; y < POLAR_SIZE; y++)
+    {
+        for (uint8_t x = 0; x < POLAR_SIZE; x++)
+        {
+            const byte *pixel = BACKGROUND;
+            for (uint16_t led = 0; led < Umbrella::NUM_LEDS; led++)
+            {
+                if (xs[led] == x && ys[led] == y)
+                {
+                    pixel = frame + led * 3;
+                    break;
+                }
+            }
+            writePixel(out, pixel);
+        }
+        out.println();
+    }
+}
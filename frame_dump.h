@@ -0,0 +1,18 @@
+#ifndef FRAME_DUMP_H
+#define FRAME_DUMP_H
+
+#include <Arduino.h>
+#include "umbrella_geometry.h"
+
+// 把伞灯帧（Umbrella::FRAME_SIZE 字节 RGB）输出为 ASCII PPM (P3) 图像
+// 可以直接从串口监视器复制保存为 .ppm 查看，不需要实体灯具
+namespace FrameDump
+{
+    // 网格布局：每列一条伞骨，每行一个位置（第 0 行 = 中心）
+    void writeGrid(Print &out, const byte *frame, unsigned long renderMicros = 0);
+
+    // 极坐标布局：按实际伞形把 LED 画在圆上（俯视图）
+    void writePolar(Print &out, const byte *frame, unsigned long renderMicros = 0);
+}
+
+#endif
@@ -0,0 +1,300 @@
+#include "frame_recorder.h"
+
+#if FRAME_RECORDER_ENABLED
+
+// 段数用 uint8 保存：段之间至少隔 4 个相同字节，所以一帧最多 FRAME_SIZE / 5 段
+static_assert(FrameRecorder::FRAME_SIZE / 5 <= 255, "frame too large for 8-bit run counts");
+
+static const uint16_t RECORD_HEADER_SIZE = 3; // dt (2) + runCount (1)
+static const uint16_t RUN_HEADER_SIZE = 3;    // offset (2) + len (1)
+static const uint16_t FILL_FLAG = 0x8000;     // offset 最高位：填充段
+static const uint8_t FILL_SIZE = 3;           // 填充段的数据：一个像素
+
+static_assert(FrameRecorder::FRAME_SIZE < FILL_FLAG, "frame too large for the fill flag");
+
+// 一段数据是否是同一个 3 字节图案的重复（整片同色，例如 IDLE 呼吸灯）；比图案本身长才值得用填充段
+static bool isFill(const byte *data, uint8_t len)
+{
+    if (len <= FILL_SIZE)
+    {
+        return false;
+    }
+    for (uint8_t k = FILL_SIZE; k < len; k++)
+    {
+        if (data[k] != data[k - FILL_SIZE])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 从 start 开始找下一段差异；间隔不超过 3 个相同字节的差异合并为一段（段头本身占 3 字节）
+static bool nextRun(const byte *oldFrame, const byte *newFrame, uint16_t start, uint16_t &offset, uint8_t &len)
+{
+    uint16_t i = start;
+    while (i < FrameRecorder::FRAME_SIZE && oldFrame[i] == newFrame[i])
+    {
+        i++;
+    }
+    if (i >= FrameRecorder::FRAME_SIZE)
+    {
+        return false;
+    }
+
+    uint16_t end = i + 1; // 不含
+    for (uint16_t j = i + 1; j < FrameRecorder::FRAME_SIZE && j - i < 255; j++)
+    {
+        if (oldFrame[j] != newFrame[j])
+        {
+            end = j + 1;
+        }
+        else if (j - end >= 3)
+        {
+            break;
+        }
+    }
+
+    offset = i;
+    len = (uint8_t)(end - i);
+    return true;
+}
+
+FrameRecorder::FrameRecorder()
+    : head(0),
+      tail(0),
+      used(0),
+      count(0),
+      recording(false),
+      replaying(false),
+      lastRecordTime(0),
+      pendingDelay(0),
+      replayPos(0),
+      replayRemaining(0),
+      replaySpeed(1),
+      replayLastTime(0),
+      replayDebt(0)
+{
+    memset(baseFrame, 0, sizeof(baseFrame));
+    memset(frame, 0, sizeof(frame));
+}
+
+void FrameRecorder::clear()
+{
+    head = 0;
+    tail = 0;
+    used = 0;
+    count = 0;
+    pendingDelay = 0;
+    memset(baseFrame, 0, sizeof(baseFrame));
+    memset(frame, 0, sizeof(frame));
+}
+
+void FrameRecorder::start()
+{
+    clear();
+    replaying = false;
+    recording = true;
+    lastRecordTime = millis();
+    Serial.println("[Recorder] ✓ Recording started");
+}
+
+void FrameRecorder::stop()
+{
+    if (recording || replaying)
+    {
+        Serial.println("[Recorder] Stopped");
+    }
+    recording = false;
+    replaying = false;
+}
+
+void FrameRecorder::writeByte(uint8_t value)
+{
+    buffer[head] = value;
+    head = (head + 1) % RECORDER_BUFFER_SIZE;
+}
+
+uint16_t FrameRecorder::applyRecord(uint16_t pos, byte *target, uint16_t *dt) const
+{
+    if (dt)
+    {
+        *dt = readByte(pos) | ((uint16_t)readByte(pos + 1) << 8);
+    }
+
+    uint8_t runs = readByte(pos + 2);
+    uint16_t size = RECORD_HEADER_SIZE;
+    for (uint8_t i = 0; i < runs; i++)
+    {
+        uint16_t offset = readByte(pos + size) | ((uint16_t)readByte(pos + size + 1) << 8);
+        uint8_t len = readByte(pos + size + 2);
+        size += RUN_HEADER_SIZE;
+        if (offset & FILL_FLAG)
+        {
+            offset &= ~FILL_FLAG;
+            for (uint8_t k = 0; k < len; k++)
+            {
+                target[offset + k] = readByte(pos + size + k % FILL_SIZE);
+            }
+            size += FILL_SIZE;
+        }
+        else
+        {
+            for (uint8_t k = 0; k < len; k++)
+            {
+                target[offset + k] = readByte(pos + size + k);
+            }
+            size += len;
+        }
+    }
+    return size;
+}
+
+void FrameRecorder::evictOldest()
+{
+    // 把最旧的记录合并进 baseFrame，回放起点随之前移
+    uint16_t size = applyRecord(tail, baseFrame, nullptr);
+    tail = (tail + size) % RECORDER_BUFFER_SIZE;
+    used -= size;
+    count--;
+}
+
+void FrameRecorder::writeRecord(const byte *newFrame, uint16_t dt)
+{
+    // 第一遍：计算记录大小
+    uint16_t size = RECORD_HEADER_SIZE;
+    uint8_t runs = 0;
+    uint16_t offset;
+    uint8_t len;
+    uint16_t pos = 0;
+    while (nextRun(frame, newFrame, pos, offset, len))
+    {
+        size += RUN_HEADER_SIZE + (isFill(newFrame + offset, len) ? FILL_SIZE : len);
+        runs++;
+        pos = offset + len;
+    }
+
+    while (count > 0 && used + size > RECORDER_BUFFER_SIZE)
+    {
+        evictOldest();
+    }
+
+    // 第二遍：写入
+    writeByte(dt & 0xFF);
+    writeByte(dt >> 8);
+    writeByte(runs);
+    pos = 0;
+    while (nextRun(frame, newFrame, pos, offset, len))
+    {
+        bool fill = isFill(newFrame + offset, len);
+        uint16_t header = fill ? offset | FILL_FLAG : offset;
+        writeByte(header & 0xFF);
+        writeByte(header >> 8);
+        writeByte(len);
+        for (uint8_t k = 0; k < (fill ? FILL_SIZE : len); k++)
+        {
+            writeByte(newFrame[offset + k]);
+        }
+        pos = offset + len;
+    }
+
+    used += size;
+    count++;
+    memcpy(frame, newFrame, FRAME_SIZE);
+}
+
+void FrameRecorder::record(const byte *newFrame, unsigned long now)
+{
+    if (!recording)
+    {
+        return;
+    }
+
+    pendingDelay += now - lastRecordTime;
+    lastRecordTime = now;
+
+    // 时间间隔超过 uint16 范围时插入空记录
+    while (pendingDelay > 0xFFFF)
+    {
+        writeRecord(frame, 0xFFFF);
+        pendingDelay -= 0xFFFF;
+    }
+
+    // 画面没有变化：不写记录，时间留给下一条
+    if (count > 0 && memcmp(frame, newFrame, FRAME_SIZE) == 0)
+    {
+        return;
+    }
+
+    writeRecord(newFrame, (uint16_t)pendingDelay);
+    pendingDelay = 0;
+}
+
+bool FrameRecorder::startReplay(uint8_t speed)
+{
+    if (count == 0)
+    {
+        Serial.println("[Recorder] ✗ Nothing to replay");
+        return false;
+    }
+
+    recording = false;
+    replaying = true;
+    memcpy(frame, baseFrame, FRAME_SIZE);
+    replayPos = tail;
+    replayRemaining = count;
+    replaySpeed = speed > 0 ? speed : 1;
+    replayLastTime = millis();
+    replayDebt = 0;
+
+    Serial.print("[Recorder] ✓ Replaying ");
+    Serial.print(count);
+    Serial.print(" frames at x");
+    Serial.println(replaySpeed);
+    return true;
+}
+
+bool FrameRecorder::nextReplayFrame(unsigned long now, byte *out)
+{
+    if (!replaying)
+    {
+        return false;
+    }
+
+    replayDebt += (now - replayLastTime) * replaySpeed;
+    replayLastTime = now;
+
+    uint16_t dt = readByte(replayPos) | ((uint16_t)readByte(replayPos + 1) << 8);
+    if (replayDebt < dt)
+    {
+        return false;
+    }
+    replayDebt -= dt;
+
+    uint16_t size = applyRecord(replayPos, frame, nullptr);
+    replayPos = (replayPos + size) % RECORDER_BUFFER_SIZE;
+
+    if (--replayRemaining == 0)
+    {
+        replaying = false;
+        Serial.println("[Recorder] ✓ Replay finished");
+    }
+
+    memcpy(out, frame, FRAME_SIZE);
+    return true;
+}
+
+void FrameRecorder::printStatus(Print &out) const
+{
+    out.print("[Recorder] ");
+    out.print(recording ? "recording" : (replaying ? "replaying" : "idle"));
+    out.print(", ");
+    out.print(count);
+    out.print(" frames, ");
+    out.print(used);
+    out.print("/");
+    out.print(RECORDER_BUFFER_SIZE);
+    out.println(" bytes");
+}
+
+#endif
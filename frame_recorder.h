@@ -0,0 +1,106 @@
+#ifndef FRAME_RECORDER_H
+#define FRAME_RECORDER_H
+
+#include <Arduino.h>
+#include "umbrella_geometry.h"
+
+// 编译时定义 FRAME_RECORDER_ENABLED=0 后换成下面的空实现，不占 RAM（启用时约 RECORDER_BUFFER_SIZE + 2 × 864 字节）
+#ifndef FRAME_RECORDER_ENABLED
+#define FRAME_RECORDER_ENABLED 1
+#endif
+
+#define RECORDER_BUFFER_SIZE 2048 // 环形缓冲区大小（字节）
+
+// 伞灯帧录制 / 回放
+// 记录输出级之前的画布（RGBpayload），回放时照常经过输出级，所以时间抖动（temporal dither）每帧翻动的最低位不会进入记录。
+// 每帧只保存与上一帧的差异（间隔不超过 3 个相同字节的差异合并为一段）：
+//   记录头: dt (uint16, ms, 小端) + runCount (uint8)
+//   每段:   offset (uint16, 字节偏移, 小端) + len (uint8) + len 字节数据
+//           offset 最高位为 1 时是填充段：只跟 3 字节（一个像素），按它循环填满 len 字节（整片同色，如 IDLE 呼吸）
+// 与上一帧完全相同的帧不写记录，时间累加到下一条记录的 dt 里。
+// 缓冲区满时丢弃最旧的记录，并把它应用到 baseFrame 上，
+// 所以回放总是从 baseFrame 开始依次应用剩下的记录。
+// 每 KB 能存的帧数见 tools/render_host --recorder（IDLE 约 114 帧，天气动画和频谱约 9-33 帧）。
+#if FRAME_RECORDER_ENABLED
+
+class FrameRecorder
+{
+public:
+    static const uint16_t FRAME_SIZE = UmbrellaCanvas::FRAME_SIZE;
+
+private:
+    uint8_t buffer[RECORDER_BUFFER_SIZE];
+    uint16_t head;  // 下一条记录写入位置
+    uint16_t tail;  // 最旧记录位置
+    uint16_t used;  // 已用字节
+    uint16_t count; // 记录条数
+
+    byte baseFrame[FRAME_SIZE]; // 最旧记录之前的画面
+    byte frame[FRAME_SIZE];     // 录制时：上一帧；回放时：当前回放画面
+
+    bool recording;
+    bool replaying;
+
+    unsigned long lastRecordTime;
+    unsigned long pendingDelay; // 尚未写入记录的时间（相同帧被跳过时累加）
+
+    // 回放状态
+    uint16_t replayPos;
+    uint16_t replayRemaining;
+    uint8_t replaySpeed;
+    unsigned long replayLastTime;
+    unsigned long replayDebt; // 回放时间轴上已经过去、尚未消耗的时间（ms × speed）
+
+    uint8_t readByte(uint16_t pos) const { return buffer[pos % RECORDER_BUFFER_SIZE]; }
+    void writeByte(uint8_t value);
+
+    uint16_t applyRecord(uint16_t pos, byte *target, uint16_t *dt) const; // 返回记录长度
+    void evictOldest();
+    void writeRecord(const byte *newFrame, uint16_t dt);
+
+public:
+    FrameRecorder();
+
+    void start();  // 清空并开始录制
+    void stop();   // 停止录制 / 回放
+    void clear();  // 清空所有记录
+
+    // 录制一帧（只在录制中生效）
+    void record(const byte *newFrame, unsigned long now);
+
+    // 回放：speed = 1 原速，2 = 两倍速 ...
+    bool startReplay(uint8_t speed = 1);
+
+    // 回放推进：到了下一帧的时间时把画面写入 out 并返回 true
+    bool nextReplayFrame(unsigned long now, byte *out);
+
+    bool isRecording() const { return recording; }
+    bool isReplaying() const { return replaying; }
+    uint16_t getFrameCount() const { return count; }
+    uint16_t getBytesUsed() const { return used; }
+
+    void printStatus(Print &out) const;
+};
+
+#else
+
+// 空实现：接口相同，什么都不记录
+class FrameRecorder
+{
+public:
+    void start() { Serial.println("[Recorder] ✗ Disabled at compile time (FRAME_RECORDER_ENABLED=0)"); }
+    void stop() {}
+    void clear() {}
+    void record(const byte *, unsigned long) {}
+    bool startReplay(uint8_t = 1) { return false; }
+    bool nextReplayFrame(unsigned long, byte *) { return false; }
+    bool isRecording() const { return false; }
+    bool isReplaying() const { return false; }
+    uint16_t getFrameCount() const { return 0; }
+    uint16_t getBytesUsed() const { return 0; }
+    void printStatus(Print &out) const { out.println("[Recorder] disabled"); }
+};
+
+#endif
+
+#endif
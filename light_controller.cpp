@@ -1,14 +1,25 @@
 #include "light_controller.h"
 #include "music_mode.h"
 #include "audio_analyzer.h"
+#include "color_math.h"
+#include "profiler.h"
+#include "render_clock.h"
+#include "curves.h"
+#include "metrics.h"
+#include "payload_parser.h"
+
+// 一次完整呼吸的周期（暗 → 亮 → 暗）
+static const unsigned long BREATH_PERIOD_MS = 5200;
 
 LightController::LightController()
 {
     mqtt = nullptr;
     musicMode = nullptr;
     audioAnalyzer = nullptr;
+    palettes = nullptr;
     strip = nullptr;
     numPixels = DEFAULT_NUM_PIXELS;
+    frameBuffer = nullptr;
     state = LIGHT_OFF;
     mode = MODE_IDLE;
 
@@ -17,7 +28,7 @@ LightController::LightController()
     debugSelectedIndex = -1;
 
     lastBreathUpdate = 0;
-    breathDirection = 1;
+    breathStart = 0;
     breathBrightness = 0;
 
     suppressMqttFeedback = false;
@@ -39,6 +50,12 @@ LightController::~LightController()
         delete[] debugData;
         debugData = nullptr;
     }
+
+    if (frameBuffer != nullptr)
+    {
+        delete[] frameBuffer;
+        frameBuffer = nullptr;
+    }
 }
 
 void LightController::begin(MQTTManager *mqttManager, int pixelCount)
@@ -70,6 +87,15 @@ void LightController::begin(MQTTManager *mqttManager, int pixelCount)
         debugData[i].isOverridden = false;
     }
 
+    if (frameBuffer != nullptr)
+    {
+        delete[] frameBuffer;
+    }
+    frameBuffer = new uint8_t[numPixels * 3];
+    memset(frameBuffer, 0, numPixels * 3);
+    outputStage.begin(numPixels);
+    outputStage.setPowerBudget(LIGHT_POWER_BUDGET_MA);
+
     Serial.print("[LightController] ✓ Initialized with ");
     Serial.print(numPixels);
     Serial.print(" pixel(s) on pin ");
@@ -83,6 +109,12 @@ void LightController::setMusicMode(MusicMode *music, AudioAnalyzer *audio)
     Serial.println("[LightController] Music mode and audio analyzer configured");
 }
 
+void LightController::setPaletteManager(PaletteManager *manager)
+{
+    palettes = manager;
+    Serial.println("[LightController] Palette manager configured");
+}
+
 void LightController::setActive(bool active)
 {
     if (!active)
@@ -100,6 +132,11 @@ void LightController::setActive(bool active)
     }
 }
 
+const uint32_t *LightController::getPalette(PaletteRole role) const
+{
+    return palettes ? palettes->get(role) : PaletteManager::defaultPalette(role);
+}
+
 void LightController::setNumPixels(int count)
 {
     count = constrain(count, 1, MAX_NUM_PIXELS);
@@ -120,6 +157,11 @@ void LightController::setNumPixels(int count)
             debugData[i].isOverridden = false;
         }
 
+        delete[] frameBuffer;
+        frameBuffer = new uint8_t[numPixels * 3];
+        memset(frameBuffer, 0, numPixels * 3);
+        outputStage.begin(numPixels);
+
         Serial.print("[LightController] ✓ Pixel count updated to: ");
         Serial.println(numPixels);
 
@@ -153,153 +195,183 @@ void LightController::loop()
     }
 }
 
-void LightController::handleMQTTMessage(char *topic, byte *payload, unsigned int length)
+void LightController::handleStatus(const byte *payload, unsigned int length)
 {
+    PayloadSpan message = PayloadSpan(payload, length).trim();
 
-    String message = "";
-    for (unsigned int i = 0; i < length; i++)
+    if (message.equalsIgnoreCase("on") || message.equals("1"))
     {
-        message += (char)payload[i];
+
+        Serial.println("[LightController] Setting state to ON");
+        state = LIGHT_ON;
+        updateLEDs();
     }
+    else if (message.equalsIgnoreCase("off") || message.equals("0"))
+    {
 
-    Serial.print("[LightController] Received [");
-    Serial.print(topic);
-    Serial.print("]: ");
-    Serial.println(message);
+        Serial.println("[LightController] Setting state to OFF");
+        state = LIGHT_OFF;
+        updateLEDs();
+    }
+}
 
-    String topicStr = String(topic);
+void LightController::handleMode(const byte *payload, unsigned int length)
+{
+    PayloadSpan message = PayloadSpan(payload, length).trim();
 
-    if (topicStr.endsWith("/status"))
+    if (message.equalsIgnoreCase("timer"))
     {
-        if (message == "on" || message == "ON" || message == "1")
-        {
+        mode = MODE_TIMER;
+    }
+    else if (message.equalsIgnoreCase("weather"))
+    {
+        mode = MODE_WEATHER;
+    }
+    else if (message.equalsIgnoreCase("idle"))
+    {
+        mode = MODE_IDLE;
+        breathBrightness = 0;
+        breathStart = renderClock.now();
+        lastBreathUpdate = breathStart;
+    }
+    else if (message.equalsIgnoreCase("music"))
+    {
+        mode = MODE_MUSIC;
+    }
 
-            Serial.println("[LightController] Setting state to ON");
-            state = LIGHT_ON;
-            updateLEDs();
-        }
-        else if (message == "off" || message == "OFF" || message == "0")
-        {
+    const char *modeNames[] = {"timer", "weather", "idle", "music"};
+    Serial.print("[LightController] Setting mode to: ");
+    Serial.println(modeNames[mode]);
 
-            Serial.println("[LightController] Setting state to OFF");
-            state = LIGHT_OFF;
-            updateLEDs();
-        }
+    applyModeColor();
+    if (state == LIGHT_ON)
+    {
+        updateLEDs();
     }
+}
 
-    else if (topicStr.endsWith("/mode"))
-    {
+void LightController::handleDebugColor(const byte *payload, unsigned int length)
+{
+    // "index:#RRGGBB" 设置单个像素，"#RRGGBB" 设置全部
+    PayloadSpan message(payload, length);
+    PayloadSpan indexStr, colorStr;
+    long index;
+    uint32_t color;
 
-        message.toLowerCase();
-        if (message == "timer")
-        {
-            mode = MODE_TIMER;
-        }
-        else if (message == "weather")
-        {
-            mode = MODE_WEATHER;
-        }
-        else if (message == "idle")
-        {
-            mode = MODE_IDLE;
-            breathBrightness = 0;
-            breathDirection = 1;
-            lastBreathUpdate = millis();
-        }
-        else if (message == "music")
+    if (message.split(':', indexStr, colorStr))
+    {
+        if (indexStr.toInt(index) && colorStr.toHexColor(color))
         {
-            mode = MODE_MUSIC;
+            debugSetColor(index, color);
+            return;
         }
+    }
+    else if (message.toHexColor(color))
+    {
+        debugFillRange(0, numPixels, color);
+        return;
+    }
 
-        const char *modeNames[] = {"timer", "weather", "idle", "music"};
-        Serial.print("[LightController] Setting mode to: ");
-        Serial.println(modeNames[mode]);
+    Serial.print("[LightController] ✗ Invalid debug color: ");
+    message.printTo(Serial);
+    Serial.println();
+}
 
-        applyModeColor();
-        if (state == LIGHT_ON)
+void LightController::handleDebugBrightness(const byte *payload, unsigned int length)
+{
+    // "index:0-255" 设置单个像素，"0-255" 设置全部
+    PayloadSpan message(payload, length);
+    PayloadSpan indexStr, valueStr;
+    long index, brightness;
+
+    if (message.split(':', indexStr, valueStr))
+    {
+        if (indexStr.toInt(index) && valueStr.toInt(brightness))
         {
-            updateLEDs();
+            debugSetBrightness(index, brightness);
+            return;
         }
     }
-
-    else if (topicStr.endsWith("/debug/color"))
+    else if (message.toInt(brightness))
     {
+        debugBrightnessRange(0, numPixels, brightness);
+        return;
+    }
 
-        int colonPos = message.indexOf(':');
-        if (colonPos > 0)
-        {
+    Serial.print("[LightController] ✗ Invalid debug brightness: ");
+    message.printTo(Serial);
+    Serial.println();
+}
 
-            int index = message.substring(0, colonPos).toInt();
-            String colorStr = message.substring(colonPos + 1);
-            debugSetColor(index, colorStr);
-        }
-        else
-        {
+void LightController::handleDebugIndex(const byte *payload, unsigned int length)
+{
+    PayloadSpan message(payload, length);
+    long index;
 
-            for (int i = 0; i < numPixels; i++)
-            {
-                debugSetColor(i, message);
-            }
-        }
+    if (message.trim().equalsIgnoreCase("clear"))
+    {
+        clearDebugMode();
     }
-
-    else if (topicStr.endsWith("/debug/brightness"))
+    else if (message.toInt(index))
     {
+        debugSetIndex(index);
+    }
+}
 
-        int colonPos = message.indexOf(':');
-        if (colonPos > 0)
-        {
+// 电流预算（mA，0 = 不限制）
+void LightController::handlePowerBudget(const byte *payload, unsigned int length)
+{
+    long value;
+    if (!PayloadSpan(payload, length).toInt(value))
+    {
+        Serial.println("[LightController] ✗ Invalid power budget");
+        return;
+    }
 
-            int index = message.substring(0, colonPos).toInt();
-            int brightness = message.substring(colonPos + 1).toInt();
-            debugSetBrightness(index, brightness);
-        }
-        else
-        {
+    int budget = constrain(value, 0, 10000);
+    outputStage.setPowerBudget(budget);
+    updateLEDs();
 
-            int brightness = message.toInt();
-            for (int i = 0; i < numPixels; i++)
-            {
-                debugSetBrightness(i, brightness);
-            }
-        }
-    }
+    Serial.print("[LightController] Power budget set to: ");
+    Serial.print(budget);
+    Serial.println(" mA");
 
-    else if (topicStr.endsWith("/debug/index"))
+    if (mqtt && !suppressMqttFeedback)
     {
-
-        if (message == "clear" || message == "CLEAR")
-        {
-            clearDebugMode();
-        }
-        else
-        {
-            debugSetIndex(message.toInt());
-        }
+        char text[8];
+        snprintf(text, sizeof(text), "%d", budget);
+        mqtt->publishInfo("power/budget", text, true);
     }
+}
 
-    // 新增：IDLE 模式自定义颜色
-    else if (topicStr.endsWith("/idle/color"))
+// IDLE 模式自定义颜色
+void LightController::handleIdleColor(const byte *payload, unsigned int length)
+{
+    // 接收格式: #RRGGBB
+    uint32_t newColor;
+    if (!PayloadSpan(payload, length).toHexColor(newColor))
     {
-        // 接收格式: #RRGGBB
-        uint32_t newColor = hexToColor(message);
-        idleColor = newColor;
+        Serial.println("[LightController] ✗ Invalid IDLE color");
+        return;
+    }
+    idleColor = newColor;
 
-        Serial.print("[LightController] IDLE color set to: ");
-        Serial.println(message);
+    char hex[8];
+    snprintf(hex, sizeof(hex), "#%06lX", (unsigned long)(idleColor & 0xFFFFFF));
+    Serial.print("[LightController] IDLE color set to: ");
+    Serial.println(hex);
 
-        // 如果当前是 IDLE 模式且灯是开启的，立即更新显示
-        if (mode == MODE_IDLE && state == LIGHT_ON)
-        {
-            applyModeColor();
-            updateLEDs();
-        }
+    // 如果当前是 IDLE 模式且灯是开启的，立即更新显示
+    if (mode == MODE_IDLE && state == LIGHT_ON)
+    {
+        applyModeColor();
+        updateLEDs();
+    }
 
-        // 发布确认消息
-        if (mqtt && !suppressMqttFeedback)
-        {
-            mqtt->publishInfo("idle/color", message.c_str(), true);
-        }
+    // 发布确认消息
+    if (mqtt && !suppressMqttFeedback)
+    {
+        mqtt->publishInfo("idle/color", hex, true);
     }
 }
 
@@ -346,8 +418,8 @@ void LightController::setMode(String modeName)
         mode = MODE_IDLE;
 
         breathBrightness = 0;
-        breathDirection = 1;
-        lastBreathUpdate = millis();
+        breathStart = renderClock.now();
+        lastBreathUpdate = breathStart;
     }
     else if (modeName == "music")
     {
@@ -418,35 +490,44 @@ void LightController::applyModeColor()
 
 void LightController::setPixel(int index, uint32_t pixelColor, int pixelBrightness)
 {
-    if (strip == nullptr || index < 0 || index >= numPixels)
+    if (frameBuffer == nullptr || index < 0 || index >= numPixels)
+        return;
+
+    rgbWrite(frameBuffer + index * 3, rgbScale8(pixelColor, pixelBrightness));
+}
+
+void LightController::showFrame()
+{
+    if (strip == nullptr || frameBuffer == nullptr)
         return;
 
-    uint8_t r = (pixelColor >> 16) & 0xFF;
-    uint8_t g = (pixelColor >> 8) & 0xFF;
-    uint8_t b = pixelColor & 0xFF;
+    // 逻辑帧 → 伽马校正 + 抖动 → 灯带
+    uint8_t output[MAX_NUM_PIXELS * 3];
+    outputStage.process(frameBuffer, output, numPixels);
 
-    r = (r * pixelBrightness) / 255;
-    g = (g * pixelBrightness) / 255;
-    b = (b * pixelBrightness) / 255;
+    for (int i = 0; i < numPixels; i++)
+    {
+        strip->setPixelColor(i, output[i * 3 + 0], output[i * 3 + 1], output[i * 3 + 2]);
+    }
 
-    strip->setPixelColor(index, strip->Color(r, g, b));
+    PROFILE_SCOPE(PROF_STRIP_SHOW);
+    strip->show();
+    Metrics::count(MET_FRAMES_LOCAL);
 }
 
-void LightController::debugSetColor(int index, String hexColor)
+void LightController::debugSetColor(int index, uint32_t color)
 {
     if (index < 0 || index >= numPixels)
         return;
 
-    uint32_t color = hexToColor(hexColor);
-
     debugData[index].color = color;
     debugData[index].isOverridden = true;
     debugModeActive = true;
 
     Serial.print("[LightController] DEBUG: Pixel ");
     Serial.print(index);
-    Serial.print(" color set to ");
-    Serial.println(hexColor);
+    Serial.print(" color set to #");
+    Serial.println(color, HEX);
 
     if (state == LIGHT_ON)
     {
@@ -483,6 +564,88 @@ void LightController::debugSetIndex(int index)
     Serial.println(index);
 }
 
+// 范围限制在 [0, numPixels) 内，返回实际处理的像素数
+static int clipRange(int &start, int count, int numPixels)
+{
+    if (start < 0)
+    {
+        count += start;
+        start = 0;
+    }
+    if (start + count > numPixels)
+    {
+        count = numPixels - start;
+    }
+    return count > 0 ? count : 0;
+}
+
+void LightController::debugSetPixels(int start, const byte *rgb, int count)
+{
+    rgb += (start < 0 ? -start : 0) * 3;
+    count = clipRange(start, count, numPixels);
+
+    for (int i = 0; i < count; i++, rgb += 3)
+    {
+        debugData[start + i].color = rgbPack(rgb[0], rgb[1], rgb[2]);
+        debugData[start + i].isOverridden = true;
+    }
+    debugModeActive = debugModeActive || count > 0;
+
+    Serial.print("[LightController] DEBUG: ");
+    Serial.print(count);
+    Serial.println(" pixels set");
+
+    if (count > 0 && state == LIGHT_ON)
+    {
+        updateLEDs();
+    }
+}
+
+void LightController::debugFillRange(int start, int count, uint32_t color)
+{
+    count = clipRange(start, count, numPixels);
+
+    for (int i = start; i < start + count; i++)
+    {
+        debugData[i].color = color;
+        debugData[i].isOverridden = true;
+    }
+    debugModeActive = debugModeActive || count > 0;
+
+    Serial.print("[LightController] DEBUG: ");
+    Serial.print(count);
+    Serial.print(" pixels color set to #");
+    Serial.println(color, HEX);
+
+    if (count > 0 && state == LIGHT_ON)
+    {
+        updateLEDs();
+    }
+}
+
+void LightController::debugBrightnessRange(int start, int count, int brightness)
+{
+    count = clipRange(start, count, numPixels);
+    brightness = constrain(brightness, 0, 255);
+
+    for (int i = start; i < start + count; i++)
+    {
+        debugData[i].brightness = brightness;
+        debugData[i].isOverridden = true;
+    }
+    debugModeActive = debugModeActive || count > 0;
+
+    Serial.print("[LightController] DEBUG: ");
+    Serial.print(count);
+    Serial.print(" pixels brightness set to ");
+    Serial.println(brightness);
+
+    if (count > 0 && state == LIGHT_ON)
+    {
+        updateLEDs();
+    }
+}
+
 void LightController::clearDebugMode()
 {
     Serial.println("[LightController] DEBUG: Clearing debug mode");
@@ -502,36 +665,15 @@ void LightController::clearDebugMode()
     }
 }
 
-uint32_t LightController::hexToColor(String hexColor)
-{
-
-    if (hexColor.startsWith("#"))
-    {
-        hexColor = hexColor.substring(1);
-    }
-
-    long number = strtol(hexColor.c_str(), NULL, 16);
-    return (uint32_t)number;
-}
-
 void LightController::updateBreathingEffect()
 {
-    unsigned long now = millis();
+    unsigned long now = renderClock.now();
 
+    // 每20ms刷新一次；亮度只由经过的时间决定，loop() 卡顿时不会变慢
     if (now - lastBreathUpdate > 20)
     {
-        breathBrightness += breathDirection * 2;
-
-        if (breathBrightness >= 255)
-        {
-            breathBrightness = 255;
-            breathDirection = -1;
-        }
-        else if (breathBrightness <= 0)
-        {
-            breathBrightness = 0;
-            breathDirection = 1;
-        }
+        uint8_t phase = renderClock.phase8(BREATH_PERIOD_MS, breathStart);
+        breathBrightness = Curves::forEffect(CURVE_EFFECT_IDLE, phase);
 
         updateLEDs();
 
@@ -548,6 +690,7 @@ void LightController::updateLEDs()
     {
         strip->clear();
         strip->show();
+        outputStage.reset();
         return;
     }
 
@@ -568,7 +711,7 @@ void LightController::updateLEDs()
 
             if (mode == MODE_IDLE)
             {
-                brightness = (brightness * breathBrightness) / 255;
+                brightness = scale8(brightness, breathBrightness);
             }
 
             setPixel(i, debugData[i].color, brightness);
@@ -598,7 +741,7 @@ void LightController::updateLEDs()
         }
     }
 
-    strip->show();
+    showFrame();
 }
 
 void LightController::updateMusicVU()
@@ -620,7 +763,7 @@ void LightController::updateMusicVU()
         {
             setPixel(i, 0x000000, 0);
         }
-        strip->show();
+        showFrame();
 
         // 调试输出
         static unsigned long lastDebug = 0;
@@ -636,44 +779,38 @@ void LightController::updateMusicVU()
         return;
     }
 
-    // 获取精确的音量级别（0.0 - 8.0，对应 8 个灯）
-    float exactLevel = audioAnalyzer->getVolume() * 8.0;
-    if (exactLevel > 8.0)
-        exactLevel = 8.0;
+    // 获取精确的音量级别（Q8.8，0 - 8.0，对应 8 个灯），每帧只做一次浮点转换
+    float volume = audioAnalyzer->getVolume();
+    if (volume > 1.0)
+        volume = 1.0;
+    if (volume < 0.0)
+        volume = 0.0;
+    uint16_t exactLevel = (uint16_t)(volume * 8 * 256);
 
     // 完全点亮的灯数量（向下取整）
-    int fullLights = (int)exactLevel;
+    int fullLights = exactLevel >> 8;
 
-    // 部分点亮的灯亮度（0.0 - 1.0）
-    float partialBrightness = exactLevel - fullLights;
+    // 部分点亮的灯亮度（0 - 255）
+    uint8_t partialBrightness = exactLevel & 0xFF;
 
     // 调试：每 2 秒打印一次
     static unsigned long lastDebug2 = 0;
     if (millis() - lastDebug2 > 2000)
     {
         Serial.print("[LightController] Exact Level: ");
-        Serial.print(exactLevel, 2);
+        Serial.print(exactLevel / 256.0, 2);
         Serial.print(" (Full: ");
         Serial.print(fullLights);
         Serial.print(", Partial: ");
-        Serial.print(partialBrightness, 2);
+        Serial.print(partialBrightness / 255.0, 2);
         Serial.print("), Volume: ");
         Serial.print(volumeDb, 1);
         Serial.println(" dB");
         lastDebug2 = millis();
     }
 
-    // VU 表颜色方案（从低到高）
-    uint32_t vuColors[8] = {
-        0x00FF00, // 0: 绿色（安静）
-        0x33FF00, // 1: 黄绿
-        0x66FF00, // 2: 黄绿
-        0x99FF00, // 3: 黄色
-        0xFFFF00, // 4: 黄色
-        0xFFCC00, // 5: 橙色
-        0xFF6600, // 6: 橙红
-        0xFF0000  // 7: 红色（爆音）
-    };
+    // VU 表颜色：8 个灯均匀取样调色板（从低到高）
+    const uint32_t *palette = getPalette(PALETTE_VU);
 
     for (int i = 0; i < numPixels && i < 8; i++)
     {
@@ -685,13 +822,12 @@ void LightController::updateMusicVU()
         else if (i < fullLights)
         {
             // 完全点亮的灯：全亮度
-            setPixel(i, vuColors[i], 255);
+            setPixel(i, paletteLookup(palette, i * 255 / 7), 255);
         }
-        else if (i == fullLights && partialBrightness > 0.05)
+        else if (i == fullLights && partialBrightness > 13)
         {
-            // 部分点亮的灯：使用亮度控制平滑过渡
-            uint8_t brightness = (uint8_t)(partialBrightness * 255);
-            setPixel(i, vuColors[i], brightness);
+            // 部分点亮的灯：使用亮度控制平滑过渡（> 5%）
+            setPixel(i, paletteLookup(palette, i * 255 / 7), partialBrightness);
         }
         else
         {
@@ -700,7 +836,7 @@ void LightController::updateMusicVU()
         }
     }
 
-    strip->show();
+    showFrame();
 }
 
 void LightController::publishState()
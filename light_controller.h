@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include <Adafruit_NeoPixel.h>
 #include "mqtt_manager.h"
+#include "output_stage.h"
+#include "palette.h"
 
 // 前向声明
 class MusicMode;
@@ -12,6 +14,7 @@ class AudioAnalyzer;
 #define NEOPIXEL_PIN 0
 #define DEFAULT_NUM_PIXELS 1
 #define MAX_NUM_PIXELS 16
+#define LIGHT_POWER_BUDGET_MA 500 // 本地灯带默认电流预算（USB 供电）
 
 enum LightState
 {
@@ -40,10 +43,14 @@ private:
     MQTTManager *mqtt;
     MusicMode *musicMode;         // Music 模式引用
     AudioAnalyzer *audioAnalyzer; // 音频分析器引用
+    PaletteManager *palettes;     // 调色板（未设置时使用默认调色板）
 
     Adafruit_NeoPixel *strip;
     int numPixels;
 
+    uint8_t *frameBuffer;    // 逻辑帧（感知亮度，每像素 3 字节）
+    OutputStage outputStage; // 伽马 + 抖动输出级
+
     LightState state;
     LightMode mode;
 
@@ -52,7 +59,7 @@ private:
     int debugSelectedIndex;
 
     unsigned long lastBreathUpdate;
-    int breathDirection;
+    unsigned long breathStart; // 呼吸起点（相位 0 = 最暗）
     int breathBrightness;
 
     bool suppressMqttFeedback;
@@ -65,8 +72,9 @@ private:
     void applyModeColor();
     void setPixel(int index, uint32_t color, int brightness);
     void setAllPixels(uint32_t color, int brightness);
-    uint32_t hexToColor(String hexColor);
-    void parseDebugCommand(String message, int &index, String &value);
+    void showFrame(); // 经过输出级后刷新到灯带
+
+    const uint32_t *getPalette(PaletteRole role) const; // 当前调色板（未设置时为默认）
 
 public:
     LightController();
@@ -78,24 +86,39 @@ public:
     // 设置 Music 模式和音频分析器
     void setMusicMode(MusicMode *music, AudioAnalyzer *audio);
 
+    // 设置调色板
+    void setPaletteManager(PaletteManager *manager);
+
     void setNumPixels(int count);
 
     void setActive(bool active);
 
     void loop();
 
-    void handleMQTTMessage(char *topic, byte *payload, unsigned int length);
+    // MQTT 命令（由 Aura_Light.ino 注册的主题处理函数调用）
+    void handleStatus(const byte *payload, unsigned int length);
+    void handleMode(const byte *payload, unsigned int length);
+    void handleDebugColor(const byte *payload, unsigned int length);
+    void handleDebugBrightness(const byte *payload, unsigned int length);
+    void handleDebugIndex(const byte *payload, unsigned int length);
+    void handlePowerBudget(const byte *payload, unsigned int length);
+    void handleIdleColor(const byte *payload, unsigned int length);
 
     void turnOn();
     void turnOff();
     void setMode(LightMode newMode);
     void setMode(String modeName);
 
-    void debugSetColor(int index, String hexColor);
+    void debugSetColor(int index, uint32_t color);
     void debugSetBrightness(int index, int brightness);
     void debugSetIndex(int index);
     void clearDebugMode();
 
+    // 批量调试（二进制命令）：修改一段像素，只刷新一次
+    void debugSetPixels(int start, const byte *rgb, int count); // rgb: count × 3 字节
+    void debugFillRange(int start, int count, uint32_t color);
+    void debugBrightnessRange(int start, int count, int brightness);
+
     void publishState();
 
     bool isOn() { return state == LIGHT_ON; }
@@ -111,15 +134,14 @@ public:
         return (state == LIGHT_ON) ? "on" : "off";
     }
 
-    // 获取 IDLE 颜色（格式: #RRGGBB）
-    String getIdleColor()
+    // 获取 IDLE 颜色（格式: #RRGGBB，buffer 至少 8 字节），返回 buffer
+    const char *getIdleColor(char *buffer, size_t size) const
     {
-        char hex[8];
-        sprintf(hex, "#%02X%02X%02X",
-                (uint8_t)((idleColor >> 16) & 0xFF),
-                (uint8_t)((idleColor >> 8) & 0xFF),
-                (uint8_t)(idleColor & 0xFF));
-        return String(hex);
+        snprintf(buffer, size, "#%02X%02X%02X",
+                 (uint8_t)((idleColor >> 16) & 0xFF),
+                 (uint8_t)((idleColor >> 8) & 0xFF),
+                 (uint8_t)(idleColor & 0xFF));
+        return buffer;
     }
 };
 
@@ -0,0 +1,65 @@
+#ifndef LOG2_HISTOGRAM_H
+#define LOG2_HISTOGRAM_H
+
+#include <Arduino.h>
+
+// 耗时的 log2 直方图（Profiler 和 Metrics 共用）
+// 桶 0 = 0us，桶 n = [2^(n-1), 2^n) us，最后一个桶收集 >= 16ms；每个桶的计数饱和在 65535。
+// 没有构造函数，全局数组默认为 0，清零直接 memset。
+struct Log2Histogram
+{
+    static const uint8_t NUM_BUCKETS = 16;
+
+    uint16_t buckets[NUM_BUCKETS];
+    uint32_t count;
+    uint32_t maxMicros;
+
+    // clz 在 Cortex-M0+ 上由编译器内联展开
+    static uint8_t bucketOf(unsigned long us)
+    {
+        if (us == 0)
+        {
+            return 0;
+        }
+        uint8_t bucket = 32 - __builtin_clz((unsigned int)us);
+        return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+    }
+
+    void record(unsigned long us)
+    {
+        uint8_t bucket = bucketOf(us);
+        if (buckets[bucket] < 0xFFFF)
+        {
+            buckets[bucket]++;
+        }
+        count++;
+        if (us > maxMicros)
+        {
+            maxMicros = us;
+        }
+    }
+
+    // 百分位估计：返回所在桶的上界（微秒），不超过最大值
+    uint32_t percentile(uint8_t percent) const
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        uint32_t target = (count * percent + 99) / 100;
+        uint32_t seen = 0;
+        for (uint8_t b = 0; b < NUM_BUCKETS; b++)
+        {
+            seen += buckets[b];
+            if (seen >= target)
+            {
+                uint32_t upper = (uint32_t)1 << b;
+                return upper < maxMicros ? upper : maxMicros;
+            }
+        }
+        return maxMicros;
+    }
+};
+
+#endif
@@ -2,56 +2,77 @@
 #include "music_mode.h"
 #include "audio_analyzer.h"
 #include "weather_animation.h"
+#include "color_math.h"
+#include "render_clock.h"
+#include "curves.h"
+#include "metrics.h"
+#include "profiler.h"
 #include <ArduinoJson.h>
 
+// 一次完整呼吸的周期（暗 → 亮 → 暗）
+static const unsigned long BREATH_PERIOD_MS = 5200;
+
 LuminaireController::LuminaireController()
     : mqtt(nullptr),
       musicMode(nullptr),
       audioAnalyzer(nullptr),
       weatherAnim(nullptr),
+      palettes(nullptr),
+      lastRenderMicros(0),
+      frameStartMicros(0),
+      powerBudget(LUMINAIRE_POWER_BUDGET_MA),
       isActive(false),
       state(LUMI_OFF),
       mode(LUMI_MODE_IDLE),
       idleColor(0x0000FF), // 默认蓝色
       lastBreathUpdate(0),
-      breathDirection(1),
+      breathStart(0),
       breathBrightness(0),
       currentTemp(20.0),
       feelsLikeTemp(20.0),
       humidity(50),
       windSpeed(0),
-      windDirection("N"),
       visibility(10),
       cloudCover(0),
       precipitation(0.0),
-      weatherCode("113"),
-      weatherDesc("Sunny"),
+      weatherCode(113),
       lastWeatherUpdate(0),
       lastWindUpdate(0),
-      windAnimationOffset(0),
+      windPhase(0),
       showingAnimation(false),
       lastModeSwitch(0)
 {
+    strcpy(windDirection, "N");
+    strcpy(weatherDesc, "Sunny");
 
-    memset(RGBpayload, 0, LUMINAIRE_PAYLOAD_SIZE);
+    memset(RGBpayload, 0, LUMINAIRE_CANVAS_SIZE);
+    memset(outputPayload, 0, LUMINAIRE_CANVAS_SIZE);
 }
 
 void LuminaireController::begin(MQTTManager *mqttManager, const String &id)
 {
     mqtt = mqttManager;
-    lightId = id;
-    mqttTopic = "student/CASA0014/luminaire/" + lightId;
+    units.reset(id.c_str());
 
     Serial.println("\n========================================");
     Serial.println("[Luminaire] Initializing Luminaire Controller");
     Serial.println("========================================");
     Serial.print("[Luminaire] Light ID: ");
-    Serial.println(lightId);
+    Serial.println(id);
     Serial.print("[Luminaire] MQTT Topic: ");
-    Serial.println(mqttTopic);
+    Serial.println(String(LUMINAIRE_TOPIC_PREFIX) + id);
     Serial.print("[Luminaire] Number of LEDs: ");
     Serial.println(LUMINAIRE_NUM_LEDS);
     Serial.println("========================================\n");
+
+    outputStage.begin(LUMINAIRE_CANVAS_LEDS);
+    applyPowerBudget();
+}
+
+void LuminaireController::applyPowerBudget()
+{
+    // 输出级对整张画布估算电流；各伞亮度相近时等同于每把伞单独限流
+    outputStage.setPowerBudget(powerBudget * units.getCount());
 }
 
 void LuminaireController::setMusicMode(MusicMode *music, AudioAnalyzer *audio)
@@ -67,6 +88,17 @@ void LuminaireController::setWeatherAnimation(WeatherAnimation *anim)
     Serial.println("[Luminaire] Weather animation configured");
 }
 
+void LuminaireController::setPaletteManager(PaletteManager *manager)
+{
+    palettes = manager;
+    Serial.println("[Luminaire] Palette manager configured");
+}
+
+const uint32_t *LuminaireController::getPalette(PaletteRole role) const
+{
+    return palettes ? palettes->get(role) : PaletteManager::defaultPalette(role);
+}
+
 void LuminaireController::loop()
 {
     // 只在激活且开启时更新
@@ -75,15 +107,31 @@ void LuminaireController::loop()
         return;
     }
 
+    // 回放期间暂停渲染：录制的是输出级之前的画布，回放帧照常经过输出级（抖动 / 限流）再发送，不会被重新录制
+    // 直接在 outputPayload 里就地处理，RGBpayload 保持回放前的画面
+    if (recorder.isReplaying())
+    {
+        if (recorder.nextReplayFrame(millis(), outputPayload))
+        {
+            outputStage.process(outputPayload, outputPayload, units.getCanvasLeds());
+            units.publish(mqtt, outputPayload, 0, FRAME_META_REPLAY);
+        }
+        return;
+    }
+
+    unsigned long renderStart = micros();
+    frameStartMicros = renderStart;
+
     // Music 模式更新
     if (mode == LUMI_MODE_MUSIC && musicMode != nullptr && audioAnalyzer != nullptr)
     {
         // 限制更新频率为每秒约 20 次（避免阻塞主循环）
         static unsigned long lastUpdate = 0;
-        if (millis() - lastUpdate > 50) // 50ms = 20 FPS
+        unsigned long now = renderClock.now();
+        if (now - lastUpdate > 50) // 50ms = 20 FPS
         {
             updateMusicSpectrum();
-            lastUpdate = millis();
+            lastUpdate = now;
         }
     }
     // IDLE 模式呼吸灯更新
@@ -96,6 +144,8 @@ void LuminaireController::loop()
     {
         updateWeatherVisualization();
     }
+
+    lastRenderMicros = micros() - renderStart;
 }
 
 void LuminaireController::setActive(bool active)
@@ -119,7 +169,7 @@ void LuminaireController::sendRGBToPixel(int r, int g, int b, int pixel)
         return;
     }
 
-    if (pixel < 0 || pixel >= LUMINAIRE_NUM_LEDS)
+    if (pixel < 0 || pixel >= units.getCanvasLeds())
     {
         Serial.print("[Luminaire] ✗ Invalid pixel: ");
         Serial.println(pixel);
@@ -133,7 +183,7 @@ void LuminaireController::sendRGBToPixel(int r, int g, int b, int pixel)
     RGBpayload[pixel * 3 + 1] = (byte)g;
     RGBpayload[pixel * 3 + 2] = (byte)b;
 
-    mqtt->publish(mqttTopic.c_str(), RGBpayload, LUMINAIRE_PAYLOAD_SIZE, false);
+    publishFrame();
 
     // 日志已禁用（Music模式下太频繁）
     // Serial.print("[Luminaire] ✓ Sent RGB(");
@@ -153,14 +203,14 @@ void LuminaireController::sendRGBToAll(int r, int g, int b)
         return;
     }
 
-    for (int pixel = 0; pixel < LUMINAIRE_NUM_LEDS; pixel++)
+    for (int pixel = 0; pixel < units.getCanvasLeds(); pixel++)
     {
         RGBpayload[pixel * 3 + 0] = (byte)r;
         RGBpayload[pixel * 3 + 1] = (byte)g;
         RGBpayload[pixel * 3 + 2] = (byte)b;
     }
 
-    mqtt->publish(mqttTopic.c_str(), RGBpayload, LUMINAIRE_PAYLOAD_SIZE, false);
+    publishFrame();
 
     // 日志已禁用（Music模式下太频繁）
     // Serial.print("[Luminaire] ✓ Sent RGB(");
@@ -178,17 +228,111 @@ void LuminaireController::updateAllLEDs(byte *data, int size)
         return;
     }
 
-    if (size != LUMINAIRE_PAYLOAD_SIZE)
+    if (size == LUMINAIRE_PAYLOAD_SIZE)
+    {
+        // 一把伞的画面（天气动画）：只算一次，平铺到画布的每一段，各伞再按自己的旋转 / 镜像显示
+        for (uint8_t unit = 0; unit < units.getCount(); unit++)
+        {
+            memcpy(RGBpayload + unit * LUMINAIRE_PAYLOAD_SIZE, data, size);
+        }
+    }
+    else if (size == units.getCanvasLeds() * 3)
+    {
+        memcpy(RGBpayload, data, size);
+    }
+    else
     {
         Serial.println("[Luminaire] ✗ Invalid data size");
         return;
     }
 
-    // 复制数据到payload
-    memcpy(RGBpayload, data, size);
-
     // 一次性发送
-    mqtt->publish(mqttTopic.c_str(), RGBpayload, LUMINAIRE_PAYLOAD_SIZE, false);
+    publishFrame();
+}
+
+void LuminaireController::publishFrame()
+{
+    // RGBpayload 保持逻辑画布（DEBUG 亮度等会读回），输出级结果写到独立缓冲区
+    // 输出级对整张画布只算一次，各伞灯从结果里取自己的切片
+    {
+        PROFILE_SCOPE(PROF_OUTPUT_STAGE);
+        outputStage.process(RGBpayload, outputPayload, units.getCanvasLeds());
+    }
+    {
+        PROFILE_SCOPE(PROF_MQTT_PUBLISH);
+        units.publish(mqtt, outputPayload, micros() - frameStartMicros);
+        Metrics::count(MET_FRAMES_LUMINAIRE);
+    }
+    recorder.record(RGBpayload, millis());
+}
+
+void LuminaireController::handleRecorderCommand(const PayloadSpan &command)
+{
+    PayloadSpan cmd = command.trim();
+
+    if (cmd.equalsIgnoreCase("start"))
+    {
+        recorder.start();
+    }
+    else if (cmd.equalsIgnoreCase("stop"))
+    {
+        recorder.stop();
+    }
+    else if (cmd.equalsIgnoreCase("clear"))
+    {
+        recorder.stop();
+        recorder.clear();
+    }
+    else if (cmd.startsWithIgnoreCase("replay"))
+    {
+        // "replay" 原速，"replay 4" 四倍速
+        long speed = 1;
+        PayloadSpan arg = cmd.sub(6).trim();
+        if (!arg.isEmpty() && !arg.toInt(speed))
+        {
+            speed = 1;
+        }
+        recorder.startReplay(constrain(speed, 1, 64));
+    }
+    else if (!cmd.equalsIgnoreCase("status"))
+    {
+        Serial.print("[Recorder] ✗ Unknown command: ");
+        command.printTo(Serial);
+        Serial.println();
+        return;
+    }
+
+    recorder.printStatus(Serial);
+
+    if (mqtt && mqtt->isConnected())
+    {
+        char status[64];
+        snprintf(status, sizeof(status), "{\"state\":\"%s\",\"frames\":%u,\"bytes\":%u}",
+                 recorder.isRecording() ? "recording" : (recorder.isReplaying() ? "replaying" : "idle"),
+                 recorder.getFrameCount(), recorder.getBytesUsed());
+        mqtt->publishInfo("recorder", status, true);
+    }
+}
+
+void LuminaireController::handleUnitsCommand(const PayloadSpan &command)
+{
+    if (!units.configure(command))
+    {
+        return;
+    }
+    applyPowerBudget();
+
+    // 画布宽度变了：动态模式下一帧按新宽度渲染，静态颜色（TIMER 等）立即重画
+    if (isActive && state == LUMI_ON)
+    {
+        applyModeColor();
+    }
+
+    if (mqtt && mqtt->isConnected())
+    {
+        char text[64];
+        mqtt->publishInfo("luminaire/units", units.describe(text, sizeof(text)), true);
+    }
 }
 
 void LuminaireController::clear()
@@ -198,176 +342,295 @@ void LuminaireController::clear()
         return;
     }
 
-    memset(RGBpayload, 0, LUMINAIRE_PAYLOAD_SIZE);
+    memset(RGBpayload, 0, LUMINAIRE_CANVAS_SIZE);
+    outputStage.reset();
 
-    mqtt->publish(mqttTopic.c_str(), RGBpayload, LUMINAIRE_PAYLOAD_SIZE, false);
+    publishFrame();
     Serial.println("[Luminaire] ✓ All LEDs cleared");
 }
 
-void LuminaireController::handleMQTTMessage(char *topic, byte *payload, unsigned int length)
+void LuminaireController::handleStatus(const byte *payload, unsigned int length)
 {
+    // 命令触发的帧：帧信息里的耗时从收到命令算起
+    frameStartMicros = micros();
+    PayloadSpan message = PayloadSpan(payload, length).trim();
 
-    String message = "";
-    for (unsigned int i = 0; i < length; i++)
+    if (message.equalsIgnoreCase("on") || message.equals("1"))
     {
-        message += (char)payload[i];
+        Serial.println("[Luminaire] Setting state to ON");
+        state = LUMI_ON;
+
+        // 如果是 IDLE 模式，初始化呼吸灯
+        if (mode == LUMI_MODE_IDLE)
+        {
+            breathBrightness = 0;
+            breathStart = renderClock.now();
+            lastBreathUpdate = breathStart;
+        }
+
+        applyModeColor();
     }
+    else if (message.equalsIgnoreCase("off") || message.equals("0"))
+    {
+        Serial.println("[Luminaire] Setting state to OFF");
+        state = LUMI_OFF;
+        clear();
+    }
+}
 
-    Serial.print("[Luminaire] Received [");
-    Serial.print(topic);
-    Serial.print("]: ");
-    Serial.println(message);
+void LuminaireController::handleMode(const byte *payload, unsigned int length)
+{
+    frameStartMicros = micros();
+    PayloadSpan message = PayloadSpan(payload, length).trim();
 
-    String topicStr = String(topic);
+    if (message.equalsIgnoreCase("timer"))
+    {
+        mode = LUMI_MODE_TIMER;
+    }
+    else if (message.equalsIgnoreCase("weather"))
+    {
+        mode = LUMI_MODE_WEATHER;
+    }
+    else if (message.equalsIgnoreCase("idle"))
+    {
+        mode = LUMI_MODE_IDLE;
+        // 初始化呼吸灯参数
+        breathBrightness = 0;
+        breathStart = renderClock.now();
+        lastBreathUpdate = breathStart;
+    }
+    else if (message.equalsIgnoreCase("music"))
+    {
+        mode = LUMI_MODE_MUSIC;
+    }
+
+    const char *modeNames[] = {"timer", "weather", "idle", "music"};
+    Serial.print("[Luminaire] Setting mode to: ");
+    Serial.println(modeNames[mode]);
 
-    if (topicStr.endsWith("/status"))
+    if (state == LUMI_ON)
     {
-        if (message == "on" || message == "ON" || message == "1")
-        {
-            Serial.println("[Luminaire] Setting state to ON");
-            state = LUMI_ON;
+        applyModeColor();
+    }
+}
 
-            // 如果是 IDLE 模式，初始化呼吸灯
-            if (mode == LUMI_MODE_IDLE)
-            {
-                breathBrightness = 0;
-                breathDirection = 1;
-                lastBreathUpdate = millis();
-            }
+void LuminaireController::handleDebugColor(const byte *payload, unsigned int length)
+{
+    // "index:#RRGGBB" 设置单个 LED，"#RRGGBB" 设置全部
+    frameStartMicros = micros();
+    PayloadSpan message(payload, length);
+    PayloadSpan indexStr, colorStr;
+    long index;
+    uint32_t color;
 
-            applyModeColor();
-        }
-        else if (message == "off" || message == "OFF" || message == "0")
+    if (message.split(':', indexStr, colorStr))
+    {
+        if (indexStr.toInt(index) && colorStr.toHexColor(color))
         {
-            Serial.println("[Luminaire] Setting state to OFF");
-            state = LUMI_OFF;
-            clear();
+            sendRGBToPixel(rgbRed(color), rgbGreen(color), rgbBlue(color), index);
+            return;
         }
     }
+    else if (message.toHexColor(color))
+    {
+        sendRGBToAll(rgbRed(color), rgbGreen(color), rgbBlue(color));
+        return;
+    }
+
+    Serial.print("[Luminaire] ✗ Invalid debug color: ");
+    message.printTo(Serial);
+    Serial.println();
+}
+
+void LuminaireController::handleDebugBrightness(const byte *payload, unsigned int length)
+{
+    // "index:0-255" 缩放单个 LED，"0-255" 缩放全部
+    frameStartMicros = micros();
+    PayloadSpan message(payload, length);
+    PayloadSpan indexStr, valueStr;
+    long index, value;
 
-    else if (topicStr.endsWith("/mode"))
+    if (message.split(':', indexStr, valueStr))
     {
-        message.toLowerCase();
-        if (message == "timer")
+        if (!indexStr.toInt(index) || !valueStr.toInt(value))
         {
-            mode = LUMI_MODE_TIMER;
+            Serial.println("[Luminaire] ✗ Invalid debug brightness");
+            return;
         }
-        else if (message == "weather")
+        uint8_t brightness = constrain(value, 0, 255);
+
+        if (index >= 0 && index < units.getCanvasLeds())
         {
-            mode = LUMI_MODE_WEATHER;
+            int r = RGBpayload[index * 3 + 0];
+            int g = RGBpayload[index * 3 + 1];
+            int b = RGBpayload[index * 3 + 2];
+
+            r = scale8(r, brightness);
+            g = scale8(g, brightness);
+            b = scale8(b, brightness);
+
+            sendRGBToPixel(r, g, b, index);
         }
-        else if (message == "idle")
+    }
+    else
+    {
+        if (!message.toInt(value))
         {
-            mode = LUMI_MODE_IDLE;
-            // 初始化呼吸灯参数
-            breathBrightness = 0;
-            breathDirection = 1;
-            lastBreathUpdate = millis();
+            Serial.println("[Luminaire] ✗ Invalid debug brightness");
+            return;
         }
-        else if (message == "music")
+        uint8_t brightness = constrain(value, 0, 255);
+
+        for (int i = 0; i < units.getCanvasLeds(); i++)
         {
-            mode = LUMI_MODE_MUSIC;
-        }
+            int r = RGBpayload[i * 3 + 0];
+            int g = RGBpayload[i * 3 + 1];
+            int b = RGBpayload[i * 3 + 2];
+
+            r = scale8(r, brightness);
+            g = scale8(g, brightness);
+            b = scale8(b, brightness);
 
-        const char *modeNames[] = {"timer", "weather", "idle", "music"};
-        Serial.print("[Luminaire] Setting mode to: ");
-        Serial.println(modeNames[mode]);
+            RGBpayload[i * 3 + 0] = (byte)r;
+            RGBpayload[i * 3 + 1] = (byte)g;
+            RGBpayload[i * 3 + 2] = (byte)b;
+        }
 
-        if (state == LUMI_ON)
+        if (mqtt && mqtt->isConnected())
         {
-            applyModeColor();
+            publishFrame();
         }
     }
+}
 
-    else if (topicStr.endsWith("/debug/color"))
+// 电流预算（mA，0 = 不限制），下一帧生效
+void LuminaireController::handlePowerBudget(const byte *payload, unsigned int length)
+{
+    long value;
+    if (!PayloadSpan(payload, length).toInt(value))
     {
+        Serial.println("[Luminaire] ✗ Invalid power budget");
+        return;
+    }
 
-        int colonPos = message.indexOf(':');
-        if (colonPos > 0)
-        {
+    // 每把伞灯的预算；上限保证 4 把伞的总预算仍在 uint16 范围内
+    int budget = constrain(value, 0, 15000);
+    powerBudget = budget;
+    applyPowerBudget();
 
-            int index = message.substring(0, colonPos).toInt();
-            String colorStr = message.substring(colonPos + 1);
-            int r, g, b;
-            getRGBFromHex(colorStr, r, g, b);
-            sendRGBToPixel(r, g, b, index);
-        }
-        else
-        {
+    Serial.print("[Luminaire] Power budget set to: ");
+    Serial.print(budget);
+    Serial.println(" mA per luminaire");
 
-            int r, g, b;
-            getRGBFromHex(message, r, g, b);
-            sendRGBToAll(r, g, b);
-        }
+    if (mqtt && mqtt->isConnected())
+    {
+        char text[8];
+        snprintf(text, sizeof(text), "%d", budget);
+        mqtt->publishInfo("power/budget", text, true);
     }
+}
+
+void LuminaireController::handleDebugIndex(const byte *payload, unsigned int length)
+{
+    frameStartMicros = micros();
 
-    else if (topicStr.endsWith("/debug/brightness"))
+    if (PayloadSpan(payload, length).trim().equalsIgnoreCase("clear"))
     {
+        clearDebug();
+    }
+}
 
-        int colonPos = message.indexOf(':');
-        int brightness;
+void LuminaireController::clearDebug()
+{
+    Serial.println("[Luminaire] Clearing DEBUG mode");
 
-        if (colonPos > 0)
-        {
+    if (state == LUMI_ON)
+    {
+        applyModeColor();
+    }
+    else
+    {
+        clear();
+    }
+}
 
-            int index = message.substring(0, colonPos).toInt();
-            brightness = message.substring(colonPos + 1).toInt();
+// 范围限制在 [0, limit) 内，返回实际处理的 LED 数
+static int clipRange(int &start, int count, int limit)
+{
+    if (start < 0)
+    {
+        count += start;
+        start = 0;
+    }
+    if (start + count > limit)
+    {
+        count = limit - start;
+    }
+    return count > 0 ? count : 0;
+}
 
-            if (index >= 0 && index < LUMINAIRE_NUM_LEDS)
-            {
-                int r = RGBpayload[index * 3 + 0];
-                int g = RGBpayload[index * 3 + 1];
-                int b = RGBpayload[index * 3 + 2];
+void LuminaireController::debugSetPixels(int start, const byte *rgb, int count)
+{
+    if (!isActive)
+    {
+        Serial.println("[Luminaire] ✗ Controller not active");
+        return;
+    }
 
-                r = (r * brightness) / 255;
-                g = (g * brightness) / 255;
-                b = (b * brightness) / 255;
+    rgb += (start < 0 ? -start : 0) * 3;
+    count = clipRange(start, count, units.getCanvasLeds());
+    if (count == 0)
+    {
+        return;
+    }
 
-                sendRGBToPixel(r, g, b, index);
-            }
-        }
-        else
-        {
+    frameStartMicros = micros();
+    memcpy(RGBpayload + start * 3, rgb, count * 3);
+    publishFrame();
+}
 
-            brightness = message.toInt();
-            for (int i = 0; i < LUMINAIRE_NUM_LEDS; i++)
-            {
-                int r = RGBpayload[i * 3 + 0];
-                int g = RGBpayload[i * 3 + 1];
-                int b = RGBpayload[i * 3 + 2];
+void LuminaireController::debugFillRange(int start, int count, uint32_t color)
+{
+    if (!isActive)
+    {
+        Serial.println("[Luminaire] ✗ Controller not active");
+        return;
+    }
 
-                r = (r * brightness) / 255;
-                g = (g * brightness) / 255;
-                b = (b * brightness) / 255;
+    count = clipRange(start, count, units.getCanvasLeds());
+    if (count == 0)
+    {
+        return;
+    }
 
-                RGBpayload[i * 3 + 0] = (byte)r;
-                RGBpayload[i * 3 + 1] = (byte)g;
-                RGBpayload[i * 3 + 2] = (byte)b;
-            }
+    frameStartMicros = micros();
+    for (int i = start; i < start + count; i++)
+    {
+        rgbWrite(RGBpayload + i * 3, color);
+    }
+    publishFrame();
+}
 
-            if (mqtt && mqtt->isConnected())
-            {
-                mqtt->publish(mqttTopic.c_str(), RGBpayload, LUMINAIRE_PAYLOAD_SIZE, false);
-            }
-        }
+void LuminaireController::debugBrightnessRange(int start, int count, uint8_t brightness)
+{
+    if (!isActive)
+    {
+        Serial.println("[Luminaire] ✗ Controller not active");
+        return;
     }
 
-    else if (topicStr.endsWith("/debug/index"))
+    count = clipRange(start, count, units.getCanvasLeds());
+    if (count == 0)
     {
-        if (message == "clear" || message == "CLEAR")
-        {
-            Serial.println("[Luminaire] Clearing DEBUG mode");
+        return;
+    }
 
-            if (state == LUMI_ON)
-            {
-                applyModeColor();
-            }
-            else
-            {
-                clear();
-            }
-        }
+    frameStartMicros = micros();
+    for (int i = start * 3; i < (start + count) * 3; i++)
+    {
+        RGBpayload[i] = scale8(RGBpayload[i], brightness);
     }
+    publishFrame();
 }
 
 void LuminaireController::applyModeColor()
@@ -409,35 +672,18 @@ void LuminaireController::applyModeColor()
 
 void LuminaireController::updateBreathingEffect()
 {
-    unsigned long now = millis();
+    unsigned long now = renderClock.now();
 
-    // 每20ms更新一次亮度
+    // 每20ms刷新一次；亮度只由经过的时间决定，loop() 卡顿时不会变慢
     if (now - lastBreathUpdate > 20)
     {
-        breathBrightness += breathDirection * 2;
-
-        if (breathBrightness >= 255)
-        {
-            breathBrightness = 255;
-            breathDirection = -1;
-        }
-        else if (breathBrightness <= 0)
-        {
-            breathBrightness = 0;
-            breathDirection = 1;
-        }
+        uint8_t phase = renderClock.phase8(BREATH_PERIOD_MS, breathStart);
+        breathBrightness = Curves::forEffect(CURVE_EFFECT_IDLE, phase);
 
-        // 应用呼吸效果到IDLE颜色
-        int r = (idleColor >> 16) & 0xFF;
-        int g = (idleColor >> 8) & 0xFF;
-        int b = idleColor & 0xFF;
+        // 根据呼吸亮度调整IDLE颜色
+        uint32_t color = rgbScale8(idleColor, breathBrightness);
 
-        // 根据呼吸亮度调整RGB值
-        r = (r * breathBrightness) / 255;
-        g = (g * breathBrightness) / 255;
-        b = (b * breathBrightness) / 255;
-
-        sendRGBToAll(r, g, b);
+        sendRGBToAll(rgbRed(color), rgbGreen(color), rgbBlue(color));
 
         lastBreathUpdate = now;
     }
@@ -445,6 +691,8 @@ void LuminaireController::updateBreathingEffect()
 
 void LuminaireController::updateMusicSpectrum()
 {
+    PROFILE_SCOPE(PROF_MUSIC_SPECTRUM);
+
     // 提前检查 MQTT 连接，避免每个像素都检查
     if (!mqtt || !mqtt->isConnected())
     {
@@ -458,166 +706,115 @@ void LuminaireController::updateMusicSpectrum()
         return;
     }
 
-    // 72 灯布局：12 列（频段）× 6 行（高度）
-    // LED 索引映射（每列倒序）：
-    // 列 0: 5,4,3,2,1,0 (底→顶)
-    // 列 1: 11,10,9,8,7,6
-    // 列 2: 17,16,15,14,13,12
-    // ...
-    // 列 11: 71,70,69,68,67,66
+    // 伞状布局：每条伞骨是一列（频段），伞骨上的位置是行（高度）
+    // 行 0 在中心（顶部），边缘（底部）为最后一行，LED 编号由 UmbrellaCanvas::index(列, 行) 给出
+    // 多把伞灯时频段铺满整张画布（所有伞骨连在一起），每把伞显示其中一段
 
-    float bands[12];
+    float bands[NUM_BANDS];
     musicMode->getSpectrumData(bands);
 
-    // 行颜色（从底部到顶部的渐变）
-    // 底部（行 5）：绿色 → 顶部（行 0）：红色
-    uint8_t rowColors[6][3] = {
-        {255, 0, 0},   // 行 0（顶部）：红色（最响亮）
-        {255, 128, 0}, // 行 1：橙色
-        {255, 255, 0}, // 行 2：黄色
-        {128, 255, 0}, // 行 3：黄绿
-        {0, 255, 0},   // 行 4：绿色
-        {0, 255, 128}  // 行 5（底部）：青绿（最安静）
-    };
+    // 行颜色：从底部（边缘，最安静）到顶部（中心，最响亮）取样调色板
+    const uint32_t *palette = getPalette(PALETTE_SPECTRUM);
 
     // 调试：每 5 秒打印一次频谱数据
     static unsigned long lastDebug = 0;
     if (millis() - lastDebug > 5000)
     {
         Serial.print("[Luminaire] Spectrum: ");
-        for (int i = 0; i < 12; i++)
+        for (int i = 0; i < NUM_BANDS; i++)
         {
             Serial.print(bands[i], 2);
-            if (i < 11)
+            if (i < NUM_BANDS - 1)
                 Serial.print(",");
         }
         Serial.println();
         lastDebug = millis();
     }
 
-    // 填充 12 个频段（列）
-    for (int col = 0; col < 12; col++)
+    // 每条伞骨显示一个频段（伞骨数与频段数不同时按比例取样）
+    const int columns = units.getCanvasRibs();
+    for (int col = 0; col < columns; col++)
     {
-        // 计算这一列应该显示的精确高度（0.0 - 6.0）
-        float exactHeight = bands[col] * 6.0;
-        if (exactHeight > 6.0)
-            exactHeight = 6.0;
+        int band = col * NUM_BANDS / columns;
+
+        // 这一列应该显示的精确高度（Q8.8，0 - 行数），每列只做一次浮点转换
+        float level = bands[band];
+        if (level > 1.0)
+            level = 1.0;
+        if (level < 0.0)
+            level = 0.0;
+        uint16_t exactHeight = (uint16_t)(level * Umbrella::NUM_POSITIONS * 256);
 
         // 完全点亮的块数量（向下取整）
-        int fullBlocks = (int)exactHeight;
+        int fullBlocks = exactHeight >> 8;
 
-        // 部分点亮的块亮度（0.0 - 1.0）
-        float partialBrightness = exactHeight - fullBlocks;
+        // 部分点亮的块亮度（0 - 255）
+        uint8_t partialBrightness = exactHeight & 0xFF;
 
-        // 从底部（行 5）到顶部（行 0）填充
-        for (int row = 5; row >= 0; row--)
+        // 从底部（边缘）到顶部（中心）填充
+        for (int row = Umbrella::EDGE_POSITION; row >= 0; row--)
         {
-            // 计算该列该行的 LED 索引
-            // 每列从底到顶：col*6+5, col*6+4, ..., col*6+0
-            int ledIndex = col * 6 + row;
+            int ledIndex = UmbrellaCanvas::index(col, row);
 
-            // 计算当前块在这一列中的位置（0=底部，5=顶部）
-            int blockPosition = 5 - row;
+            // 计算当前块在这一列中的位置（0=底部）
+            int blockPosition = Umbrella::EDGE_POSITION - row;
 
-            int r, g, b;
+            uint32_t color;
 
             if (blockPosition < fullBlocks)
             {
                 // 完全点亮：使用该行的颜色，全亮度
-                r = rowColors[row][0];
-                g = rowColors[row][1];
-                b = rowColors[row][2];
+                color = paletteLookup(palette, blockPosition * 255 / Umbrella::EDGE_POSITION);
             }
-            else if (blockPosition == fullBlocks && partialBrightness > 0.05)
+            else if (blockPosition == fullBlocks && partialBrightness > 13)
             {
-                // 部分点亮：使用该行的颜色，按比例亮度
-                r = (int)(rowColors[row][0] * partialBrightness);
-                g = (int)(rowColors[row][1] * partialBrightness);
-                b = (int)(rowColors[row][2] * partialBrightness);
+                // 部分点亮：使用该行的颜色，按比例亮度（> 5%）
+                color = rgbScale8(paletteLookup(palette, blockPosition * 255 / Umbrella::EDGE_POSITION), partialBrightness);
             }
             else
             {
                 // 熄灭：完全关闭
-                r = 0;
-                g = 0;
-                b = 0;
+                color = 0;
             }
 
             // 直接更新 payload 数组，不发送
-            RGBpayload[ledIndex * 3 + 0] = (byte)r;
-            RGBpayload[ledIndex * 3 + 1] = (byte)g;
-            RGBpayload[ledIndex * 3 + 2] = (byte)b;
+            rgbWrite(RGBpayload + ledIndex * 3, color);
         }
     }
 
     // 所有像素更新完成后，只发送一次 MQTT 消息
-    mqtt->publish(mqttTopic.c_str(), RGBpayload, LUMINAIRE_PAYLOAD_SIZE, false);
-}
-
-void LuminaireController::getRGBFromHex(const String &hexColor, int &r, int &g, int &b)
-{
-    String color = hexColor;
-    if (color.startsWith("#"))
-    {
-        color = color.substring(1);
-    }
-
-    if (color.length() == 6)
-    {
-        r = strtol(color.substring(0, 2).c_str(), NULL, 16);
-        g = strtol(color.substring(2, 4).c_str(), NULL, 16);
-        b = strtol(color.substring(4, 6).c_str(), NULL, 16);
-    }
+    publishFrame();
 }
 
 // ========================================
-// 伞状LED映射工具函数
+// 天气数据更新
 // ========================================
 
-// 获取指定伞骨和位置的LED编号
-// rib: 0-11 (12条伞骨)
-// position: 0-5 (0=边缘顶部, 5=中心底部)
-int LuminaireController::getUmbrellaLED(int rib, int position)
+// 数值字段：JSON 数字直接读取，字符串（"12"、"0.5"）按文本转换；缺失或其他类型返回 false
+static bool readNumber(JsonVariantConst value, float &out)
 {
-    if (rib < 0 || rib >= 12 || position < 0 || position >= 6)
+    if (value.is<float>())
     {
-        return -1;
+        out = value.as<float>();
+        return true;
     }
-    return rib * 6 + position; // 每条伞骨6个LED (LED 0-5)
-}
-
-// 设置单个伞骨LED的颜色
-void LuminaireController::setUmbrellaPixel(int rib, int position, int r, int g, int b)
-{
-    int ledIndex = getUmbrellaLED(rib, position);
-    if (ledIndex >= 0 && ledIndex < LUMINAIRE_NUM_LEDS)
-    {
-        RGBpayload[ledIndex * 3 + 0] = (byte)r;
-        RGBpayload[ledIndex * 3 + 1] = (byte)g;
-        RGBpayload[ledIndex * 3 + 2] = (byte)b;
-    }
-}
 
-// 设置径向环（所有伞骨的同一位置）
-void LuminaireController::setRadialRing(int position, int r, int g, int b)
-{
-    for (int rib = 0; rib < 12; rib++)
+    const char *text = value.as<const char *>();
+    if (text != nullptr)
     {
-        setUmbrellaPixel(rib, position, r, g, b);
+        out = atof(text);
+        return true;
     }
+    return false;
 }
 
-// ========================================
-// 天气数据更新
-// ========================================
-
-void LuminaireController::updateWeatherData(const String &weatherJson)
+void LuminaireController::updateWeatherData(const PayloadSpan &weatherJson)
 {
     Serial.println("[Luminaire Weather] Parsing weather JSON...");
 
-    // 解析JSON
-    DynamicJsonDocument doc(1024);
-    DeserializationError error = deserializeJson(doc, weatherJson);
+    // 解析JSON（直接解析原始字节，文档放在栈上，不分配堆内存）
+    StaticJsonDocument<1024> doc;
+    DeserializationError error = deserializeJson(doc, weatherJson.data, weatherJson.length);
 
     if (error)
     {
@@ -626,55 +823,58 @@ void LuminaireController::updateWeatherData(const String &weatherJson)
         return;
     }
 
-    // 提取天气数据
-    if (doc.containsKey("temp_C"))
+    // 提取天气数据（wttr.in 的数值字段是字符串，其他来源可能直接给数字，两种都接受）
+    float number;
+
+    if (readNumber(doc["temp_C"], number))
     {
-        currentTemp = doc["temp_C"].as<String>().toFloat();
+        currentTemp = number;
     }
 
-    if (doc.containsKey("FeelsLikeC"))
+    if (readNumber(doc["FeelsLikeC"], number))
     {
-        feelsLikeTemp = doc["FeelsLikeC"].as<String>().toFloat();
+        feelsLikeTemp = number;
     }
 
-    if (doc.containsKey("humidity"))
+    if (readNumber(doc["humidity"], number))
     {
-        humidity = doc["humidity"].as<String>().toInt();
+        humidity = (int)number;
     }
 
-    if (doc.containsKey("windspeedKmph"))
+    if (readNumber(doc["windspeedKmph"], number))
     {
-        windSpeed = doc["windspeedKmph"].as<String>().toInt();
+        windSpeed = (int)number;
     }
 
-    if (doc.containsKey("winddir16Point"))
+    const char *text;
+    if ((text = doc["winddir16Point"].as<const char *>()) != nullptr)
     {
-        windDirection = doc["winddir16Point"].as<String>();
+        snprintf(windDirection, sizeof(windDirection), "%s", text);
     }
 
-    if (doc.containsKey("visibility"))
+    if (readNumber(doc["visibility"], number))
     {
-        visibility = doc["visibility"].as<String>().toInt();
+        visibility = (int)number;
     }
 
-    if (doc.containsKey("cloudcover"))
+    if (readNumber(doc["cloudcover"], number))
     {
-        cloudCover = doc["cloudcover"].as<String>().toInt();
+        cloudCover = (int)number;
     }
 
-    if (doc.containsKey("precipMM"))
+    if (readNumber(doc["precipMM"], number))
     {
-        precipitation = doc["precipMM"].as<String>().toFloat();
+        precipitation = number;
     }
 
-    if (doc.containsKey("weatherCode"))
+    if (readNumber(doc["weatherCode"], number))
     {
-        weatherCode = doc["weatherCode"].as<String>();
+        weatherCode = (int)number;
     }
 
-    if (doc.containsKey("weatherDesc"))
+    if ((text = doc["weatherDesc"].as<const char *>()) != nullptr)
     {
-        weatherDesc = doc["weatherDesc"].as<String>();
+        snprintf(weatherDesc, sizeof(weatherDesc), "%s", text);
     }
 
     Serial.println("[Luminaire Weather] Weather data updated:");
@@ -716,20 +916,16 @@ void LuminaireController::updateWeatherData(const String &weatherJson)
 // 第一行：湿度 - 蓝色，湿度越大越亮
 void LuminaireController::renderHumidity()
 {
-    // 湿度0-100%映射到蓝色亮度
-    float humidityNorm = humidity / 100.0;
+    // 湿度0-100%映射到调色板（默认：蓝色亮度）
+    uint8_t level = constrain(humidity, 0, 100) * 255 / 100;
 
-    int r = 0;
-    int g = 0;
-    int b = (int)(255 * humidityNorm);
-
-    setRadialRing(0, r, g, b);
+    UmbrellaCanvas::setRing(RGBpayload, 0, paletteLookup(getPalette(PALETTE_HUMIDITY), level), units.getCanvasRibs());
 }
 
 // 第二行：风速 - 白色追逐光点
 void LuminaireController::renderWindSpeed()
 {
-    unsigned long now = millis();
+    unsigned long now = renderClock.now();
 
     // 根据风速决定更新频率和光点数量
     int updateInterval;
@@ -782,36 +978,34 @@ void LuminaireController::renderWindSpeed()
         brightness3 = 120; // 第三个更暗
     }
 
-    // 检查是否需要更新
-    if (windSpeed > 0 && now - lastWindUpdate < updateInterval)
-    {
-        return; // 保持当前状态
-    }
-
-    if (windSpeed > 0)
+    // 连续推进：平均速度仍为每 updateInterval 前进一条伞骨，但每帧都按亚像素位置重绘
+    // 光点绕整张画布走一圈，多把伞灯时依次经过每一把
+    const uint8_t ribs = units.getCanvasRibs();
+    const uint16_t PHASE_WRAP = ribs * 256;
+    unsigned long elapsed = now - lastWindUpdate;
+    lastWindUpdate = now;
+    if (windSpeed > 0 && elapsed < 1000)
     {
-        lastWindUpdate = now;
-        windAnimationOffset = (windAnimationOffset + 1) % 12;
+        windPhase = (windPhase + elapsed * 256 / updateInterval) % PHASE_WRAP;
     }
 
     // 清除第二行
-    setRadialRing(1, 0, 0, 0);
+    UmbrellaCanvas::setRing(RGBpayload, 1, 0, ribs);
 
     // 绘制光点
     if (numDots >= 1)
     {
-        int rib1 = windAnimationOffset;
-        setUmbrellaPixel(rib1, 1, brightness1, brightness1, brightness1);
+        UmbrellaCanvas::splatRing(RGBpayload, 1, windPhase, rgbPack(brightness1, brightness1, brightness1), ribs);
     }
     if (numDots >= 2)
     {
-        int rib2 = (windAnimationOffset + 6) % 12; // 对面位置
-        setUmbrellaPixel(rib2, 1, brightness2, brightness2, brightness2);
+        uint16_t phase2 = (windPhase + PHASE_WRAP / 2) % PHASE_WRAP; // 对面位置
+        UmbrellaCanvas::splatRing(RGBpayload, 1, phase2, rgbPack(brightness2, brightness2, brightness2), ribs);
     }
     if (numDots >= 3)
     {
-        int rib3 = (windAnimationOffset + 4) % 12; // 三分之一位置
-        setUmbrellaPixel(rib3, 1, brightness3, brightness3, brightness3);
+        uint16_t phase3 = (windPhase + PHASE_WRAP / 3) % PHASE_WRAP; // 三分之一位置
+        UmbrellaCanvas::splatRing(RGBpayload, 1, phase3, rgbPack(brightness3, brightness3, brightness3), ribs);
     }
 }
 
@@ -831,80 +1025,26 @@ void LuminaireController::renderVisibility()
     else
     {
         // 5-20km线性映射到0-255
-        brightness = (int)((visibility - 5) / 15.0 * 255);
+        brightness = (visibility - 5) * 255 / 15;
     }
 
-    setRadialRing(2, brightness, brightness, brightness);
+    UmbrellaCanvas::setRing(RGBpayload, 2, rgbPack(brightness, brightness, brightness), units.getCanvasRibs());
 }
 
-// 第四行：当前温度 - 白/蓝/绿/黄/红，温度越高越亮
+// 第四行：当前温度 - 温度渐变调色板（白/蓝/绿/黄/红）
 void LuminaireController::renderTemperature()
 {
-    int r, g, b;
-
-    if (currentTemp < -10)
-    {
-        // < -10°C: 最亮白光
-        r = 255;
-        g = 255;
-        b = 255;
-    }
-    else if (currentTemp < 0)
-    {
-        // (-10, 0)°C: 白光，温度越低越亮
-        float ratio = (currentTemp + 10) / 10.0;   // 0.0到1.0
-        int brightness = (int)(255 * (1 - ratio)); // 越低越亮
-        r = brightness;
-        g = brightness;
-        b = brightness;
-    }
-    else if (currentTemp < 10)
-    {
-        // (0, 10)°C: 蓝光，温度越高越亮
-        float ratio = currentTemp / 10.0;
-        r = 0;
-        g = 0;
-        b = (int)(255 * ratio);
-    }
-    else if (currentTemp < 20)
-    {
-        // (10, 20)°C: 绿光，温度越高越亮
-        float ratio = (currentTemp - 10) / 10.0;
-        r = 0;
-        g = (int)(255 * ratio);
-        b = 0;
-    }
-    else if (currentTemp < 30)
-    {
-        // (20, 30)°C: 黄光，温度越高越亮
-        float ratio = (currentTemp - 20) / 10.0;
-        r = (int)(255 * ratio);
-        g = (int)(255 * ratio);
-        b = 0;
-    }
-    else if (currentTemp < 40)
-    {
-        // (30, 40)°C: 红光，温度越高越亮
-        float ratio = (currentTemp - 30) / 10.0;
-        r = (int)(255 * ratio);
-        g = 0;
-        b = 0;
-    }
-    else
-    {
-        // >= 40°C: 最亮红光
-        r = 255;
-        g = 0;
-        b = 0;
-    }
+    // -10°C - 40°C 映射到调色板（默认：白/蓝/绿/黄/红），温度只转换一次为 0.1°C 整数
+    int tenths = constrain((int)(currentTemp * 10), -100, 400);
+    uint8_t level = (tenths + 100) * 255 / 500;
 
-    setRadialRing(3, r, g, b);
+    UmbrellaCanvas::setRing(RGBpayload, 3, paletteLookup(getPalette(PALETTE_TEMPERATURE), level), units.getCanvasRibs());
 }
 
 // 第五行：体感温度 - 闪烁的aqua或橙黄色
 void LuminaireController::renderFeelsLike()
 {
-    unsigned long now = millis();
+    unsigned long now = renderClock.now();
 
     float tempDiff = feelsLikeTemp - currentTemp;
 
@@ -953,27 +1093,24 @@ void LuminaireController::renderFeelsLike()
         }
     }
 
-    setRadialRing(4, r, g, b);
+    UmbrellaCanvas::setRing(RGBpayload, 4, rgbPack(r, g, b), units.getCanvasRibs());
 }
 
 // 第六行：云量 - 棕色，云量越多越深
 void LuminaireController::renderCloudCover()
 {
-    // 云量0-100%映射到棕色深度
-    float cloudNorm = cloudCover / 100.0;
+    // 云量0-100%映射到调色板（默认：棕色 RGB(165, 42, 42) 深度）
+    uint8_t level = constrain(cloudCover, 0, 100) * 255 / 100;
 
-    // 棕色 RGB(165, 42, 42) - 深棕色
-    int r = (int)(165 * cloudNorm);
-    int g = (int)(42 * cloudNorm);
-    int b = (int)(42 * cloudNorm);
-
-    setRadialRing(5, r, g, b);
+    UmbrellaCanvas::setRing(RGBpayload, 5, paletteLookup(getPalette(PALETTE_CLOUD), level), units.getCanvasRibs());
 }
 
 // 主天气可视化更新函数
 void LuminaireController::updateWeatherVisualization()
 {
-    unsigned long now = millis();
+    PROFILE_SCOPE(PROF_WEATHER_VIZ);
+
+    unsigned long now = renderClock.now();
 
     // 检查是否需要切换显示模式（静态数据 ↔ 动画效果）
     if (now - lastModeSwitch >= DISPLAY_DURATION)
@@ -1026,8 +1163,8 @@ void LuminaireController::updateWeatherVisualization()
         lastDebugPrint = now;
     }
 
-    // 清空payload
-    memset(RGBpayload, 0, LUMINAIRE_PAYLOAD_SIZE);
+    // 清空画布
+    memset(RGBpayload, 0, units.getCanvasLeds() * 3);
 
     // 按层渲染（新的6行设计）
     renderHumidity();    // 第一行：湿度 (位置0)
@@ -1040,6 +1177,6 @@ void LuminaireController::updateWeatherVisualization()
     // 发送到MQTT
     if (mqtt && mqtt->isConnected())
     {
-        mqtt->publish(mqttTopic.c_str(), RGBpayload, LUMINAIRE_PAYLOAD_SIZE, false);
+        publishFrame();
     }
 }
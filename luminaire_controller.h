@@ -3,14 +3,23 @@
 
 #include <Arduino.h>
 #include "mqtt_manager.h"
+#include "output_stage.h"
+#include "palette.h"
+#include "frame_recorder.h"
+#include "luminaire_group.h"
+#include "payload_parser.h"
+#include "umbrella_geometry.h"
 
 // 前向声明
 class MusicMode;
 class AudioAnalyzer;
 class WeatherAnimation;
 
-#define LUMINAIRE_NUM_LEDS 72
+#define LUMINAIRE_NUM_LEDS Umbrella::NUM_LEDS
 #define LUMINAIRE_PAYLOAD_SIZE (LUMINAIRE_NUM_LEDS * 3)
+#define LUMINAIRE_CANVAS_LEDS UmbrellaCanvas::NUM_LEDS    // 共享画布最大 LED 数（伞灯组见 luminaire_group.h）
+#define LUMINAIRE_CANVAS_SIZE UmbrellaCanvas::FRAME_SIZE
+#define LUMINAIRE_POWER_BUDGET_MA 2000 // 每把伞灯的默认电流预算
 
 enum LuminaireMode
 {
@@ -33,10 +42,17 @@ private:
     MusicMode *musicMode;         // Music 模式引用
     AudioAnalyzer *audioAnalyzer; // 音频分析器引用
     WeatherAnimation *weatherAnim; // 天气动画引用
+    PaletteManager *palettes;      // 调色板（未设置时使用默认调色板）
 
-    String lightId;
-    String mqttTopic;
-    byte RGBpayload[LUMINAIRE_PAYLOAD_SIZE];
+    unsigned long lastRenderMicros; // 上一次 loop() 渲染耗时（含发送）
+    unsigned long frameStartMicros; // 本次 loop() 开始时间（帧信息中的渲染耗时从这里算起）
+
+    LuminaireGroup units; // 从共享画布取切片的伞灯（默认只有 begin() 指定的一把）
+    byte RGBpayload[LUMINAIRE_CANVAS_SIZE];    // 逻辑画布（感知亮度），实际宽度 = units.getCanvasRibs()
+    byte outputPayload[LUMINAIRE_CANVAS_SIZE]; // 经过输出级后的画布，各伞灯从这里取切片发送
+    OutputStage outputStage;                   // 伽马 + 抖动输出级
+    FrameRecorder recorder;                    // 发送帧录制 / 回放（整张画布）
+    uint16_t powerBudget;                      // 每把伞灯的电流预算（mA，0 = 不限制）
 
     bool isActive;
     LuminaireState state;
@@ -46,7 +62,7 @@ private:
 
     // 呼吸灯效果变量
     unsigned long lastBreathUpdate;
-    int breathDirection;
+    unsigned long breathStart; // 呼吸起点（相位 0 = 最暗）
     int breathBrightness;
 
     // 天气可视化相关变量
@@ -54,16 +70,16 @@ private:
     float feelsLikeTemp;  // 体感温度
     int humidity;         // 湿度
     int windSpeed;        // 风速 (km/h)
-    String windDirection; // 风向
+    char windDirection[8]; // 风向
     int visibility;       // 能见度 (km)
     int cloudCover;       // 云量 (%)
     float precipitation;  // 降水量 (mm)
-    String weatherCode;   // 天气代码
-    String weatherDesc;   // 天气描述
+    int weatherCode;      // 天气代码
+    char weatherDesc[32]; // 天气描述
 
     unsigned long lastWeatherUpdate;
     unsigned long lastWindUpdate;
-    int windAnimationOffset; // 风速动画偏移
+    uint16_t windPhase;      // 风速光点位置（Q8.8 伞骨编号）
     
     // 天气动画切换控制
     bool showingAnimation;           // 当前是否显示动画
@@ -71,15 +87,13 @@ private:
     static const unsigned long DISPLAY_DURATION = 5000; // 每个模式显示5秒
 
     void applyModeColor();
+    void applyPowerBudget();           // 画布按 伞灯数 × 每把预算 限流
+    void publishFrame();               // 经过输出级后发送整帧
+
+    const uint32_t *getPalette(PaletteRole role) const; // 当前调色板（未设置时为默认）
     void updateMusicSpectrum();        // 新增：更新 Music 频谱显示
     void updateBreathingEffect();      // 新增：更新 IDLE 呼吸灯效果
     void updateWeatherVisualization(); // 新增：更新天气可视化
-    void getRGBFromHex(const String &hexColor, int &r, int &g, int &b);
-
-    // 伞状LED映射工具函数
-    int getUmbrellaLED(int rib, int position);                         // 获取指定伞骨和位置的LED编号
-    void setUmbrellaPixel(int rib, int position, int r, int g, int b); // 设置单个LED
-    void setRadialRing(int position, int r, int g, int b);             // 设置径向环（所有伞骨的同一位置）
 
     // 天气可视化渲染函数（新的6行设计）
     void renderHumidity();         // 第一行：湿度（蓝色，越大越亮）
@@ -102,24 +116,48 @@ public:
     // 设置天气动画
     void setWeatherAnimation(WeatherAnimation *anim);
 
+    // 设置调色板
+    void setPaletteManager(PaletteManager *manager);
+
     // 主循环（用于 Music 模式更新）
     void loop();
 
-    void handleMQTTMessage(char *topic, byte *payload, unsigned int length);
+    // MQTT 命令（由 Aura_Light.ino 注册的主题处理函数调用）
+    void handleStatus(const byte *payload, unsigned int length);
+    void handleMode(const byte *payload, unsigned int length);
+    void handleDebugColor(const byte *payload, unsigned int length);
+    void handleDebugBrightness(const byte *payload, unsigned int length);
+    void handleDebugIndex(const byte *payload, unsigned int length);
+    void handlePowerBudget(const byte *payload, unsigned int length);
+
+    // 录制 / 回放命令: start | stop | clear | status | replay [speed]
+    void handleRecorderCommand(const PayloadSpan &command);
+
+    // 伞灯组配置："<id>[:<ribOffset>][m],..."，例如 "16,17:3,18:6m"
+    void handleUnitsCommand(const PayloadSpan &command);
 
     void sendRGBToPixel(int r, int g, int b, int pixel);
 
     void sendRGBToAll(int r, int g, int b);
+
+    // 批量调试（二进制命令）：修改一段 LED（画布 LED 编号），只发送一帧
+    void debugSetPixels(int start, const byte *rgb, int count); // rgb: count × 3 字节
+    void debugFillRange(int start, int count, uint32_t color);
+    void debugBrightnessRange(int start, int count, uint8_t brightness);
+    void clearDebug(); // 恢复当前模式的画面
     
     // 批量更新所有LED（用于动画）
+    // size = 一把伞（LUMINAIRE_PAYLOAD_SIZE）时平铺到画布的每一段，= 当前画布大小时整张替换
     void updateAllLEDs(byte *data, int size);
 
     void clear();
 
     // 天气数据更新接口
-    void updateWeatherData(const String &weatherJson); // 更新天气数据
+    void updateWeatherData(const PayloadSpan &weatherJson); // 更新天气数据
 
     int getNumLEDs() const { return LUMINAIRE_NUM_LEDS; }
+    const byte *getFrame() const { return RGBpayload; } // 当前逻辑画布（输出级之前），前 LUMINAIRE_PAYLOAD_SIZE 字节是第一段
+    unsigned long getLastRenderMicros() const { return lastRenderMicros; }
 
     bool isOn() const { return state == LUMI_ON; }
     LuminaireMode getMode() const { return mode; }
@@ -135,14 +173,13 @@ public:
 
     // 设置和获取 IDLE 颜色
     void setIdleColor(uint32_t color) { idleColor = color; }
-    String getIdleColor() const
+    const char *getIdleColor(char *buffer, size_t size) const // #RRGGBB，返回 buffer
     {
-        char hex[8];
-        sprintf(hex, "#%02X%02X%02X",
-                (uint8_t)((idleColor >> 16) & 0xFF),
-                (uint8_t)((idleColor >> 8) & 0xFF),
-                (uint8_t)(idleColor & 0xFF));
-        return String(hex);
+        snprintf(buffer, size, "#%02X%02X%02X",
+                 (uint8_t)((idleColor >> 16) & 0xFF),
+                 (uint8_t)((idleColor >> 8) & 0xFF),
+                 (uint8_t)(idleColor & 0xFF));
+        return buffer;
     }
 };
 
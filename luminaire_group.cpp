@@ -0,0 +1,222 @@
+#include "luminaire_group.h"
+
+LuminaireGroup::LuminaireGroup()
+    : count(0),
+      frameSeq(0)
+{
+    memset(unitFrame, 0, sizeof(unitFrame));
+}
+
+void LuminaireGroup::reset(const PayloadSpan &id)
+{
+    count = 0;
+    addUnit(id);
+}
+
+bool LuminaireGroup::addUnit(const PayloadSpan &id, int start, uint8_t rotation, bool mirrored)
+{
+    if (count >= LUMINAIRE_MAX_UNITS || id.isEmpty() || id.length >= LUMINAIRE_ID_SIZE)
+    {
+        return false;
+    }
+
+    Unit &unit = units[count];
+    id.copyTo(unit.id, sizeof(unit.id));
+    // 主题 = 前缀 + ID（topic 的大小已按两者之和预留）
+    const size_t prefixLength = sizeof(LUMINAIRE_TOPIC_PREFIX) - 1;
+    memcpy(unit.topic, LUMINAIRE_TOPIC_PREFIX, prefixLength);
+    id.copyTo(unit.topic + prefixLength, sizeof(unit.topic) - prefixLength);
+    unit.start = UmbrellaCanvas::wrapRib(start < 0 ? count * Umbrella::NUM_RIBS : start);
+    unit.rotation = Umbrella::wrapRib(rotation);
+    unit.mirrored = mirrored;
+    count++;
+    return true;
+}
+
+bool LuminaireGroup::configure(const PayloadSpan &payload)
+{
+    PayloadSpan ids[LUMINAIRE_MAX_UNITS];
+    int starts[LUMINAIRE_MAX_UNITS];
+    uint8_t rotations[LUMINAIRE_MAX_UNITS];
+    bool mirrors[LUMINAIRE_MAX_UNITS];
+    uint8_t parsed = 0;
+
+    // 先完整解析，全部合法后再替换当前配置
+    PayloadTokenizer items(payload);
+    PayloadSpan item;
+    while (items.next(item))
+    {
+        if (item.isEmpty())
+        {
+            continue;
+        }
+        if (parsed >= LUMINAIRE_MAX_UNITS)
+        {
+            Serial.print("[Luminaire] ✗ Too many units (max ");
+            Serial.print(LUMINAIRE_MAX_UNITS);
+            Serial.println(")");
+            return false;
+        }
+
+        bool mirrored = false;
+        char last = item[item.length - 1];
+        if (last == 'm' || last == 'M')
+        {
+            mirrored = true;
+            item = item.sub(0, item.length - 1);
+        }
+
+        long rotation = 0;
+        PayloadSpan head, value;
+        if (item.split(':', head, value))
+        {
+            if (!value.toInt(rotation))
+            {
+                Serial.print("[Luminaire] ✗ Invalid rotation: ");
+                value.printTo(Serial);
+                Serial.println();
+                return false;
+            }
+            item = head;
+        }
+
+        long start = -1;
+        if (item.split('@', head, value))
+        {
+            if (!value.toInt(start) || start < 0)
+            {
+                Serial.print("[Luminaire] ✗ Invalid slice start: ");
+                value.printTo(Serial);
+                Serial.println();
+                return false;
+            }
+            item = head;
+        }
+
+        item = item.trim();
+        if (item.isEmpty())
+        {
+            Serial.println("[Luminaire] ✗ Missing luminaire ID");
+            return false;
+        }
+        if (item.length >= LUMINAIRE_ID_SIZE)
+        {
+            Serial.print("[Luminaire] ✗ Luminaire ID too long: ");
+            item.printTo(Serial);
+            Serial.println();
+            return false;
+        }
+
+        ids[parsed] = item;
+        starts[parsed] = start < 0 ? -1 : UmbrellaCanvas::wrapRib(start);
+        rotations[parsed] = Umbrella::wrapRib(rotation);
+        mirrors[parsed] = mirrored;
+        parsed++;
+    }
+
+    if (parsed == 0)
+    {
+        Serial.println("[Luminaire] ✗ No luminaire units given");
+        return false;
+    }
+
+    count = 0;
+    for (uint8_t i = 0; i < parsed; i++)
+    {
+        addUnit(ids[i], starts[i], rotations[i], mirrors[i]);
+    }
+
+    char text[64];
+    Serial.print("[Luminaire] ✓ Units: ");
+    Serial.println(describe(text, sizeof(text)));
+    return true;
+}
+
+const byte *LuminaireGroup::mapFrame(const Unit &unit, const byte *canvas)
+{
+    // 画布和单把伞的帧一样按伞骨排列，每条伞骨是连续的 NUM_POSITIONS * 3 字节
+    const uint16_t ribBytes = Umbrella::NUM_POSITIONS * 3;
+    const uint8_t canvasRibs = getCanvasRibs();
+    uint8_t start = unit.start % canvasRibs;
+
+    if (unit.rotation == 0 && !unit.mirrored && start + Umbrella::NUM_RIBS <= canvasRibs)
+    {
+        return canvas + start * ribBytes;
+    }
+
+    for (uint8_t rib = 0; rib < Umbrella::NUM_RIBS; rib++)
+    {
+        uint8_t sliceRib = Umbrella::wrapRib((unit.mirrored ? -(int)rib : (int)rib) + unit.rotation);
+        uint8_t source = (start + sliceRib) % canvasRibs;
+        memcpy(unitFrame + rib * ribBytes, canvas + source * ribBytes, ribBytes);
+    }
+    return unitFrame;
+}
+
+static void writeLE(byte *out, uint32_t value, uint8_t bytes)
+{
+    for (uint8_t i = 0; i < bytes; i++)
+    {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+uint8_t LuminaireGroup::publish(MQTTManager *mqtt, const byte *canvas, unsigned long renderMicros, uint8_t flags)
+{
+    if (!mqtt || !mqtt->isConnected())
+    {
+        return 0;
+    }
+
+    uint8_t accepted = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (mqtt->publish(units[i].topic, mapFrame(units[i], canvas), FRAME_SIZE, false))
+        {
+            accepted++;
+        }
+    }
+
+#if LUMINAIRE_FRAME_META
+    // 帧信息在帧之后发送：同一连接上 QoS 0 消息按顺序到达，接收端可以把它和前面的帧配对
+    byte meta[FRAME_META_SIZE];
+    // sendMicros 和 units 由 MQTTManager 在帧信息真正发出时填写
+    writeLE(meta, frameSeq, 4);
+    writeLE(meta + FRAME_META_SEND_MICROS_OFFSET, 0, 4);
+    writeLE(meta + 8, renderMicros > 0xFFFF ? 0xFFFF : renderMicros, 2);
+    meta[FRAME_META_UNITS_OFFSET] = 0;
+    meta[11] = flags;
+    mqtt->publish(TOPIC_INFO_LUMINAIRE_FRAME, meta, FRAME_META_SIZE, false);
+#else
+    (void)renderMicros;
+    (void)flags;
+#endif
+
+    frameSeq++;
+    return accepted;
+}
+
+const char *LuminaireGroup::describe(char *buffer, size_t size) const
+{
+    buffer[0] = '\0';
+    for (uint8_t i = 0; i < count; i++)
+    {
+        // 只写出与默认值不同的部分
+        const Unit &unit = units[i];
+        size_t used = strlen(buffer);
+        used += snprintf(buffer + used, size - used, "%s%s", i > 0 ? "," : "", unit.id);
+        if (used < size && unit.start != i * Umbrella::NUM_RIBS)
+        {
+            used += snprintf(buffer + used, size - used, "@%d", unit.start);
+        }
+        if (used < size && unit.rotation != 0)
+        {
+            used += snprintf(buffer + used, size - used, ":%d", unit.rotation);
+        }
+        if (used < size && unit.mirrored)
+        {
+            snprintf(buffer + used, size - used, "m");
+        }
+    }
+    return buffer;
+}
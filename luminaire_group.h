@@ -0,0 +1,92 @@
+#ifndef LUMINAIRE_GROUP_H
+#define LUMINAIRE_GROUP_H
+
+#include <Arduino.h>
+#include "mqtt_manager.h"
+#include "umbrella_geometry.h"
+#include "payload_parser.h"
+
+#define LUMINAIRE_MAX_UNITS UMBRELLA_CANVAS_UNITS            // 最多同时驱动的伞灯数量（= 画布能容纳的伞数）
+#define LUMINAIRE_TOPIC_PREFIX "student/CASA0014/luminaire/" // 伞灯帧主题前缀（后接灯具 ID）
+#define LUMINAIRE_ID_SIZE 12                              // 灯具 ID 最大长度（含结尾 0）
+
+#ifndef LUMINAIRE_FRAME_META
+#define LUMINAIRE_FRAME_META 1 // 每帧发送后附带一条帧信息（序号 / 时间戳），设为 0 关闭
+#endif
+
+// 帧信息标志
+#define FRAME_META_REPLAY 0x01 // 回放帧
+
+// 帧信息（TOPIC_INFO_LUMINAIRE_FRAME，12 字节，小端，紧跟在同一帧的所有伞灯帧之后发送）
+//   seq (uint32)          帧序号，每次 publish() 加 1（用于统计丢帧）
+//   sendMicros (uint32)   帧信息真正发出时的 micros()（MQTTManager::sendNow() 填写，不含排队时间）
+//   renderMicros (uint16) 从本次 loop() 开始到入队的耗时（us，饱和到 65535）
+//   units (uint8)         上一条帧信息之后实际发出的伞灯帧数（同样在发出时填写；排队时过期 / 被覆盖的帧不算）
+//   flags (uint8)         FRAME_META_*
+// tools/luminaire_emulator.cpp 用它统计延迟、抖动和丢帧
+#define FRAME_META_SIZE 12
+
+// 伞灯组：一台 Aura Light 同时驱动多把伞灯
+// 控制器只渲染一张共享画布（UmbrellaCanvas，宽度 = 伞灯数 × 12 条伞骨，最大 4 × 216 = 864 字节）：
+// 频谱铺满整张画布，风速光点在伞之间移动；天气动画只算一把伞，再平铺到画布的每一段。
+// 输出级也只对画布算一遍。每把伞从画布上取自己的切片（12 条伞骨）：
+//   start:    切片起点（画布伞骨编号），默认第 n 把伞从 n × 12 开始，即画布的第 n 段
+//   rotation: 旋转（单位：伞骨），灯具的伞骨 r 显示切片的伞骨 r + rotation
+//   mirrored: 镜像（伞骨顺序反向），用于安装方向相反的灯具
+// 切片越过画布末尾时从画布开头接上。同一帧的所有发送在一次 publish() 里连续完成。
+class LuminaireGroup
+{
+public:
+    static const uint16_t FRAME_SIZE = Umbrella::FRAME_SIZE;
+
+private:
+    struct Unit
+    {
+        char id[LUMINAIRE_ID_SIZE];
+        char topic[sizeof(LUMINAIRE_TOPIC_PREFIX) + LUMINAIRE_ID_SIZE];
+        uint8_t start;    // 切片起点（画布伞骨）
+        uint8_t rotation; // 切片内旋转（伞骨）
+        bool mirrored;
+    };
+
+    Unit units[LUMINAIRE_MAX_UNITS];
+    uint8_t count;
+
+    byte unitFrame[FRAME_SIZE]; // 重排后的帧（所有灯具共用）
+
+    uint32_t frameSeq; // 下一帧的序号
+
+    // 从画布取出某把伞的帧；切片连续且不需要重排时直接返回画布内的指针
+    const byte *mapFrame(const Unit &unit, const byte *canvas);
+
+public:
+    LuminaireGroup();
+
+    // 只保留一把伞（画布 = 这把伞，不旋转、不镜像）
+    void reset(const PayloadSpan &id);
+
+    // start < 0 时使用默认切片（画布的下一段）
+    bool addUnit(const PayloadSpan &id, int start = -1, uint8_t rotation = 0, bool mirrored = false);
+
+    // 处理配置字符串："<id>[@<start>][:<rotation>][m],..."，例如 "16,17:3,18@30m"
+    // 格式错误时保留原配置并返回 false
+    bool configure(const PayloadSpan &payload);
+
+    // 把画布上每把伞的切片交给 MQTTManager，返回入队（或直接发送）的数量
+    // 入队的帧之后仍可能被丢弃，真正发出的帧由 MQTTManager 计入 MET_FRAMES_SENT
+    // renderMicros / flags 写入帧信息（LUMINAIRE_FRAME_META）
+    uint8_t publish(MQTTManager *mqtt, const byte *canvas, unsigned long renderMicros = 0, uint8_t flags = 0);
+
+    uint8_t getCount() const { return count; }
+    const char *getId(uint8_t unit) const { return units[unit].id; }
+    uint32_t getFrameSeq() const { return frameSeq; }
+
+    // 当前画布大小：渲染器按这个宽度绘制
+    uint8_t getCanvasRibs() const { return count * Umbrella::NUM_RIBS; }
+    uint16_t getCanvasLeds() const { return count * Umbrella::NUM_LEDS; }
+
+    // 当前配置（与 configure() 格式相同），写入 buffer 并返回 buffer
+    const char *describe(char *buffer, size_t size) const;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "metrics.h"
+#include "log2_histogram.h"
+
+static uint32_t counters[MET_COUNTER_COUNT];
+static int32_t gauges[MET_GAUGE_COUNT];
+static Log2Histogram timings[MET_TIMING_COUNT];
+static unsigned long lastLoopMicros = 0;
+static uint32_t memoryLow = 0xFFFFFFFF;
+
+#ifdef __arm__
+extern "C" char *sbrk(int incr);
+#endif
+
+uint32_t Metrics::freeMemory()
+{
+#ifdef __arm__
+    char top;
+    return &top - sbrk(0);
+#else
+    return 0;
+#endif
+}
+
+void Metrics::count(MetricCounter counter, uint16_t n)
+{
+    counters[counter] += n;
+}
+
+void Metrics::set(MetricGauge gauge, int32_t value)
+{
+    gauges[gauge] = value;
+}
+
+void Metrics::time(MetricTiming timing, unsigned long us)
+{
+    timings[timing].record(us);
+}
+
+void Metrics::loopTick()
+{
+    unsigned long now = micros();
+    if (lastLoopMicros != 0)
+    {
+        time(MET_LOOP, now - lastLoopMicros);
+    }
+    lastLoopMicros = now;
+
+    uint32_t memory = freeMemory();
+    if (memory < memoryLow)
+    {
+        memoryLow = memory;
+    }
+}
+
+int Metrics::toJson(char *buffer, size_t size, unsigned long windowMs)
+{
+    const Log2Histogram &loop = timings[MET_LOOP];
+    const Log2Histogram &fft = timings[MET_FFT];
+
+    // 键名尽量短：整份文档要放进一条 MQTT 消息（< METRICS_JSON_SIZE）
+    return snprintf(buffer, size,
+                    "{\"up\":%lu,\"win\":%lu,"
+                    "\"loop\":[%lu,%lu,%lu,%lu],\"fft\":[%lu,%lu,%lu,%lu],"
+                    "\"frames\":{\"local\":%lu,\"luminaire\":%lu,\"sent\":%lu},"
+                    "\"pub\":{\"ok\":%lu,\"fail\":%lu,\"drop\":%ld},"
+                    "\"reconnects\":%ld,\"heap\":%lu,\"heap_min\":%lu,\"rssi\":%ld}",
+                    millis() / 1000, windowMs,
+                    (unsigned long)loop.count, (unsigned long)loop.percentile(50),
+                    (unsigned long)loop.percentile(99), (unsigned long)loop.maxMicros,
+                    (unsigned long)fft.count, (unsigned long)fft.percentile(50),
+                    (unsigned long)fft.percentile(99), (unsigned long)fft.maxMicros,
+                    (unsigned long)counters[MET_FRAMES_LOCAL], (unsigned long)counters[MET_FRAMES_LUMINAIRE],
+                    (unsigned long)counters[MET_FRAMES_SENT],
+                    (unsigned long)counters[MET_PUBLISHED], (unsigned long)counters[MET_PUBLISH_FAILED],
+                    (long)gauges[MET_QUEUE_DROPPED],
+                    (long)gauges[MET_RECONNECTS], (unsigned long)freeMemory(), (unsigned long)memoryLow,
+                    (long)gauges[MET_RSSI]);
+}
+
+void Metrics::resetWindow()
+{
+    memset(counters, 0, sizeof(counters));
+    memset(timings, 0, sizeof(timings));
+}
@@ -0,0 +1,62 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+// 运行指标（无人值守时的健康数据）
+// 全部预分配：计数器 / 采样值 / 耗时直方图（与 Profiler 共用 log2_histogram.h）。
+// 每个发布周期生成一份 JSON，保留发布到 <base>/info/metrics，然后清零窗口统计。
+// 与 Profiler 不同，这里始终编译，只统计 loop 周期和 FFT 两项耗时。
+#define METRICS_DEFAULT_INTERVAL_S 30
+#define METRICS_MIN_INTERVAL_S 5
+#define METRICS_MAX_INTERVAL_S 86400
+#define METRICS_IDLE_INTERVAL_S 300 // 没有 Dashboard 在看时的最短间隔（见 presence.h）
+#define METRICS_JSON_SIZE 320
+
+// 窗口计数（每次发布后清零）
+enum MetricCounter
+{
+    MET_FRAMES_LOCAL,        // 本地灯带刷新次数
+    MET_FRAMES_LUMINAIRE,    // 伞灯渲染帧数
+    MET_FRAMES_SENT,         // 伞灯帧实际发出（每把伞灯一条，排队后被丢弃的不算）
+    MET_PUBLISHED,           // MQTT 发送成功
+    MET_PUBLISH_FAILED,      // MQTT 发送失败
+    MET_COUNTER_COUNT
+};
+
+// 采样值（发布前由 Aura_Light.ino 设置）
+enum MetricGauge
+{
+    MET_RSSI,          // dBm
+    MET_RECONNECTS,    // 启动以来重连次数
+    MET_QUEUE_DROPPED, // 发送队列累计丢弃（过期 + 溢出 + 重试失败）
+    MET_GAUGE_COUNT
+};
+
+enum MetricTiming
+{
+    MET_LOOP, // 两次 loop() 之间的时间
+    MET_FFT,  // 一次音频分析（FFT + 频段 + 音量）
+    MET_TIMING_COUNT
+};
+
+namespace Metrics
+{
+    void count(MetricCounter counter, uint16_t n = 1);
+    void set(MetricGauge gauge, int32_t value);
+    void time(MetricTiming timing, unsigned long micros);
+
+    // 每次 loop() 开始时调用：记录 loop 周期，采样空闲内存
+    void loopTick();
+
+    // 当前空闲内存（堆顶到栈顶之间，字节）
+    uint32_t freeMemory();
+
+    // 生成 JSON（windowMs = 本窗口时长），返回写入长度
+    int toJson(char *buffer, size_t size, unsigned long windowMs);
+
+    // 清零窗口统计（内存低水位和采样值保留）
+    void resetWindow();
+}
+
+#endif
@@ -0,0 +1,481 @@
+#include "mqtt5_publisher.h"
+#include "arduino_secrets.h"
+#include <utility/server_drv.h>
+#include <utility/wl_definitions.h>
+
+// MQTT 5 属性标识符（只用到这几个，其余按类型跳过）
+#define PROP_TOPIC_ALIAS_MAXIMUM 0x22
+#define PROP_TOPIC_ALIAS 0x23
+
+// 跳过 size 字节；超出 end 时返回 false，pos 不变
+static bool skipBytes(uint32_t &pos, uint32_t end, uint32_t size)
+{
+    if (size > end - pos)
+    {
+        return false;
+    }
+    pos += size;
+    return true;
+}
+
+// 跳过一个字符串 / 二进制数据（2 字节长度 + 内容）；长度字段或内容超出 end 时返回 false
+static bool skipString(const uint8_t *buffer, uint32_t &pos, uint32_t end)
+{
+    if (end - pos < 2)
+    {
+        return false;
+    }
+    uint16_t size = (buffer[pos] << 8) | buffer[pos + 1];
+    return skipBytes(pos, end, 2 + (uint32_t)size);
+}
+
+MQTT5Publisher::MQTT5Publisher()
+    : backoff(1000, 60000)
+{
+    state = IDLE;
+    stateSince = 0;
+    retryDelay = 0;
+    lastSend = 0;
+    tcpSocket = NO_SOCKET_AVAIL;
+    clientID[0] = '\0';
+    connackReceived = 0;
+    keepAlive = 60;
+    aliasCount = 0;
+    aliasMax = 0;
+    published = 0;
+    bytesSent = 0;
+    bytesSaved = 0;
+}
+
+void MQTT5Publisher::begin(const char *id, uint16_t keepAliveSeconds)
+{
+    // 与主连接的 client ID 不能相同，否则 broker 会踢掉另一个连接
+    snprintf(clientID, sizeof(clientID), "%s_v5", id);
+    keepAlive = keepAliveSeconds;
+    // client ID 含 MAC，用它的哈希作为退避种子
+    uint32_t hash = 2166136261UL;
+    for (const char *c = id; *c; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * 16777619UL;
+    }
+    backoff.seed(hash ^ micros());
+}
+
+void MQTT5Publisher::setState(State newState)
+{
+    state = newState;
+    stateSince = millis();
+}
+
+void MQTT5Publisher::fail(const char *reason)
+{
+    Serial.print("[MQTT5] ✗ ");
+    Serial.println(reason);
+    stop();
+    retryDelay = backoff.next();
+}
+
+void MQTT5Publisher::stop()
+{
+    if (tcpSocket != NO_SOCKET_AVAIL)
+    {
+        ServerDrv::stopClient(tcpSocket);
+        tcpSocket = NO_SOCKET_AVAIL;
+    }
+    client.stop();
+    setState(IDLE);
+}
+
+void MQTT5Publisher::loop(IPAddress broker)
+{
+    unsigned long now = millis();
+
+    switch (state)
+    {
+    case IDLE:
+        if (now - stateSince < retryDelay)
+        {
+            return;
+        }
+        tcpSocket = ServerDrv::getSocket();
+        if (tcpSocket == NO_SOCKET_AVAIL)
+        {
+            fail("No socket available");
+            return;
+        }
+        ServerDrv::startClient(uint32_t(broker), MQTT_PORT, tcpSocket);
+        setState(TCP);
+        break;
+
+    case TCP:
+        if (ServerDrv::getClientState(tcpSocket) == ESTABLISHED)
+        {
+            client = WiFiClient(tcpSocket);
+            tcpSocket = NO_SOCKET_AVAIL;
+            if (!sendConnect())
+            {
+                fail("CONNECT write failed");
+                return;
+            }
+            setState(CONNACK);
+        }
+        else if (now - stateSince > MQTT5_TCP_TIMEOUT_MS)
+        {
+            fail("TCP connect timeout");
+        }
+        break;
+
+    case CONNACK:
+        switch (readConnack())
+        {
+        case 0:
+            if (now - stateSince > MQTT5_CONNACK_TIMEOUT_MS)
+            {
+                fail("CONNACK timeout");
+            }
+            return;
+        case -1:
+            fail("Connection refused");
+            return;
+        }
+
+        aliasCount = 0;
+        backoff.reset();
+        setState(READY);
+        Serial.print("[MQTT5] ✓ Connected, topic aliases: ");
+        Serial.println(aliasMax);
+        break;
+
+    case READY:
+        if (!client.connected())
+        {
+            fail("Connection lost");
+            return;
+        }
+        drain();
+        if (state == READY && now - lastSend > keepAlive * 500UL)
+        {
+            static const uint8_t PINGREQ[] = {0xC0, 0x00};
+            client.write(PINGREQ, sizeof(PINGREQ));
+            lastSend = now;
+        }
+        break;
+    }
+}
+
+uint8_t MQTT5Publisher::writeLength(uint8_t *out, uint32_t length)
+{
+    uint8_t used = 0;
+    do
+    {
+        uint8_t digit = length % 128;
+        length /= 128;
+        if (length > 0)
+        {
+            digit |= 0x80;
+        }
+        out[used++] = digit;
+    } while (length > 0);
+    return used;
+}
+
+uint8_t MQTT5Publisher::writeString(uint8_t *out, const char *text, uint16_t length)
+{
+    out[0] = length >> 8;
+    out[1] = length & 0xFF;
+    memcpy(out + 2, text, length);
+    return 2 + length;
+}
+
+bool MQTT5Publisher::sendConnect()
+{
+    uint16_t idLength = strlen(clientID);
+    uint16_t userLength = strlen(MQTT_USERNAME);
+    uint16_t passLength = strlen(MQTT_PASSWORD);
+
+    // 可变头：协议名 (6) + 版本 (1) + 标志 (1) + keepalive (2) + 属性长度 (1，无属性)
+    uint32_t remaining = 11 + 2 + idLength;
+    uint8_t flags = 0x02; // clean start
+    if (userLength > 0)
+    {
+        flags |= 0x80;
+        remaining += 2 + userLength;
+    }
+    if (passLength > 0)
+    {
+        flags |= 0x40;
+        remaining += 2 + passLength;
+    }
+    if (remaining + 5 > sizeof(buffer))
+    {
+        return false;
+    }
+
+    uint16_t used = 0;
+    buffer[used++] = 0x10; // CONNECT
+    used += writeLength(buffer + used, remaining);
+    used += writeString(buffer + used, "MQTT", 4);
+    buffer[used++] = 5; // 协议版本 MQTT 5
+    buffer[used++] = flags;
+    buffer[used++] = keepAlive >> 8;
+    buffer[used++] = keepAlive & 0xFF;
+    buffer[used++] = 0; // 属性长度
+    used += writeString(buffer + used, clientID, idLength);
+    if (userLength > 0)
+    {
+        used += writeString(buffer + used, MQTT_USERNAME, userLength);
+    }
+    if (passLength > 0)
+    {
+        used += writeString(buffer + used, MQTT_PASSWORD, passLength);
+    }
+
+    lastSend = millis();
+    connackReceived = 0;
+    return client.write(buffer, used) == used;
+}
+
+int8_t MQTT5Publisher::readConnack()
+{
+    // CONNACK = 0x20 + 剩余长度 + 确认标志 + 原因码 + 属性；属性一般不超过几十字节
+    // WiFiClient 不能退回已读的字节，报文又可能分几个 TCP 段到达：
+    // 每次把已到达的字节接在 buffer 后面（超出 buffer 的部分只计数），收齐整个报文再解析
+    uint8_t headerLength = 0;
+    uint32_t remaining = 0;
+    bool complete = false;
+    while (!complete && client.available() > 0)
+    {
+        int c = client.read();
+        if (connackReceived == 0 && c != 0x20)
+        {
+            return -1;
+        }
+        if (connackReceived < sizeof(buffer))
+        {
+            buffer[connackReceived] = c;
+        }
+        connackReceived++;
+
+        // 剩余长度最多 4 字节，最后一个字节的最高位为 0
+        headerLength = 0;
+        remaining = 0;
+        uint32_t multiplier = 1;
+        for (uint8_t i = 1; i < connackReceived && headerLength == 0; i++)
+        {
+            if (i > 4)
+            {
+                return -1;
+            }
+            remaining += (buffer[i] & 0x7F) * multiplier;
+            multiplier *= 128;
+            if (!(buffer[i] & 0x80))
+            {
+                headerLength = i + 1;
+            }
+        }
+        complete = headerLength > 0 && connackReceived >= headerLength + remaining;
+    }
+    if (!complete)
+    {
+        return 0;
+    }
+
+    // 报文体从 buffer + headerLength 开始，超出 buffer 的部分已丢弃
+    const uint8_t *body = buffer + headerLength;
+    uint32_t length = remaining < sizeof(buffer) - headerLength ? remaining : sizeof(buffer) - headerLength;
+    if (length < 2 || body[1] != 0x00)
+    {
+        Serial.print("[MQTT5] CONNACK reason code 0x");
+        Serial.println(length >= 2 ? body[1] : 0, HEX);
+        return -1;
+    }
+
+    // 属性：长度（变长整数）+ 若干 (标识符, 值)
+    aliasMax = 0;
+    uint32_t pos = 2;
+    uint32_t propsLength = 0;
+    uint32_t multiplier = 1;
+    while (pos < length)
+    {
+        uint8_t b = body[pos++];
+        propsLength += (b & 0x7F) * multiplier;
+        multiplier *= 128;
+        if (!(b & 0x80))
+        {
+            break;
+        }
+    }
+
+    // 报文比 buffer 长时只解析读进来的部分，最后一个属性被截断不算错误
+    bool truncated = pos + propsLength > length;
+    uint32_t end = truncated ? length : pos + propsLength;
+    while (pos < end)
+    {
+        uint8_t id = body[pos++];
+        bool ok;
+        switch (id)
+        {
+        case PROP_TOPIC_ALIAS_MAXIMUM:
+            ok = end - pos >= 2;
+            if (ok)
+            {
+                uint16_t max = (body[pos] << 8) | body[pos + 1];
+                aliasMax = max < MQTT5_TOPIC_ALIASES ? max : MQTT5_TOPIC_ALIASES;
+                pos += 2;
+            }
+            break;
+        case 0x01: case 0x17: case 0x19: case 0x24: case 0x25: case 0x28: case 0x29: case 0x2A:
+            ok = skipBytes(pos, end, 1); // 单字节
+            break;
+        case 0x13: case 0x21:
+            ok = skipBytes(pos, end, 2); // 双字节整数
+            break;
+        case 0x02: case 0x11: case 0x27:
+            ok = skipBytes(pos, end, 4); // 四字节整数
+            break;
+        case 0x0B:
+            // 变长整数：最多 4 字节，最后一个字节的最高位为 0
+            ok = false;
+            for (uint8_t i = 0; i < 4 && pos < end && !ok; i++)
+            {
+                ok = !(body[pos++] & 0x80);
+            }
+            break;
+        case 0x26:
+            // 用户属性：字符串对
+            ok = skipString(body, pos, end) && skipString(body, pos, end);
+            break;
+        case 0x03: case 0x08: case 0x09: case 0x12: case 0x15: case 0x16: case 0x1A: case 0x1C: case 0x1F:
+            ok = skipString(body, pos, end); // 字符串 / 二进制数据
+            break;
+        default:
+            // 未知属性无法确定长度，后面的属性都读不了
+            ok = false;
+            break;
+        }
+
+        if (!ok)
+        {
+            if (truncated)
+            {
+                break;
+            }
+            Serial.print("[MQTT5] ✗ Malformed CONNACK property 0x");
+            Serial.println(id, HEX);
+            return -1;
+        }
+    }
+    return 1;
+}
+
+void MQTT5Publisher::drain()
+{
+    // 这个连接不订阅，broker 只会发来 PINGRESP 或 DISCONNECT
+    while (client.available() > 0)
+    {
+        int c = client.read();
+        if (c == 0xE0)
+        {
+            fail("Disconnected by broker");
+            return;
+        }
+    }
+}
+
+uint16_t MQTT5Publisher::aliasFor(const char *topic, bool &isNew)
+{
+    isNew = false;
+    for (uint8_t i = 0; i < aliasCount; i++)
+    {
+        if (strcmp(aliases[i].topic, topic) == 0)
+        {
+            return i + 1;
+        }
+    }
+
+    // 别名表满了就不用别名（不替换，避免和 broker 端的映射不同步）
+    if (aliasCount >= aliasMax || strlen(topic) >= PUBLISH_TOPIC_SIZE)
+    {
+        return 0;
+    }
+    strcpy(aliases[aliasCount].topic, topic);
+    isNew = true;
+    return ++aliasCount;
+}
+
+bool MQTT5Publisher::publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained)
+{
+    if (state != READY)
+    {
+        return false;
+    }
+
+    bool isNew;
+    uint16_t alias = aliasFor(topic, isNew);
+    uint16_t topicLength = strlen(topic);
+    uint16_t sentTopicLength = (alias == 0 || isNew) ? topicLength : 0;
+
+    // 可变头：主题 (2 + n) + 属性长度 (1) + 别名属性 (3)；QoS 0 没有报文 ID
+    uint8_t propsLength = alias ? 3 : 0;
+    uint32_t remaining = 2 + sentTopicLength + 1 + propsLength + length;
+
+    uint16_t used = 0;
+    buffer[used++] = 0x30 | (retained ? 0x01 : 0x00); // PUBLISH, QoS 0
+    used += writeLength(buffer + used, remaining);
+    if ((size_t)used + 2 + sentTopicLength + 1 + propsLength > sizeof(buffer))
+    {
+        return false;
+    }
+    used += writeString(buffer + used, topic, sentTopicLength);
+    buffer[used++] = propsLength;
+    if (alias)
+    {
+        buffer[used++] = PROP_TOPIC_ALIAS;
+        buffer[used++] = alias >> 8;
+        buffer[used++] = alias & 0xFF;
+    }
+
+    // 放得下就和报文头一起写（一个 TCP 段），否则分两次写
+    size_t written;
+    size_t expected = used + length;
+    if (used + length <= sizeof(buffer))
+    {
+        memcpy(buffer + used, payload, length);
+        written = client.write(buffer, used + length);
+    }
+    else
+    {
+        written = client.write(buffer, used);
+        written += client.write(payload, length);
+    }
+    if (written != expected)
+    {
+        fail("Publish write failed");
+        return false;
+    }
+
+    lastSend = millis();
+    published++;
+    bytesSent += expected;
+    // 3.1.1 报文：主题总是完整发送，没有属性长度字节
+    bytesSaved += (int32_t)(topicLength - sentTopicLength) - 1 - propsLength;
+    return true;
+}
+
+void MQTT5Publisher::printStatus(Print &out) const
+{
+    static const char *NAMES[] = {"idle", "tcp", "connack", "ready"};
+    out.print("[MQTT5] State: ");
+    out.print(NAMES[state]);
+    out.print(", aliases ");
+    out.print(aliasCount);
+    out.print("/");
+    out.print(aliasMax);
+    out.print(", published ");
+    out.print(published);
+    out.print(", sent ");
+    out.print(bytesSent);
+    out.print(" bytes, saved ");
+    out.print(bytesSaved);
+    out.println(" bytes vs MQTT 3.1.1");
+}
@@ -0,0 +1,88 @@
+#ifndef MQTT5_PUBLISHER_H
+#define MQTT5_PUBLISHER_H
+
+#include <Arduino.h>
+#include <WiFiNINA.h>
+#include "publish_queue.h"
+#include "reconnect_backoff.h"
+
+// 只发送的 MQTT 5 连接（伞灯帧 / 遥测等高频主题）
+// PubSubClient 只支持 MQTT 3.1.1，每条 PUBLISH 都带完整主题（"student/CASA0014/luminaire/16" 等）。
+// 这里单独开一个 MQTT 5 连接，使用 broker 在 CONNACK 里给出的 Topic Alias Maximum：
+// 每个主题第一次发送时带主题 + 别名，之后只带 2 字节别名、主题为空。
+// 订阅、控制消息和 LWT 仍然走 PubSubClient 的主连接。
+#define MQTT5_TOPIC_ALIASES 6   // 本地别名表大小（实际数量取 broker 上限和这个值的较小者）
+#define MQTT5_BUFFER_SIZE 320   // 报文缓冲区，帧 (216 字节) + 报文头一次写入
+#define MQTT5_TCP_TIMEOUT_MS 5000
+#define MQTT5_CONNACK_TIMEOUT_MS 3000
+
+class MQTT5Publisher
+{
+private:
+    enum State
+    {
+        IDLE,
+        TCP,     // 非阻塞 TCP 连接
+        CONNACK, // 已发送 CONNECT，等待 CONNACK
+        READY
+    };
+
+    struct Alias
+    {
+        char topic[PUBLISH_TOPIC_SIZE];
+    };
+
+    WiFiClient client;
+    State state;
+    unsigned long stateSince;
+    unsigned long retryDelay;
+    unsigned long lastSend; // 用于 keepalive（PINGREQ）
+    uint8_t tcpSocket;
+    ReconnectBackoff backoff;
+
+    char clientID[40];
+    uint16_t keepAlive;
+
+    Alias aliases[MQTT5_TOPIC_ALIASES];
+    uint8_t aliasCount;
+    uint8_t aliasMax; // 本次连接可用的别名数
+
+    uint8_t buffer[MQTT5_BUFFER_SIZE];
+    uint32_t connackReceived; // 已读进 buffer 的 CONNACK 字节数（报文可能分几个 TCP 段到达）
+
+    // 统计：发送字节数，和同样的消息走 3.1.1 时要多发的主题字节数
+    uint32_t published;
+    uint32_t bytesSent;
+    int32_t bytesSaved; // 每个主题第一次发送时多出 4 字节，可能为负
+
+    void setState(State newState);
+    void fail(const char *reason);
+    bool sendConnect();
+    int8_t readConnack(); // 还没收齐返回 0（已读的字节留在 buffer 里），成功返回 1，失败返回 -1
+    void drain();         // 读掉 PINGRESP，收到 DISCONNECT 时断开
+
+    // 查找 / 分配别名；返回 0 表示不用别名
+    uint16_t aliasFor(const char *topic, bool &isNew);
+
+    static uint8_t writeLength(uint8_t *out, uint32_t length);
+    static uint8_t writeString(uint8_t *out, const char *text, uint16_t length);
+
+public:
+    MQTT5Publisher();
+
+    void begin(const char *id, uint16_t keepAliveSeconds);
+
+    // 推进连接状态机 / keepalive；broker 地址由主连接解析
+    void loop(IPAddress broker);
+
+    void stop();
+
+    bool isReady() const { return state == READY; }
+
+    // QoS 0 发送
+    bool publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained);
+
+    void printStatus(Print &out) const;
+};
+
+#endif
@@ -1,11 +1,32 @@
 #include "mqtt_manager.h"
+#include "metrics.h"
+#include <utility/server_drv.h>
+#include <utility/wl_definitions.h>
+
+MQTTManager *MQTTManager::instance = nullptr;
 
 MQTTManager::MQTTManager()
+    : backoff(MQTT_RECONNECT_BASE_MS, MQTT_RECONNECT_CAP_MS)
 {
     wifiClient = new WiFiClient();
     mqttClient = new PubSubClient(*wifiClient);
-    lastReconnectAttempt = 0;
     messageCallback = nullptr;
+    connectCallback = nullptr;
+
+    state = MQTT_STATE_IDLE;
+    stateSince = 0;
+    retryDelay = 0;
+    brokerResolved = false;
+    tcpSocket = NO_SOCKET_AVAIL;
+    subscribeCount = 0;
+    subscribeSent = false;
+
+    outageStart = 0;
+    outageAttempts = 0;
+    lastResubscribeMs = 0;
+    lastAttempts = 0;
+    connectCount = 0;
+    framesSinceInfo = 0;
 }
 
 MQTTManager::~MQTTManager()
@@ -40,6 +61,15 @@ void MQTTManager::begin()
 
     clientID = generateClientID();
 
+    // 每台设备的退避序列不同：MAC 后四字节 + 启动时刻
+    byte mac[6];
+    WiFi.macAddress(mac);
+    backoff.seed(((uint32_t)mac[0] | ((uint32_t)mac[1] << 8) | ((uint32_t)mac[2] << 16) | ((uint32_t)mac[3] << 24)) ^ micros());
+
+    instance = this;
+    dispatcher.begin(TOPIC_BASE);
+    mqttClient->setCallback(onMessage);
+
     Serial.println("\n========================================");
     Serial.println("[MQTT] Initializing MQTT Manager");
     Serial.println("========================================");
@@ -55,187 +85,446 @@ void MQTTManager::begin()
 
     mqttClient->setServer(MQTT_SERVER, MQTT_PORT);
     mqttClient->setKeepAlive(MQTT_KEEPALIVE);
+    mqttClient->setSocketTimeout(MQTT_CONNACK_TIMEOUT);
 
     mqttClient->setBufferSize(512);
+
+#if MQTT5_FRAME_TRANSPORT
+    framePublisher.begin(clientID.c_str(), MQTT_KEEPALIVE);
+    Serial.println("[MQTT] Frames and telemetry use a separate MQTT 5 connection");
+#endif
 }
 
 bool MQTTManager::connect()
 {
-    Serial.print("[MQTT] Connecting to broker...");
+    Serial.println("[MQTT] Connecting to broker...");
+
+    retryDelay = 0;
+    outageStart = millis();
+    outageAttempts = 0;
+    setState(MQTT_STATE_IDLE);
+    do
+    {
+        step();
+    } while (state != MQTT_STATE_IDLE && state != MQTT_STATE_CONNECTED);
+
+    return state == MQTT_STATE_CONNECTED;
+}
+
+void MQTTManager::setState(MQTTConnectionState newState)
+{
+    state = newState;
+    stateSince = millis();
+}
 
-    bool connected = mqttClient->connect(
-        clientID.c_str(),
-        MQTT_USERNAME,
-        MQTT_PASSWORD,
-        TOPIC_STATUS,
-        0,
-        true,
-        "offline");
+void MQTTManager::fail(const char *reason)
+{
+    Serial.print("[MQTT] ✗ ");
+    Serial.println(reason);
 
-    if (connected)
+    if (tcpSocket != NO_SOCKET_AVAIL)
     {
-        Serial.println(" ✓ Connected");
+        ServerDrv::stopClient(tcpSocket);
+        tcpSocket = NO_SOCKET_AVAIL;
+    }
+    retryDelay = backoff.next();
+    Serial.print("[MQTT] Retrying in ");
+    Serial.print(retryDelay);
+    Serial.println(" ms");
+    setState(MQTT_STATE_IDLE);
+}
 
-        publishStatus("online");
+void MQTTManager::lost()
+{
+    // 断线期间积压的帧和状态已经过时，重连后会重新发布
+    queue.clear();
+    framesSinceInfo = 0;
+    Serial.print("[MQTT] ✗ Connection lost, rc=");
+    Serial.println(mqttClient->state());
+
+#if MQTT5_FRAME_TRANSPORT
+    framePublisher.stop();
+#endif
+    outageStart = millis();
+    outageAttempts = 0;
+    retryDelay = backoff.next();
+    setState(MQTT_STATE_IDLE);
+}
 
-        Serial.println("[MQTT] Subscribing to topics...");
+void MQTTManager::step()
+{
+    unsigned long now = millis();
+
+    switch (state)
+    {
+    case MQTT_STATE_IDLE:
+        // WiFi 断开时不尝试（WiFi 重连由 Aura_Light.ino 处理）
+        if (now - stateSince < retryDelay || WiFi.status() != WL_CONNECTED)
+        {
+            return;
+        }
+        outageAttempts++;
+        Serial.print("[MQTT] Attempting to connect (#");
+        Serial.print(outageAttempts);
+        Serial.println(")...");
+        setState(brokerResolved ? MQTT_STATE_TCP : MQTT_STATE_RESOLVING);
+        break;
+
+    case MQTT_STATE_RESOLVING:
+        if (WiFi.hostByName(MQTT_SERVER, brokerIP) != 1)
+        {
+            fail("DNS lookup failed");
+            return;
+        }
+        brokerResolved = true;
+        setState(MQTT_STATE_TCP);
+        break;
 
-        // 订阅控制主题（不包括 /info/ 主题，避免接收自己发布的消息）
-        String baseTopic = String(TOPIC_BASE);
+    case MQTT_STATE_TCP:
+        // WiFiClient::connect() 会阻塞等待最多 10 秒，这里直接启动 socket 再逐次轮询状态
+        if (tcpSocket == NO_SOCKET_AVAIL)
+        {
+            tcpSocket = ServerDrv::getSocket();
+            if (tcpSocket == NO_SOCKET_AVAIL)
+            {
+                fail("No socket available");
+                return;
+            }
+            ServerDrv::startClient(uint32_t(brokerIP), MQTT_PORT, tcpSocket);
+            return;
+        }
 
-        // 订阅状态和模式
-        subscribe((baseTopic + "/status").c_str());
-        subscribe((baseTopic + "/mode").c_str());
-        subscribe((baseTopic + "/controller").c_str());
+        if (ServerDrv::getClientState(tcpSocket) == ESTABLISHED)
+        {
+            // 交给 WiFiClient；PubSubClient::connect() 发现 TCP 已连接就直接发送 CONNECT
+            *wifiClient = WiFiClient(tcpSocket);
+            tcpSocket = NO_SOCKET_AVAIL;
+            setState(MQTT_STATE_CONNECTING);
+        }
+        else if (now - stateSince > MQTT_TCP_TIMEOUT_MS)
+        {
+            brokerResolved = false; // broker 地址可能变了，下次重新解析
+            fail("TCP connect timeout");
+        }
+        break;
 
-        // 订阅调试主题
-        subscribe((baseTopic + "/debug/#").c_str());
+    case MQTT_STATE_CONNECTING:
+        if (!mqttClient->connect(clientID.c_str(), MQTT_USERNAME, MQTT_PASSWORD, TOPIC_STATUS, 0, true, "offline"))
+        {
+            printConnectError();
+            fail("MQTT connect failed");
+            return;
+        }
+        Serial.println("[MQTT] ✓ Connected, subscribing to topics...");
+        subscribeSent = false;
+        setState(MQTT_STATE_SUBSCRIBING);
+        break;
 
-        // 订阅 IDLE 模式颜色主题
-        subscribe((baseTopic + "/idle/color").c_str());
+    case MQTT_STATE_SUBSCRIBING:
+        if (!subscribeSent)
+        {
+            if (!sendSubscribe())
+            {
+                mqttClient->disconnect();
+                fail("SUBSCRIBE write failed");
+                return;
+            }
+            subscribeSent = true;
+            return;
+        }
 
-        // 订阅音频控制主题（不包括 /info/audio/）
-        subscribe((baseTopic + "/audio/volume_range").c_str());
+        switch (readSuback())
+        {
+        case 0:
+            if (now - stateSince > MQTT_SUBACK_TIMEOUT_MS)
+            {
+                mqttClient->disconnect();
+                fail("SUBACK timeout");
+            }
+            return;
+        case -1:
+            mqttClient->disconnect();
+            fail("Bad SUBACK");
+            return;
+        }
 
-        // 订阅天气信息主题（用于Luminaire天气可视化）
-        subscribe((baseTopic + "/info/weather").c_str());
+        lastResubscribeMs = now - outageStart;
+        lastAttempts = outageAttempts;
+        connectCount++;
+        backoff.reset();
+        setState(MQTT_STATE_ANNOUNCING);
+        break;
 
-        // 订阅刷新请求
-        subscribe((baseTopic + "/refresh").c_str());
+    case MQTT_STATE_ANNOUNCING:
+        // 等待 SUBACK 期间注册的路由不在报文里，单独补订
+        for (uint8_t i = subscribeCount; i < dispatcher.getRouteCount(); i++)
+        {
+            char topic[PUBLISH_TOPIC_SIZE];
+            if (dispatcher.routeTopic(i, topic, sizeof(topic)))
+            {
+                subscribe(topic);
+            }
+        }
 
-        Serial.print("[MQTT] ✓ Subscribed to: ");
-        Serial.println(baseTopic + "/{status,mode,controller,debug/#,idle/color,audio/volume_range,info/weather,refresh}");
+        publishStatus("online");
+        publishReconnectMetric();
+        setState(MQTT_STATE_CONNECTED);
 
         Serial.println("[MQTT] ========================================");
         Serial.println("[MQTT] MQTT connection established successfully");
         Serial.println("[MQTT] ========================================\n");
-    }
-    else
-    {
-        Serial.print(" ✗ Failed, rc=");
-        Serial.println(mqttClient->state());
 
-        switch (mqttClient->state())
+        if (connectCallback)
         {
-        case -4:
-            Serial.println("[MQTT] Error: Connection timeout");
-            break;
-        case -3:
-            Serial.println("[MQTT] Error: Connection lost");
-            break;
-        case -2:
-            Serial.println("[MQTT] Error: Connect failed");
-            break;
-        case -1:
-            Serial.println("[MQTT] Error: Disconnected");
-            break;
-        case 1:
-            Serial.println("[MQTT] Error: Bad protocol");
-            break;
-        case 2:
-            Serial.println("[MQTT] Error: Bad client ID");
-            break;
-        case 3:
-            Serial.println("[MQTT] Error: Server unavailable");
-            break;
-        case 4:
-            Serial.println("[MQTT] Error: Bad credentials");
-            break;
-        case 5:
-            Serial.println("[MQTT] Error: Not authorized");
-            break;
-        default:
-            Serial.println("[MQTT] Error: Unknown error");
-            break;
+            connectCallback();
         }
-    }
+        break;
 
-    return connected;
+    case MQTT_STATE_CONNECTED:
+        break;
+    }
 }
 
-bool MQTTManager::reconnect()
+void MQTTManager::printConnectError()
 {
-    unsigned long now = millis();
+    Serial.print("[MQTT] rc=");
+    Serial.println(mqttClient->state());
 
-    if (now - lastReconnectAttempt < RECONNECT_INTERVAL)
+    switch (mqttClient->state())
     {
-        return false;
+    case -4:
+        Serial.println("[MQTT] Error: Connection timeout");
+        break;
+    case -3:
+        Serial.println("[MQTT] Error: Connection lost");
+        break;
+    case -2:
+        Serial.println("[MQTT] Error: Connect failed");
+        break;
+    case -1:
+        Serial.println("[MQTT] Error: Disconnected");
+        break;
+    case 1:
+        Serial.println("[MQTT] Error: Bad protocol");
+        break;
+    case 2:
+        Serial.println("[MQTT] Error: Bad client ID");
+        break;
+    case 3:
+        Serial.println("[MQTT] Error: Server unavailable");
+        break;
+    case 4:
+        Serial.println("[MQTT] Error: Bad credentials");
+        break;
+    case 5:
+        Serial.println("[MQTT] Error: Not authorized");
+        break;
+    default:
+        Serial.println("[MQTT] Error: Unknown error");
+        break;
     }
+}
 
-    lastReconnectAttempt = now;
-
-    Serial.println("[MQTT] Attempting to reconnect...");
-    return connect();
+const char *MQTTManager::stateName(MQTTConnectionState state)
+{
+    static const char *NAMES[] = {"idle", "resolving", "tcp", "connecting", "subscribing", "announcing", "connected"};
+    return NAMES[state];
 }
 
 void MQTTManager::loop()
 {
-    if (!mqttClient->connected())
+    if (state >= MQTT_STATE_SUBSCRIBING && !mqttClient->connected())
     {
-        reconnect();
+        lost();
     }
+
+    if (state != MQTT_STATE_CONNECTED)
+    {
+        step();
+    }
+#if MQTT5_FRAME_TRANSPORT
     else
     {
+        framePublisher.loop(brokerIP);
+    }
+#endif
+
+    // 等待 SUBACK 时由 readSuback() 直接读 socket，PubSubClient 不能先把它读走
+    if (state >= MQTT_STATE_ANNOUNCING)
+    {
+        // 先处理收到的控制消息，再发送
         mqttClient->loop();
+        flushQueue(MQTT_PUBLISH_BUDGET_US);
+    }
+}
+
+PublishClass MQTTManager::classify(const char *topic)
+{
+    static const char LUMINAIRE_PREFIX[] = "student/CASA0014/luminaire/";
+    static const char TELEMETRY_PREFIXES[][24] = {"/info/audio/", "/info/profile"};
+
+    if (strncmp(topic, LUMINAIRE_PREFIX, sizeof(LUMINAIRE_PREFIX) - 1) == 0 ||
+        strcmp(topic, TOPIC_INFO_LUMINAIRE_FRAME) == 0)
+    {
+        return PUB_FRAME;
+    }
+    if (strcmp(topic, TOPIC_STATUS) == 0 || strcmp(topic, TOPIC_MODE) == 0)
+    {
+        return PUB_CONTROL;
+    }
+
+    const char *rest = topic + strlen(TOPIC_BASE);
+    if (strncmp(topic, TOPIC_BASE, strlen(TOPIC_BASE)) == 0)
+    {
+        for (uint8_t i = 0; i < sizeof(TELEMETRY_PREFIXES) / sizeof(TELEMETRY_PREFIXES[0]); i++)
+        {
+            if (strncmp(rest, TELEMETRY_PREFIXES[i], strlen(TELEMETRY_PREFIXES[i])) == 0)
+            {
+                return PUB_TELEMETRY;
+            }
+        }
+    }
+    return PUB_INFO;
+}
+
+PublishResult MQTTManager::enqueue(const char *topic, const uint8_t *payload, unsigned int length, bool retained)
+{
+    PublishClass cls = classify(topic);
+    if (queue.push(topic, payload, length, retained, cls, millis()))
+    {
+        return PUBLISH_QUEUED;
+    }
+
+    // 超长消息（天气 JSON 等）不进队列，直接发送；队列满时只保证控制 / 状态消息
+    bool oversized = length > PUBLISH_PAYLOAD_SIZE || strlen(topic) >= PUBLISH_TOPIC_SIZE;
+    if (!oversized && (cls == PUB_FRAME || cls == PUB_TELEMETRY))
+    {
+        return PUBLISH_FAILED;
+    }
+    return sendNow(topic, payload, length, retained, cls) ? PUBLISH_SENT : PUBLISH_FAILED;
+}
+
+void MQTTManager::flushQueue(unsigned long budgetMicros)
+{
+    unsigned long start = micros();
+    const PublishQueue::Entry *entry;
+
+    // 至少发送一条，之后超出预算就留到下一次 loop()
+    while ((entry = queue.peek(millis())) != nullptr)
+    {
+        if (!sendNow(entry->topic, entry->payload, entry->length, entry->retained, (PublishClass)entry->cls))
+        {
+            // 多半是连接断了：留在队列里，下一次 loop() 再试
+            queue.fail(entry);
+            break;
+        }
+        queue.pop(entry);
+
+        if (micros() - start > budgetMicros)
+        {
+            break;
+        }
     }
 }
 
 bool MQTTManager::isConnected()
 {
-    return mqttClient->connected();
+    return state == MQTT_STATE_CONNECTED && mqttClient->connected();
 }
 
-bool MQTTManager::publish(const char *topic, const char *payload)
+PublishResult MQTTManager::publish(const char *topic, const char *payload)
 {
     return publish(topic, payload, false);
 }
 
-bool MQTTManager::publish(const char *topic, const char *payload, bool retained)
+PublishResult MQTTManager::publish(const char *topic, const char *payload, bool retained)
 {
     if (!mqttClient->connected())
     {
         Serial.println("[MQTT] ✗ Not connected, cannot publish");
-        return false;
+        return PUBLISH_FAILED;
     }
 
-    bool success = mqttClient->publish(topic, payload, retained);
+    return enqueue(topic, (const uint8_t *)payload, strlen(payload), retained);
+}
 
-    if (success)
-    {
-        Serial.print("[MQTT] ✓ Published to ");
-        Serial.print(topic);
-        Serial.print(": ");
-        Serial.println(payload);
-    }
-    else
+PublishResult MQTTManager::publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained)
+{
+    if (!mqttClient->connected())
     {
-        Serial.print("[MQTT] ✗ Failed to publish to ");
-        Serial.println(topic);
+        Serial.println("[MQTT] ✗ Not connected, cannot publish binary data");
+        return PUBLISH_FAILED;
     }
 
-    return success;
+    return enqueue(topic, payload, length, retained);
 }
 
-bool MQTTManager::publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained)
+bool MQTTManager::sendNow(const char *topic, const uint8_t *payload, unsigned int length, bool retained, PublishClass cls)
 {
-    if (!mqttClient->connected())
+    bool binary = cls == PUB_FRAME || cls == PUB_TELEMETRY; // 二进制 / 高频消息只记录长度
+    bool frameInfo = cls == PUB_FRAME && strcmp(topic, TOPIC_INFO_LUMINAIRE_FRAME) == 0;
+
+    // 帧信息在发出这一刻才填写发送时间和帧数：排队期间前面的帧可能已经过期或被覆盖
+    uint8_t stamped[16];
+    if (frameInfo && length > FRAME_META_UNITS_OFFSET && length <= sizeof(stamped))
     {
-        Serial.println("[MQTT] ✗ Not connected, cannot publish binary data");
-        return false;
+        memcpy(stamped, payload, length);
+        unsigned long now = micros();
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            stamped[FRAME_META_SEND_MICROS_OFFSET + i] = (now >> (8 * i)) & 0xFF;
+        }
+        stamped[FRAME_META_UNITS_OFFSET] = framesSinceInfo;
+        payload = stamped;
     }
 
-    bool success = mqttClient->publish(topic, payload, length, retained);
+    bool success;
+#if MQTT5_FRAME_TRANSPORT
+    if ((cls == PUB_FRAME || cls == PUB_TELEMETRY) && framePublisher.isReady())
+    {
+        success = framePublisher.publish(topic, payload, length, retained);
+    }
+    else
+#endif
+    {
+        success = mqttClient->publish(topic, payload, length, retained);
+    }
+
+    Metrics::count(success ? MET_PUBLISHED : MET_PUBLISH_FAILED);
+    if (success && frameInfo)
+    {
+        framesSinceInfo = 0;
+    }
+    else if (success && cls == PUB_FRAME)
+    {
+        Metrics::count(MET_FRAMES_SENT);
+        if (framesSinceInfo < 0xFF)
+        {
+            framesSinceInfo++;
+        }
+    }
 
     if (success)
     {
         Serial.print("[MQTT] ✓ Published ");
-        Serial.print(length);
-        Serial.print(" bytes to ");
-        Serial.println(topic);
+        if (binary)
+        {
+            Serial.print(length);
+            Serial.print(" bytes to ");
+            Serial.println(topic);
+        }
+        else
+        {
+            Serial.print("to ");
+            Serial.print(topic);
+            Serial.print(": ");
+            Serial.write(payload, length);
+            Serial.println();
+        }
     }
     else
     {
-        Serial.print("[MQTT] ✗ Failed to publish binary data to ");
+        Serial.print("[MQTT] ✗ Failed to publish to ");
         Serial.println(topic);
     }
 
@@ -293,7 +582,182 @@ bool MQTTManager::unsubscribe(const char *topic)
 void MQTTManager::setCallback(void (*callback)(char *, byte *, unsigned int))
 {
     messageCallback = callback;
-    mqttClient->setCallback(callback);
+}
+
+bool MQTTManager::on(const char *path, TopicHandler handler, uint8_t arg, const char *leaf)
+{
+    if (!dispatcher.add(path, handler, arg, leaf))
+    {
+        return false;
+    }
+
+    // 订阅中的连接会按顺序订阅到这条新路由
+    if (state >= MQTT_STATE_ANNOUNCING)
+    {
+        char topic[PUBLISH_TOPIC_SIZE];
+        if (dispatcher.routeTopic(dispatcher.getRouteCount() - 1, topic, sizeof(topic)))
+        {
+            subscribe(topic);
+        }
+    }
+    return true;
+}
+
+bool MQTTManager::sendSubscribe()
+{
+    char topic[PUBLISH_TOPIC_SIZE];
+    subscribeCount = dispatcher.getRouteCount();
+    subscribeFilters = 0;
+
+    // 剩余长度 = 报文 ID (2) + 每个主题 (2 字节长度 + 主题 + 1 字节 QoS)
+    uint32_t remaining = 2;
+    for (uint8_t i = 0; i < subscribeCount; i++)
+    {
+        size_t topicLength = dispatcher.routeTopic(i, topic, sizeof(topic));
+        if (topicLength > 0)
+        {
+            remaining += 2 + topicLength + 1;
+            subscribeFilters++;
+        }
+    }
+
+    // 分块写入同一个 socket：报文在 broker 看来是一个完整的 SUBSCRIBE
+    uint8_t chunk[128];
+    uint8_t used = 0;
+    size_t expected = 0;
+    size_t written = 0;
+
+    chunk[used++] = 0x82; // SUBSCRIBE，固定头 flags 必须为 0010
+    uint32_t length = remaining;
+    do
+    {
+        uint8_t digit = length % 128;
+        length /= 128;
+        if (length > 0)
+        {
+            digit |= 0x80;
+        }
+        chunk[used++] = digit;
+    } while (length > 0);
+    chunk[used++] = SUBSCRIBE_PACKET_ID >> 8;
+    chunk[used++] = SUBSCRIBE_PACKET_ID & 0xFF;
+
+    for (uint8_t i = 0; i < subscribeCount; i++)
+    {
+        size_t topicLength = dispatcher.routeTopic(i, topic, sizeof(topic));
+        if (topicLength == 0)
+        {
+            continue; // 主题过长，routeTopic() 失败
+        }
+        if (used + topicLength + 3 > sizeof(chunk))
+        {
+            expected += used;
+            written += wifiClient->write(chunk, used);
+            used = 0;
+        }
+        chunk[used++] = topicLength >> 8;
+        chunk[used++] = topicLength & 0xFF;
+        memcpy(chunk + used, topic, topicLength);
+        used += topicLength;
+        chunk[used++] = 0; // QoS 0
+    }
+    expected += used;
+    written += wifiClient->write(chunk, used);
+
+    return written == expected;
+}
+
+int8_t MQTTManager::readSuback()
+{
+    // CONNACK 之后、收到 SUBACK 之前 broker 不会发送其他报文（clean session，尚无订阅）
+    // SUBACK = 0x90 + 剩余长度 + 报文 ID (2) + 每个主题 1 字节返回码；路由数 ≤ 125 时剩余长度只占 1 字节
+    int size = 4 + subscribeFilters;
+    if (wifiClient->available() < size)
+    {
+        return 0;
+    }
+
+    uint8_t header[4];
+    for (uint8_t i = 0; i < sizeof(header); i++)
+    {
+        header[i] = wifiClient->read();
+    }
+    if (header[0] != 0x90 || header[1] != 2 + subscribeFilters ||
+        ((header[2] << 8) | header[3]) != SUBSCRIBE_PACKET_ID)
+    {
+        return -1;
+    }
+
+    uint8_t granted = 0;
+    for (uint8_t i = 0; i < subscribeFilters; i++)
+    {
+        if (wifiClient->read() != 0x80) // 0x80 = 订阅被拒绝
+        {
+            granted++;
+        }
+    }
+
+    Serial.print("[MQTT] ✓ Subscribed to ");
+    Serial.print(granted);
+    Serial.print("/");
+    Serial.print(subscribeFilters);
+    Serial.println(" topics (1 SUBSCRIBE)");
+    return 1;
+}
+
+void MQTTManager::publishReconnectMetric()
+{
+    char buffer[80];
+    snprintf(buffer, sizeof(buffer), "{\"resubscribe_ms\":%lu,\"attempts\":%u,\"connects\":%u}",
+             lastResubscribeMs, lastAttempts, connectCount);
+    publishInfo("mqtt/reconnect", buffer, true);
+}
+
+void MQTTManager::printConnectionStatus(Print &out) const
+{
+    out.print("[MQTT] State: ");
+    out.print(stateName(state));
+    out.print(", connects ");
+    out.print(connectCount);
+    out.print(", last resubscribe ");
+    out.print(lastResubscribeMs);
+    out.print(" ms after ");
+    out.print(lastAttempts);
+    out.print(" attempt(s)");
+    if (state == MQTT_STATE_IDLE)
+    {
+        out.print(", retry in ");
+        out.print(retryDelay);
+        out.print(" ms");
+    }
+    out.println();
+#if MQTT5_FRAME_TRANSPORT
+    framePublisher.printStatus(out);
+#endif
+}
+
+void MQTTManager::onMessage(char *topic, byte *payload, unsigned int length)
+{
+    Serial.print("[MQTT] Received [");
+    Serial.print(topic);
+    Serial.print("]: ");
+    Serial.write(payload, length);
+    Serial.println();
+
+    if (instance->dispatcher.dispatch(topic, payload, length))
+    {
+        return;
+    }
+
+    if (instance->messageCallback)
+    {
+        instance->messageCallback(topic, payload, length);
+    }
+    else
+    {
+        Serial.print("[MQTT] No handler for topic: ");
+        Serial.println(topic);
+    }
 }
 
 bool MQTTManager::publishStatus(const char *status)
@@ -308,14 +772,15 @@ bool MQTTManager::publishMode(const char *mode)
 
 bool MQTTManager::publishInfo_WiFi_SSID()
 {
-    String ssid = WiFi.SSID();
-    return publish(TOPIC_INFO_WIFI_SSID, ssid.c_str(), true);
+    return publish(TOPIC_INFO_WIFI_SSID, WiFi.SSID(), true);
 }
 
 bool MQTTManager::publishInfo_WiFi_IP()
 {
-    String ip = WiFi.localIP().toString();
-    return publish(TOPIC_INFO_WIFI_IP, ip.c_str(), true);
+    IPAddress ip = WiFi.localIP();
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    return publish(TOPIC_INFO_WIFI_IP, buffer, true);
 }
 
 bool MQTTManager::publishInfo_WiFi_RSSI()
@@ -372,9 +837,14 @@ bool MQTTManager::publishInfo_Location_City(const char *city)
 
 bool MQTTManager::publishInfo(const char *subTopic, const char *payload, bool retained)
 {
-
-    String fullTopic = String(TOPIC_BASE) + "/info/" + String(subTopic);
-    return publish(fullTopic.c_str(), payload, retained);
+    char fullTopic[PUBLISH_TOPIC_SIZE];
+    if (snprintf(fullTopic, sizeof(fullTopic), "%s/info/%s", TOPIC_BASE, subTopic) >= (int)sizeof(fullTopic))
+    {
+        Serial.print("[MQTT] ✗ Info topic too long: ");
+        Serial.println(subTopic);
+        return false;
+    }
+    return publish(fullTopic, payload, retained);
 }
 
 void MQTTManager::publishAllInfo(int lighterNumber, int lighterPin, const char *version, const char *city)
@@ -382,25 +852,17 @@ void MQTTManager::publishAllInfo(int lighterNumber, int lighterPin, const char *
     Serial.println("[MQTT] Publishing all INFO topics...");
 
     publishInfo_WiFi_SSID();
-    delay(50);
     publishInfo_WiFi_IP();
-    delay(50);
     publishInfo_WiFi_RSSI();
-    delay(50);
     publishInfo_WiFi_MAC();
-    delay(50);
 
     publishInfo_Lighter_Number(lighterNumber);
-    delay(50);
     publishInfo_Lighter_Pin(lighterPin);
-    delay(50);
 
     publishInfo_System_Version(version);
-    delay(50);
     publishInfo_System_Uptime();
-    delay(50);
 
     publishInfo_Location_City(city);
 
-    Serial.println("[MQTT] ✓ All INFO published");
+    Serial.println("[MQTT] ✓ All INFO queued");
 }
@@ -5,10 +5,27 @@
 #include <PubSubClient.h>
 #include <WiFiNINA.h>
 #include "arduino_secrets.h"
+#include "publish_queue.h"
+#include "reconnect_backoff.h"
+#include "topic_dispatcher.h"
+
+#ifndef MQTT5_FRAME_TRANSPORT
+#define MQTT5_FRAME_TRANSPORT 0 // 1 = 伞灯帧和遥测走单独的 MQTT 5 连接（主题别名，需要 broker 支持 MQTT 5）
+#endif
+
+#if MQTT5_FRAME_TRANSPORT
+#include "mqtt5_publisher.h"
+#endif
 
 #define MQTT_CLIENT_ID_PREFIX "AuraLight_" 
 #define MQTT_KEEPALIVE 60                  
 #define MQTT_CLEAN_SESSION true
+#define MQTT_PUBLISH_BUDGET_US 4000 // 每次 loop() 发送队列消息的时间预算
+#define MQTT_TCP_TIMEOUT_MS 5000    // TCP 连接超时（非阻塞轮询）
+#define MQTT_CONNACK_TIMEOUT 2      // 等待 CONNACK 的上限（秒，PubSubClient socket timeout）
+#define MQTT_SUBACK_TIMEOUT_MS 3000 // 等待 SUBACK 的上限
+#define MQTT_RECONNECT_BASE_MS 1000 // 重连退避的最短间隔
+#define MQTT_RECONNECT_CAP_MS 60000 // 重连退避的最长间隔
 
 #define TOPIC_BASE "student/CASA0014/" MQTT_USER
 
@@ -28,6 +45,32 @@
 #define TOPIC_INFO_SYSTEM_VERSION TOPIC_BASE "/info/system/version"
 #define TOPIC_INFO_SYSTEM_UPTIME TOPIC_BASE "/info/system/uptime"
 #define TOPIC_INFO_LOCATION_CITY TOPIC_BASE "/info/location/city"
+#define TOPIC_INFO_LUMINAIRE_FRAME TOPIC_BASE "/info/luminaire/frame"
+
+// 帧信息（布局见 luminaire_group.h）里由 sendNow() 在真正发出时填写的字段
+#define FRAME_META_SEND_MICROS_OFFSET 4 // uint32 小端：交给 socket 时的 micros()
+#define FRAME_META_UNITS_OFFSET 10      // uint8：上一条帧信息之后实际发出的伞灯帧数
+
+// 连接状态机：每次 loop() 只推进一步，每一步都有时间上限，
+// 断线 / broker 不可达期间渲染和按钮照常运行
+enum MQTTConnectionState
+{
+    MQTT_STATE_IDLE,        // 未连接，等待下一次尝试
+    MQTT_STATE_RESOLVING,   // DNS 解析（只在第一次或连接失败后进行）
+    MQTT_STATE_TCP,         // TCP 连接中（轮询 socket 状态，不等待）
+    MQTT_STATE_CONNECTING,  // 发送 CONNECT，等待 CONNACK（最多 MQTT_CONNACK_TIMEOUT 秒）
+    MQTT_STATE_SUBSCRIBING, // 一个 SUBSCRIBE 报文订阅全部主题，等待 SUBACK
+    MQTT_STATE_ANNOUNCING,  // 发布上线状态，通知应用重新发布
+    MQTT_STATE_CONNECTED
+};
+
+// publish() 的结果：入队不等于发出，队列里的消息之后仍可能过期、被同主题覆盖或多次失败后放弃
+enum PublishResult
+{
+    PUBLISH_FAILED = 0, // 未连接 / 发送失败 / 队列放不下被丢弃
+    PUBLISH_QUEUED,     // 已入队，由 loop() 发送
+    PUBLISH_SENT        // 已直接发送
+};
 
 class MQTTManager
 {
@@ -37,15 +80,76 @@ private:
     String clientID;
 
     
-    void (*messageCallback)(char *topic, byte *payload, unsigned int length);
+    void (*messageCallback)(char *topic, byte *payload, unsigned int length); // 未注册主题的回调
 
-    
-    unsigned long lastReconnectAttempt;
-    static const unsigned long RECONNECT_INTERVAL = 5000; 
+    // 订阅主题 → 处理函数
+    TopicDispatcher dispatcher;
+
+    static MQTTManager *instance; // PubSubClient 回调没有上下文参数
+    static void onMessage(char *topic, byte *payload, unsigned int length);
+
+    // 连接状态机
+    MQTTConnectionState state;
+    unsigned long stateSince;    // 进入当前状态的时间
+    unsigned long retryDelay;    // IDLE 状态等待多久后再次尝试
+    ReconnectBackoff backoff;
+    IPAddress brokerIP;
+    bool brokerResolved;
+    uint8_t tcpSocket;           // TCP 连接中的 socket（NO_SOCKET_AVAIL = 未分配）
+    uint8_t subscribeCount;      // SUBSCRIBE 报文覆盖的路由数（之后注册的单独补订）
+    uint8_t subscribeFilters;    // 报文中实际的主题数（= SUBACK 返回码个数）
+    bool subscribeSent;
+    void (*connectCallback)();   // 重新连上后调用（应用重新发布状态）
+
+    // 重连指标：从断线（或第一次 connect()）到 SUBACK 收到为止
+    unsigned long outageStart;
+    uint16_t outageAttempts;        // 本次断线期间的连接尝试次数
+    unsigned long lastResubscribeMs; // 最近一次断线到重新订阅完成的时间
+    uint16_t lastAttempts;
+    uint16_t connectCount;          // 启动以来连接成功的次数
+
+    static const uint16_t SUBSCRIBE_PACKET_ID = 1;
+
+    void setState(MQTTConnectionState newState);
+    void fail(const char *reason);
+    void lost(); // 已建立的连接断开
+    void step(); // 推进一步
+
+    // 把所有已注册主题写进一个 SUBSCRIBE 报文（MQTT 3.1.1，QoS 0）
+    bool sendSubscribe();
+
+    // 读取 SUBACK；还没收齐返回 0，成功返回 1，失败返回 -1
+    int8_t readSuback();
+
+    void publishReconnectMetric();
+
+    void printConnectError();
+
+    // 发送队列：publish() 只入队，loop() 里按优先级 / 限速发出
+    PublishQueue queue;
+    uint8_t framesSinceInfo; // 上一条帧信息之后实际发出的伞灯帧数
+
+#if MQTT5_FRAME_TRANSPORT
+    // 主连接连上后再建立；未就绪时帧照常走 PubSubClient
+    MQTT5Publisher framePublisher;
+#endif
 
     
     String generateClientID();
 
+    // 按主题判断发送类别
+    static PublishClass classify(const char *topic);
+
+    // 入队；队列放不下时控制 / 状态消息直接发送，帧和遥测丢弃
+    PublishResult enqueue(const char *topic, const uint8_t *payload, unsigned int length, bool retained);
+
+    // 立即发送（帧 / 遥测在 MQTT 5 连接就绪时走 framePublisher，其余通过 PubSubClient）
+    // 伞灯帧在这里计入 MET_FRAMES_SENT；帧信息在这里填写发送时间和帧数
+    bool sendNow(const char *topic, const uint8_t *payload, unsigned int length, bool retained, PublishClass cls);
+
+    // 在时间预算内发送队列中的消息
+    void flushQueue(unsigned long budgetMicros);
+
 public:
     
     MQTTManager();
@@ -56,24 +160,21 @@ public:
     
     void begin();
 
-    
+    // 立即尝试连接并等待结果（阻塞，只在 setup() 里使用）；之后由 loop() 自动重连
     bool connect();
 
     
-    bool reconnect();
-
-    
     void loop();
 
     
     bool isConnected();
 
     
-    bool publish(const char *topic, const char *payload);
-    bool publish(const char *topic, const char *payload, bool retained);
+    PublishResult publish(const char *topic, const char *payload);
+    PublishResult publish(const char *topic, const char *payload, bool retained);
 
     
-    bool publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained);
+    PublishResult publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained);
 
     
     bool subscribe(const char *topic);
@@ -84,6 +185,19 @@ public:
     
     void setCallback(void (*callback)(char *, byte *, unsigned int));
 
+    // 每次连接完成（订阅完毕）后调用，用于重连后重新发布 INFO
+    void setConnectCallback(void (*callback)()) { connectCallback = callback; }
+
+    MQTTConnectionState getState() const { return state; }
+    unsigned long getLastResubscribeMillis() const { return lastResubscribeMs; }
+    uint16_t getConnectCount() const { return connectCount; }
+    void printConnectionStatus(Print &out) const;
+    static const char *stateName(MQTTConnectionState state);
+
+    // 注册主题处理函数：主题 = TOPIC_BASE/path[leaf]（path / leaf 须为常量字符串）
+    // 连接（和重连）时自动订阅；已连接时立即订阅
+    bool on(const char *path, TopicHandler handler, uint8_t arg = 0, const char *leaf = nullptr);
+
     
     bool publishStatus(const char *status); 
     bool publishMode(const char *mode);     
@@ -104,6 +218,9 @@ public:
 
     
     void publishAllInfo(int numPixels, int pin, const char *version, const char *city);
+
+    void printQueueStatus(Print &out) const { queue.printStatus(out); }
+    uint32_t getDroppedCount() const { return queue.getDropped(); }
 };
 
 #endif 
@@ -0,0 +1,61 @@
+#include "noise.h"
+#include "color_math.h"
+
+// 0-255 的固定随机置换，作为格点哈希
+static const uint8_t PERM[256] = {
+    181, 98, 161, 0, 121, 219, 44, 9, 11, 51, 252, 19, 116, 13, 179, 67,
+    38, 207, 109, 220, 40, 172, 168, 157, 97, 142, 193, 57, 61, 100, 122, 160,
+    134, 236, 52, 41, 99, 152, 199, 210, 222, 184, 206, 30, 255, 88, 82, 131,
+    239, 216, 31, 177, 223, 173, 139, 126, 227, 110, 94, 103, 46, 182, 148, 77,
+    186, 183, 113, 55, 8, 62, 54, 154, 145, 169, 228, 112, 49, 17, 156, 235,
+    243, 95, 86, 120, 240, 101, 204, 85, 231, 164, 225, 180, 146, 79, 130, 87,
+    158, 115, 108, 170, 251, 136, 65, 165, 194, 147, 245, 34, 58, 129, 178, 80,
+    155, 64, 15, 234, 198, 140, 102, 96, 149, 107, 133, 104, 7, 241, 18, 191,
+    111, 237, 24, 29, 14, 217, 3, 166, 23, 205, 195, 50, 71, 72, 232, 84,
+    106, 230, 10, 68, 226, 203, 233, 141, 12, 27, 37, 242, 119, 150, 56, 124,
+    175, 192, 209, 213, 200, 214, 66, 63, 83, 254, 218, 5, 25, 74, 247, 211,
+    197, 42, 69, 132, 123, 163, 249, 21, 189, 135, 159, 153, 125, 128, 60, 39,
+    185, 238, 75, 36, 190, 47, 212, 151, 32, 253, 93, 90, 73, 244, 174, 202,
+    246, 221, 187, 16, 76, 89, 171, 224, 91, 45, 4, 81, 176, 188, 143, 53,
+    250, 144, 215, 229, 127, 117, 35, 1, 22, 48, 118, 167, 138, 92, 137, 105,
+    201, 78, 43, 208, 2, 59, 6, 70, 196, 20, 26, 248, 114, 28, 33, 162};
+
+static inline uint8_t hash3(uint8_t x, uint8_t y, uint8_t z)
+{
+    return PERM[(uint8_t)(PERM[(uint8_t)(PERM[x] + y)] + z)];
+}
+
+uint8_t Noise::noise8(uint16_t x, uint16_t y, uint16_t z)
+{
+    uint8_t xi = x >> 8, yi = y >> 8, zi = z >> 8;
+    // smoothstep 缓动消除格点处的折痕
+    uint8_t u = ease8InOut(x & 0xFF), v = ease8InOut(y & 0xFF), w = ease8InOut(z & 0xFF);
+    uint8_t x1 = xi + 1, y1 = yi + 1, z1 = zi + 1;
+
+    // 先沿 x 插值，再沿 y，最后沿 z
+    uint8_t a = blend8(hash3(xi, yi, zi), hash3(x1, yi, zi), u);
+    uint8_t b = blend8(hash3(xi, y1, zi), hash3(x1, y1, zi), u);
+    uint8_t c = blend8(hash3(xi, yi, z1), hash3(x1, yi, z1), u);
+    uint8_t d = blend8(hash3(xi, y1, z1), hash3(x1, y1, z1), u);
+
+    return blend8(blend8(a, b, v), blend8(c, d, v), w);
+}
+
+uint8_t Noise::fbm8(uint16_t x, uint16_t y, uint16_t z)
+{
+    uint16_t sum = (uint16_t)noise8(x, y, z) * 2 + noise8(x << 1, y << 1, z << 1);
+    return sum / 3;
+}
+
+void Noise::ledPosition(uint8_t rib, uint8_t position, uint8_t spacing, uint16_t &x, uint16_t &y)
+{
+    // 角度 0-255 一整圈，sin8/cos 取值 ±127
+    uint8_t angle = (uint16_t)rib * 256 / Umbrella::NUM_RIBS;
+    int16_t c = (int16_t)sin8(angle + 64) - 128;
+    int16_t s = (int16_t)sin8(angle) - 128;
+
+    // 半径从 1 开始，避免中心一圈 LED 落在同一点
+    int32_t radius = (int32_t)(position + 1) * spacing; // Q8.8
+    x = (uint16_t)(0x8000 + ((radius * c) >> 7));
+    y = (uint16_t)(0x8000 + ((radius * s) >> 7));
+}
@@ -0,0 +1,24 @@
+#ifndef NOISE_H
+#define NOISE_H
+
+#include <Arduino.h>
+#include "umbrella_geometry.h"
+
+// 定点 3D 值噪声（value noise）
+// 坐标为 Q8.8：高 8 位是格点，低 8 位是格内位置。格点值来自 256 项置换表，
+// 格内用 smoothstep 缓动后三线性插值，全部整数运算，一次采样约 8 次查表 + 7 次 blend8。
+// 用于雾、云等需要"有机"流动感的效果：每个 LED 取样一次，第三维用时间推进。
+namespace Noise
+{
+    // 返回 0-255
+    uint8_t noise8(uint16_t x, uint16_t y, uint16_t z);
+
+    // 两个八度叠加（第二层频率 ×2，权重 1/2），细节更丰富
+    uint8_t fbm8(uint16_t x, uint16_t y, uint16_t z);
+
+    // 伞灯 LED 的俯视笛卡尔坐标（Q8.8，中心在 0x8000）
+    // 相邻位置间距 = spacing / 256 个噪声格（spacing 越大，图案越细碎）
+    void ledPosition(uint8_t rib, uint8_t position, uint8_t spacing, uint16_t &x, uint16_t &y);
+}
+
+#endif
@@ -0,0 +1,123 @@
+#include "output_stage.h"
+
+// 伽马 2.2 查找表：输入 0-255 感知亮度，输出 8.8 定点线性亮度 (0 - 65280)
+static const uint16_t GAMMA_TABLE[256] = {
+    0, 0, 2, 4, 7, 11, 17, 24, 32, 42, 53, 65,
+    78, 94, 110, 128, 148, 169, 191, 216, 241, 269, 298, 328,
+    360, 394, 430, 467, 506, 547, 589, 633, 679, 726, 776, 827,
+    880, 934, 991, 1049, 1109, 1171, 1235, 1300, 1368, 1437, 1508, 1581,
+    1656, 1733, 1812, 1893, 1975, 2060, 2146, 2235, 2325, 2417, 2512, 2608,
+    2706, 2806, 2908, 3013, 3119, 3227, 3337, 3450, 3564, 3680, 3798, 3919,
+    4041, 4166, 4292, 4421, 4552, 4685, 4819, 4956, 5096, 5237, 5380, 5525,
+    5673, 5823, 5974, 6128, 6284, 6442, 6603, 6765, 6930, 7097, 7266, 7437,
+    7610, 7786, 7963, 8143, 8325, 8509, 8696, 8885, 9075, 9268, 9464, 9661,
+    9861, 10063, 10267, 10474, 10682, 10893, 11107, 11322, 11540, 11760, 11982, 12207,
+    12433, 12663, 12894, 13128, 13363, 13602, 13842, 14085, 14330, 14578, 14827, 15080,
+    15334, 15591, 15850, 16111, 16375, 16641, 16909, 17180, 17453, 17729, 18006, 18287,
+    18569, 18854, 19141, 19431, 19723, 20017, 20314, 20613, 20915, 21218, 21525, 21833,
+    22144, 22458, 22774, 23092, 23413, 23736, 24062, 24390, 24720, 25053, 25388, 25726,
+    26066, 26408, 26753, 27101, 27451, 27803, 28158, 28515, 28875, 29237, 29602, 29969,
+    30338, 30710, 31085, 31462, 31841, 32223, 32608, 32995, 33384, 33776, 34170, 34567,
+    34967, 35369, 35773, 36180, 36589, 37001, 37416, 37833, 38252, 38674, 39099, 39526,
+    39956, 40388, 40823, 41260, 41700, 42142, 42587, 43034, 43484, 43937, 44392, 44849,
+    45310, 45772, 46238, 46706, 47176, 47649, 48125, 48603, 49084, 49567, 50053, 50542,
+    51033, 51526, 52023, 52522, 53023, 53527, 54034, 54543, 55055, 55570, 56087, 56607,
+    57129, 57654, 58182, 58712, 59245, 59780, 60318, 60859, 61402, 61948, 62497, 63048,
+    63602, 64159, 64718, 65280,
+};
+
+OutputStage::OutputStage()
+    : residuals(nullptr),
+      numChannels(0),
+      powerBudget(0),
+      channelCurrent(20),
+      lastCurrent(0),
+      limiting(false)
+{
+}
+
+OutputStage::~OutputStage()
+{
+    if (residuals != nullptr)
+    {
+        delete[] residuals;
+        residuals = nullptr;
+    }
+}
+
+void OutputStage::begin(int pixelCount)
+{
+    if (residuals != nullptr)
+    {
+        delete[] residuals;
+    }
+
+    numChannels = pixelCount * 3;
+    residuals = new uint8_t[numChannels];
+    reset();
+}
+
+void OutputStage::reset()
+{
+    if (residuals != nullptr)
+    {
+        memset(residuals, 0, numChannels);
+    }
+}
+
+void OutputStage::setPowerBudget(uint16_t milliamps)
+{
+    powerBudget = milliamps;
+
+    uint16_t idleCurrent = numChannels / 3;
+    if (milliamps > 0 && milliamps <= idleCurrent)
+    {
+        Serial.print("[OutputStage] ✗ Power budget ");
+        Serial.print(milliamps);
+        Serial.print(" mA is not above idle current ");
+        Serial.print(idleCurrent);
+        Serial.println(" mA, output will be black");
+    }
+}
+
+void OutputStage::process(const uint8_t *in, uint8_t *out, int pixelCount)
+{
+    int channels = pixelCount * 3;
+    if (channels > numChannels)
+    {
+        channels = numChannels;
+    }
+
+    uint32_t dutySum = 0; // 所有通道输出值之和（255 = 一个通道满占空比）
+
+    for (int i = 0; i < channels; i++)
+    {
+        // 累加上一帧的残差，整数部分输出，小数部分留给下一帧
+        uint16_t value = GAMMA_TABLE[in[i]] + residuals[i];
+        residuals[i] = value & 0xFF;
+        out[i] = value >> 8;
+
+        dutySum += out[i];
+    }
+
+    // 电流估算（mA）：静态电流 + 占空比电流
+    uint32_t idleCurrent = channels / 3;
+    uint32_t current = idleCurrent + dutySum * channelCurrent / 255;
+
+    limiting = powerBudget > 0 && current > powerBudget;
+    if (limiting)
+    {
+        // 超出预算：整帧等比例缩放（8 位定点比例，向下取整保证不超）
+        // 预算连静态电流都不够时比例为 0（全黑），见 setPowerBudget()
+        uint32_t scale = powerBudget > idleCurrent ? ((uint32_t)(powerBudget - idleCurrent) << 8) / (current - idleCurrent) : 0;
+        dutySum = 0;
+        for (int i = 0; i < channels; i++)
+        {
+            out[i] = (out[i] * scale) >> 8;
+            dutySum += out[i];
+        }
+        current = idleCurrent + dutySum * channelCurrent / 255;
+    }
+
+    lastCurrent = current > 0xFFFF ? 0xFFFF : current;
+}
@@ -0,0 +1,42 @@
+#ifndef OUTPUT_STAGE_H
+#define OUTPUT_STAGE_H
+
+#include <Arduino.h>
+
+// 最终输出级：伽马校正 + 时间抖动
+// 渲染函数写入的是"感知亮度"帧，发送前统一经过这里转换为 LED 的线性占空比。
+// 伽马表输出 8.8 定点值，小数部分保存在每个通道的残差里，下一帧累加回去，
+// 这样低亮度时 1 个量化级以下的亮度也能通过多帧平均表现出来。
+//
+// 同一遍循环里累加输出值估算电流（WS2812：每通道满占空比约 20mA，每像素静态约 1mA），
+// 只有超出预算时才对整帧做一次等比例缩放，未超预算的帧没有额外开销。
+class OutputStage
+{
+private:
+    uint8_t *residuals; // 每个通道的量化残差（8.8 定点的小数部分）
+    int numChannels;    // 通道数 = 像素数 * 3
+
+    uint16_t powerBudget;   // 电流预算（mA），0 = 不限制
+    uint8_t channelCurrent; // 每通道满占空比电流（mA）
+    uint16_t lastCurrent;   // 上一帧估算电流（mA，限制之后）
+    bool limiting;          // 上一帧是否被限流
+
+public:
+    OutputStage();
+    ~OutputStage();
+
+    void begin(int pixelCount);
+    void reset(); // 清空残差（例如关灯后）
+
+    // 预算不高于静态电流（像素数 × 1mA）时无法满足，输出全黑并打印警告（须在 begin() 之后调用）
+    void setPowerBudget(uint16_t milliamps);
+    void setChannelCurrent(uint8_t milliamps) { channelCurrent = milliamps; }
+    uint16_t getPowerBudget() const { return powerBudget; }
+    uint16_t getLastCurrent() const { return lastCurrent; }
+    bool isLimiting() const { return limiting; }
+
+    // 处理一帧 RGB 数据（每像素 3 字节），in 与 out 可以是同一块缓冲区
+    void process(const uint8_t *in, uint8_t *out, int pixelCount);
+};
+
+#endif
@@ -0,0 +1,222 @@
+#include "palette.h"
+
+// ===== 内置调色板（const 数据，存放在 Flash）=====
+
+// 绿 → 黄 → 橙 → 红（音量表）
+static const uint32_t COLORS_VU[PALETTE_SIZE] = {
+    0x00FF00, 0x22FF00, 0x44FF00, 0x66FF00, 0x88FF00, 0xAAFF00, 0xCCFF00, 0xEEFF00,
+    0xFFF100, 0xFFD600, 0xFFBB00, 0xFFA000, 0xFF7A00, 0xFF5200, 0xFF2900, 0xFF0000};
+
+// 青绿 → 绿 → 黄 → 橙 → 红（频谱，底部到顶部）
+static const uint32_t COLORS_SPECTRUM[PALETTE_SIZE] = {
+    0x00FF80, 0x00FF55, 0x00FF2B, 0x00FF00, 0x2BFF00, 0x55FF00, 0x80FF00, 0xAAFF00,
+    0xD5FF00, 0xFFFF00, 0xFFD500, 0xFFAA00, 0xFF8000, 0xFF5500, 0xFF2B00, 0xFF0000};
+
+// 白 → 蓝 → 绿 → 黄 → 红（-10°C 到 40°C）
+static const uint32_t COLORS_THERMAL[PALETTE_SIZE] = {
+    0xFFFFFF, 0xC6C6FF, 0x8E8EFF, 0x5555FF, 0x1C1CFF, 0x002AD4, 0x00807F, 0x00D42A,
+    0x2AFF00, 0x80FF00, 0xD4FF00, 0xFFE300, 0xFFAA00, 0xFF7100, 0xFF3900, 0xFF0000};
+
+// 黑 → 蓝（湿度）
+static const uint32_t COLORS_OCEAN[PALETTE_SIZE] = {
+    0x000000, 0x000011, 0x000022, 0x000033, 0x000044, 0x000055, 0x000066, 0x000077,
+    0x000088, 0x000099, 0x0000AA, 0x0000BB, 0x0000CC, 0x0000DD, 0x0000EE, 0x0000FF};
+
+// 黑 → 棕 RGB(165, 42, 42)（云量）
+static const uint32_t COLORS_EARTH[PALETTE_SIZE] = {
+    0x000000, 0x0B0303, 0x160606, 0x210808, 0x2C0B0B, 0x370E0E, 0x421111, 0x4D1414,
+    0x581616, 0x631919, 0x6E1C1C, 0x791F1F, 0x842222, 0x8F2424, 0x9A2727, 0xA52A2A};
+
+// 黑 → 红 → 橙 → 黄 → 白
+static const uint32_t COLORS_FIRE[PALETTE_SIZE] = {
+    0x000000, 0x310000, 0x610000, 0x920000, 0xC20000, 0xF30000, 0xFF1700, 0xFF3500,
+    0xFF5400, 0xFF7200, 0xFF9100, 0xFFB000, 0xFFD000, 0xFFEF00, 0xFFFF55, 0xFFFFFF};
+
+// 黑 → 深蓝 → 青 → 白
+static const uint32_t COLORS_ICE[PALETTE_SIZE] = {
+    0x000000, 0x00051B, 0x000B35, 0x001050, 0x00156B, 0x001B85, 0x0020A0, 0x004AB2,
+    0x0075C4, 0x009FD6, 0x00CAE8, 0x00F4FA, 0x33FFFF, 0x77FFFF, 0xBBFFFF, 0xFFFFFF};
+
+// 色相环
+static const uint32_t COLORS_RAINBOW[PALETTE_SIZE] = {
+    0xFF0000, 0xFF6000, 0xFFBF00, 0xDFFF00, 0x80FF00, 0x20FF00, 0x00FF40, 0x00FF9F,
+    0x00FFFF, 0x009FFF, 0x0040FF, 0x2000FF, 0x8000FF, 0xDF00FF, 0xFF00BF, 0xFF0060};
+
+struct BuiltinPalette
+{
+    const char *name;
+    const uint32_t *colors;
+};
+
+static const BuiltinPalette BUILTIN_PALETTES[] = {
+    {"vu", COLORS_VU},
+    {"spectrum", COLORS_SPECTRUM},
+    {"thermal", COLORS_THERMAL},
+    {"ocean", COLORS_OCEAN},
+    {"earth", COLORS_EARTH},
+    {"fire", COLORS_FIRE},
+    {"ice", COLORS_ICE},
+    {"rainbow", COLORS_RAINBOW}};
+
+static const uint8_t NUM_BUILTIN_PALETTES = sizeof(BUILTIN_PALETTES) / sizeof(BUILTIN_PALETTES[0]);
+
+// 每个用途的默认调色板（BUILTIN_PALETTES 下标）和 MQTT 主题名
+static const uint8_t DEFAULT_PALETTES[PALETTE_ROLE_COUNT] = {0, 1, 2, 3, 4};
+static const char *const ROLE_NAMES[PALETTE_ROLE_COUNT] = {"vu", "spectrum", "temperature", "humidity", "cloud"};
+
+PaletteManager::PaletteManager()
+{
+    memset(custom, 0, sizeof(custom));
+    reset();
+}
+
+void PaletteManager::reset()
+{
+    for (uint8_t role = 0; role < PALETTE_ROLE_COUNT; role++)
+    {
+        const BuiltinPalette &builtin = BUILTIN_PALETTES[DEFAULT_PALETTES[role]];
+        active[role] = builtin.colors;
+        activeNames[role] = builtin.name;
+    }
+}
+
+const uint32_t *PaletteManager::get(PaletteRole role) const
+{
+    return active[role];
+}
+
+uint32_t PaletteManager::map(PaletteRole role, uint8_t level) const
+{
+    return paletteLookup(active[role], level);
+}
+
+const char *PaletteManager::getName(PaletteRole role) const
+{
+    return activeNames[role];
+}
+
+bool PaletteManager::setBuiltin(PaletteRole role, const char *name)
+{
+    for (uint8_t i = 0; i < NUM_BUILTIN_PALETTES; i++)
+    {
+        if (strcmp(BUILTIN_PALETTES[i].name, name) == 0)
+        {
+            active[role] = BUILTIN_PALETTES[i].colors;
+            activeNames[role] = BUILTIN_PALETTES[i].name;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PaletteManager::parseCustom(PaletteRole role, const PayloadSpan &payload)
+{
+    uint32_t stops[PALETTE_SIZE];
+    uint8_t numStops = 0;
+
+    PayloadTokenizer items(payload);
+    PayloadSpan item;
+    while (items.next(item))
+    {
+        // 每一项必须是 #RRGGBB
+        if (item.length != 7 || item[0] != '#' || numStops >= PALETTE_SIZE)
+        {
+            return false;
+        }
+        if (!item.toHexColor(stops[numStops++]))
+        {
+            return false;
+        }
+    }
+
+    if (numStops < 2)
+    {
+        return false;
+    }
+
+    // 把 numStops 个颜色均匀铺开，重采样为 16 项
+    uint32_t *colors = custom[role];
+    for (uint8_t i = 0; i < PALETTE_SIZE; i++)
+    {
+        uint16_t pos = (uint16_t)i * (numStops - 1) * 256 / (PALETTE_SIZE - 1); // Q8.8
+        uint8_t stop = pos >> 8;
+        if (stop >= numStops - 1)
+        {
+            colors[i] = stops[numStops - 1];
+        }
+        else
+        {
+            colors[i] = rgbBlend8(stops[stop], stops[stop + 1], pos & 0xFF);
+        }
+    }
+
+    active[role] = colors;
+    activeNames[role] = "custom";
+    return true;
+}
+
+bool PaletteManager::handleMessage(PaletteRole role, const PayloadSpan &payload)
+{
+    PayloadSpan msg = payload.trim();
+
+    bool success = false;
+    if (!msg.isEmpty() && msg[0] == '#')
+    {
+        success = parseCustom(role, msg);
+    }
+    else if (msg.equalsIgnoreCase("default"))
+    {
+        success = setBuiltin(role, BUILTIN_PALETTES[DEFAULT_PALETTES[role]].name);
+    }
+    else
+    {
+        for (uint8_t i = 0; i < NUM_BUILTIN_PALETTES; i++)
+        {
+            if (msg.equalsIgnoreCase(BUILTIN_PALETTES[i].name))
+            {
+                success = setBuiltin(role, BUILTIN_PALETTES[i].name);
+                break;
+            }
+        }
+    }
+
+    if (success)
+    {
+        Serial.print("[Palette] ✓ ");
+        Serial.print(roleName(role));
+        Serial.print(" -> ");
+        Serial.println(activeNames[role]);
+    }
+    else
+    {
+        Serial.print("[Palette] ✗ Invalid palette for ");
+        Serial.print(roleName(role));
+        Serial.print(": ");
+        payload.printTo(Serial);
+        Serial.println();
+    }
+    return success;
+}
+
+bool PaletteManager::roleFromName(const PayloadSpan &name, PaletteRole &role)
+{
+    for (uint8_t i = 0; i < PALETTE_ROLE_COUNT; i++)
+    {
+        if (name.equals(ROLE_NAMES[i]))
+        {
+            role = (PaletteRole)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *PaletteManager::roleName(PaletteRole role)
+{
+    return ROLE_NAMES[role];
+}
+
+const uint32_t *PaletteManager::defaultPalette(PaletteRole role)
+{
+    return BUILTIN_PALETTES[DEFAULT_PALETTES[role]].colors;
+}
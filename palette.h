@@ -0,0 +1,68 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <Arduino.h>
+#include "color_math.h"
+#include "payload_parser.h"
+
+// 调色板：16 个 0xRRGGBB 颜色组成的渐变查找表
+// 任意 0-255 的标量（频段电平、温度、湿度……）通过一次查表 + 插值得到颜色
+#define PALETTE_SIZE 16
+
+// 调色板用途（每个用途可以单独切换调色板）
+enum PaletteRole
+{
+    PALETTE_VU,          // 本地灯带音量表
+    PALETTE_SPECTRUM,    // 伞灯频谱（0 = 底部/安静，255 = 顶部/响亮）
+    PALETTE_TEMPERATURE, // 温度（-10°C - 40°C）
+    PALETTE_HUMIDITY,    // 湿度（0 - 100%）
+    PALETTE_CLOUD,       // 云量（0 - 100%）
+    PALETTE_ROLE_COUNT
+};
+
+// 查表：index 0-255，高 4 位选表项，低 4 位在相邻表项之间插值
+static inline uint32_t paletteLookup(const uint32_t *palette, uint8_t index)
+{
+    uint8_t entry = index >> 4;
+    uint8_t amount = (index & 0x0F) << 4;
+    if (entry >= PALETTE_SIZE - 1 || amount == 0)
+    {
+        return palette[entry];
+    }
+    return rgbBlend8(palette[entry], palette[entry + 1], amount);
+}
+
+class PaletteManager
+{
+private:
+    const uint32_t *active[PALETTE_ROLE_COUNT];              // 当前使用的调色板（Flash 或 custom）
+    const char *activeNames[PALETTE_ROLE_COUNT];
+    uint32_t custom[PALETTE_ROLE_COUNT][PALETTE_SIZE];       // 通过 MQTT 上传的自定义调色板
+
+    bool parseCustom(PaletteRole role, const PayloadSpan &payload);
+
+public:
+    PaletteManager();
+
+    // 当前调色板（每帧取一次指针，之后逐像素 paletteLookup）
+    const uint32_t *get(PaletteRole role) const;
+    uint32_t map(PaletteRole role, uint8_t level) const;
+    const char *getName(PaletteRole role) const;
+
+    // 切换到内置调色板（名称见 palette.cpp），失败返回 false
+    bool setBuiltin(PaletteRole role, const char *name);
+
+    // 处理 MQTT 消息：内置名称，或 2-16 个逗号分隔的 #RRGGBB 颜色（均匀分布后重采样为 16 项）
+    bool handleMessage(PaletteRole role, const PayloadSpan &payload);
+
+    // 恢复所有用途的默认调色板
+    void reset();
+
+    static bool roleFromName(const PayloadSpan &name, PaletteRole &role);
+    static const char *roleName(PaletteRole role);
+
+    // 未注入 PaletteManager 时渲染器使用的默认调色板
+    static const uint32_t *defaultPalette(PaletteRole role);
+};
+
+#endif
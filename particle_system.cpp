@@ -0,0 +1,134 @@
+#include "particle_system.h"
+
+ParticleSystem::ParticleSystem()
+    : count(0),
+      lastStep(0),
+      stepStarted(false)
+{
+    memset(emitters, 0, sizeof(emitters));
+    disableEmitters();
+}
+
+void ParticleSystem::clear()
+{
+    count = 0;
+}
+
+void ParticleSystem::disableEmitters()
+{
+    for (uint8_t i = 0; i < MAX_EMITTERS; i++)
+    {
+        emitterEnabled[i] = false;
+        lastSpawn[i] = 0;
+    }
+}
+
+void ParticleSystem::setEmitter(uint8_t id, const ParticleEmitter &emitter)
+{
+    if (id >= MAX_EMITTERS)
+        return;
+
+    emitters[id] = emitter;
+    emitterEnabled[id] = true;
+}
+
+bool ParticleSystem::emit(uint8_t id, uint8_t rib)
+{
+    if (id >= MAX_EMITTERS || count >= MAX_PARTICLES)
+    {
+        return false; // 粒子池已满
+    }
+
+    const ParticleEmitter &e = emitters[id];
+    ribs[count] = Umbrella::wrapRib(rib);
+    positions[count] = e.startPosition;
+    velocities[count] = e.velocity;
+    lives[count] = 255 << 8;
+    emitterIds[count] = id;
+    count++;
+    return true;
+}
+
+void ParticleSystem::removeAt(uint8_t index)
+{
+    // 用最后一个粒子填补空位
+    count--;
+    ribs[index] = ribs[count];
+    positions[index] = positions[count];
+    velocities[index] = velocities[count];
+    lives[index] = lives[count];
+    emitterIds[index] = emitterIds[count];
+}
+
+void ParticleSystem::update(unsigned long now)
+{
+    if (!stepStarted)
+    {
+        stepStarted = true;
+        lastStep = now;
+    }
+
+    unsigned long dt = now - lastStep;
+    if (dt == 0)
+    {
+        return;
+    }
+    lastStep = now;
+
+    if (dt > MAX_STEP_MS)
+    {
+        dt = MAX_STEP_MS;
+    }
+
+    // 共享时间步（Q16 秒），每帧只做一次除法
+    int32_t dtQ = ((int32_t)dt << 16) / 1000;
+
+    uint8_t i = 0;
+    while (i < count)
+    {
+        const ParticleEmitter &e = emitters[emitterIds[i]];
+
+        // 上一帧已越过终点（或已熄灭）的粒子在这里回收，保证落地效果至少显示一帧
+        if (positions[i] >= e.endPosition || positions[i] < 0 || life(i) == 0)
+        {
+            removeAt(i);
+            continue;
+        }
+
+        // 与位置一样四舍五入，否则小加速度在 20ms 步长下被截断为 0
+        velocities[i] += (int16_t)(((int32_t)e.acceleration * dtQ + 0x8000) >> 16);
+        positions[i] += (int16_t)(((int32_t)velocities[i] * dtQ + 0x8000) >> 16);
+
+        if (e.decay > 0)
+        {
+            // 衰减量按 Q8.8 计算并四舍五入：每秒 10 的衰减在 20ms 步长下也能逐帧累积
+            uint16_t drop = (uint16_t)(((uint32_t)e.decay * dtQ + 0x80) >> 8);
+            lives[i] = (drop >= lives[i]) ? 0 : lives[i] - drop;
+        }
+
+        // 摇摆：离开中心后偶尔跳到相邻伞骨
+        if (e.swayChance > 0 && positions[i] > PARTICLE_FIXED(1) && random(0, 256) < e.swayChance)
+        {
+            ribs[i] = Umbrella::wrapRib(ribs[i] + (random(0, 2) ? 1 : -1));
+        }
+
+        i++;
+    }
+
+    // 自动发射
+    for (uint8_t id = 0; id < MAX_EMITTERS; id++)
+    {
+        const ParticleEmitter &e = emitters[id];
+        if (!emitterEnabled[id] || e.spawnInterval == 0)
+            continue;
+
+        if (now - lastSpawn[id] > e.spawnInterval)
+        {
+            for (uint8_t n = 0; n < e.spawnCount; n++)
+            {
+                emit(id, random(0, Umbrella::NUM_RIBS));
+            }
+            lastSpawn[id] = now;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <Arduino.h>
+#include "umbrella_geometry.h"
+
+// 浮点常量 → Q8.8 定点（仅用于编译期常量）
+#define PARTICLE_FIXED(x) ((int16_t)((x) * 256))
+
+// 粒子发射器参数（由天气强度配置）
+// 位置单位为 LED（Q8.8），0 = 中心，Umbrella::EDGE_POSITION = 边缘
+struct ParticleEmitter
+{
+    uint16_t spawnInterval; // 自动发射间隔（ms），0 = 仅手动发射
+    uint8_t spawnCount;     // 每次自动发射的粒子数
+    int16_t startPosition;  // 初始位置（Q8.8）
+    int16_t velocity;       // 初速度（Q8.8 LED/秒，负数表示向中心）
+    int16_t acceleration;   // 加速度（Q8.8 LED/秒²）
+    int16_t landPosition;   // 到达后视为"落地"（渲染用）
+    int16_t endPosition;    // 越过后回收
+    uint8_t swayChance;     // 每步跳到相邻伞骨的概率（x/256）
+    uint16_t decay;         // 每秒亮度衰减（0 = 不衰减，亮度耗尽后回收）
+    uint32_t color;         // 0xRRGGBB
+};
+
+// 结构数组（SoA）粒子池
+// 所有粒子共用一个时间步长，活动粒子始终紧凑存放在 [0, size()) 区间，
+// 回收时用最后一个粒子填补空位，更新循环不需要跳过空槽。
+class ParticleSystem
+{
+public:
+    static const uint8_t MAX_PARTICLES = 32;
+    static const uint8_t MAX_EMITTERS = 4;
+
+private:
+    static const unsigned long MAX_STEP_MS = 100; // 单步最大时间（防止暂停后粒子跳跃）
+
+    uint8_t count;
+
+    // 粒子数据（SoA）
+    uint8_t ribs[MAX_PARTICLES];
+    int16_t positions[MAX_PARTICLES];  // Q8.8
+    int16_t velocities[MAX_PARTICLES]; // Q8.8 LED/秒
+    uint16_t lives[MAX_PARTICLES];     // 亮度 Q8.8（保留小数部分，慢速衰减也能逐帧累积）
+    uint8_t emitterIds[MAX_PARTICLES];
+
+    // 发射器
+    ParticleEmitter emitters[MAX_EMITTERS];
+    bool emitterEnabled[MAX_EMITTERS];
+    unsigned long lastSpawn[MAX_EMITTERS];
+
+    unsigned long lastStep;
+    bool stepStarted;
+
+    void removeAt(uint8_t index);
+
+public:
+    ParticleSystem();
+
+    void clear();           // 回收所有粒子
+    void disableEmitters(); // 停止所有自动发射
+    void setEmitter(uint8_t id, const ParticleEmitter &emitter);
+    bool emit(uint8_t id, uint8_t rib); // 手动发射一个粒子
+
+    // 推进一个共享时间步：回收、积分、摇摆、衰减，然后自动发射
+    void update(unsigned long now);
+
+    uint8_t size() const { return count; }
+    uint8_t rib(uint8_t i) const { return ribs[i]; }
+    int16_t position(uint8_t i) const { return positions[i]; }
+    uint8_t life(uint8_t i) const { return lives[i] >> 8; }
+    uint8_t emitterOf(uint8_t i) const { return emitterIds[i]; }
+    bool landed(uint8_t i) const { return positions[i] >= emitters[emitterIds[i]].landPosition; }
+    const ParticleEmitter &emitter(uint8_t id) const { return emitters[id]; }
+};
+
+#endif
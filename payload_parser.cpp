@@ -0,0 +1,215 @@
+#include "payload_parser.h"
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline char lower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+static inline int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c = lower(c);
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+PayloadSpan PayloadSpan::trim() const
+{
+    uint16_t start = 0;
+    uint16_t end = length;
+    while (start < end && isSpace(data[start]))
+        start++;
+    while (end > start && isSpace(data[end - 1]))
+        end--;
+    return PayloadSpan(data + start, end - start);
+}
+
+PayloadSpan PayloadSpan::sub(uint16_t start, uint16_t count) const
+{
+    if (start >= length)
+    {
+        return PayloadSpan(data + length, 0);
+    }
+    uint16_t available = length - start;
+    return PayloadSpan(data + start, count < available ? count : available);
+}
+
+int PayloadSpan::indexOf(char c, uint16_t from) const
+{
+    for (uint16_t i = from; i < length; i++)
+    {
+        if (data[i] == c)
+            return i;
+    }
+    return -1;
+}
+
+bool PayloadSpan::equals(const char *text) const
+{
+    return strlen(text) == length && memcmp(data, text, length) == 0;
+}
+
+bool PayloadSpan::equalsIgnoreCase(const char *text) const
+{
+    return strlen(text) == length && startsWithIgnoreCase(text);
+}
+
+bool PayloadSpan::startsWithIgnoreCase(const char *prefix) const
+{
+    uint16_t i = 0;
+    for (; prefix[i]; i++)
+    {
+        if (i >= length || lower(data[i]) != lower(prefix[i]))
+            return false;
+    }
+    return true;
+}
+
+bool PayloadSpan::split(char sep, PayloadSpan &head, PayloadSpan &tail) const
+{
+    int pos = indexOf(sep);
+    if (pos < 0)
+    {
+        return false;
+    }
+    head = PayloadSpan(data, pos);
+    tail = PayloadSpan(data + pos + 1, length - pos - 1);
+    return true;
+}
+
+bool PayloadSpan::toInt(long &out) const
+{
+    PayloadSpan s = trim();
+    uint16_t i = 0;
+    bool negative = false;
+    if (i < s.length && (s[i] == '-' || s[i] == '+'))
+    {
+        negative = s[i] == '-';
+        i++;
+    }
+    if (i >= s.length)
+    {
+        return false;
+    }
+
+    long value = 0;
+    for (; i < s.length; i++)
+    {
+        if (s[i] < '0' || s[i] > '9')
+            return false;
+        int digit = s[i] - '0';
+        if (value > (INT32_MAX - digit) / 10)
+            return false; // 超出 32 位范围（有符号溢出是未定义行为）
+        value = value * 10 + digit;
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+bool PayloadSpan::toFloat(float &out) const
+{
+    PayloadSpan s = trim();
+    uint16_t i = 0;
+    bool negative = false;
+    if (i < s.length && (s[i] == '-' || s[i] == '+'))
+    {
+        negative = s[i] == '-';
+        i++;
+    }
+
+    float value = 0;
+    float scale = 0; // 0 = 还没遇到小数点
+    bool digits = false;
+    for (; i < s.length; i++)
+    {
+        char c = s[i];
+        if (c == '.' && scale == 0)
+        {
+            scale = 1;
+        }
+        else if (c >= '0' && c <= '9')
+        {
+            value = value * 10 + (c - '0');
+            if (scale != 0)
+                scale *= 10;
+            digits = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (!digits)
+    {
+        return false;
+    }
+
+    if (scale > 1)
+        value /= scale;
+    out = negative ? -value : value;
+    return true;
+}
+
+bool PayloadSpan::toHexColor(uint32_t &out) const
+{
+    PayloadSpan s = trim();
+    if (s.length == 7 && s[0] == '#')
+    {
+        s = s.sub(1);
+    }
+    if (s.length != 6)
+    {
+        return false;
+    }
+
+    uint32_t value = 0;
+    for (uint16_t i = 0; i < 6; i++)
+    {
+        int d = hexDigit(s[i]);
+        if (d < 0)
+            return false;
+        value = (value << 4) | d;
+    }
+    out = value;
+    return true;
+}
+
+size_t PayloadSpan::copyTo(char *buffer, size_t size) const
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+    size_t count = length < size - 1 ? length : size - 1;
+    memcpy(buffer, data, count);
+    buffer[count] = '\0';
+    return count;
+}
+
+bool PayloadTokenizer::next(PayloadSpan &token)
+{
+    if (finished)
+    {
+        return false;
+    }
+
+    int pos = rest.indexOf(separator);
+    if (pos < 0)
+    {
+        token = rest.trim();
+        finished = true;
+    }
+    else
+    {
+        token = rest.sub(0, pos).trim();
+        rest = rest.sub(pos + 1);
+    }
+    return true;
+}
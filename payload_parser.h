@@ -0,0 +1,71 @@
+#ifndef PAYLOAD_PARSER_H
+#define PAYLOAD_PARSER_H
+
+#include <Arduino.h>
+
+// MQTT 消息解析工具（零拷贝、不分配堆内存）
+// PayloadSpan 只是 (指针, 长度)，直接指向 PubSubClient 缓冲区里的原始字节，
+// 切分 / 比较 / 数值转换都在原地完成，替代 String 的 substring / toInt / toLowerCase。
+// 注意：span 只在处理函数执行期间有效，需要保存的内容要复制出去。
+struct PayloadSpan
+{
+    const char *data;
+    uint16_t length;
+
+    PayloadSpan() : data(""), length(0) {}
+    PayloadSpan(const char *text) : data(text), length(strlen(text)) {}
+    PayloadSpan(const char *text, size_t len) : data(text), length(len) {}
+    PayloadSpan(const byte *payload, unsigned int len) : data((const char *)payload), length(len) {}
+
+    bool isEmpty() const { return length == 0; }
+    char operator[](uint16_t i) const { return data[i]; }
+
+    // 去掉首尾空白
+    PayloadSpan trim() const;
+
+    // 子串：[start, start + count)，越界时截断
+    PayloadSpan sub(uint16_t start, uint16_t count = 0xFFFF) const;
+
+    // 查找字符，找不到返回 -1
+    int indexOf(char c, uint16_t from = 0) const;
+
+    bool equals(const char *text) const;
+    bool equalsIgnoreCase(const char *text) const;
+    bool startsWithIgnoreCase(const char *prefix) const;
+
+    // 在第一个 sep 处拆成两段（"index:value"），没有 sep 返回 false
+    bool split(char sep, PayloadSpan &head, PayloadSpan &tail) const;
+
+    // 十进制整数（可带符号，忽略首尾空白），整段都必须是数字，绝对值超过 INT32_MAX 返回 false
+    bool toInt(long &out) const;
+
+    // 十进制小数（可带符号和小数点，不支持指数）
+    bool toFloat(float &out) const;
+
+    // "#RRGGBB" 或 "RRGGBB" → 0xRRGGBB
+    bool toHexColor(uint32_t &out) const;
+
+    // 复制到 buffer（截断，总是以 0 结尾），返回复制的字符数
+    size_t copyTo(char *buffer, size_t size) const;
+
+    // 输出到串口等
+    void printTo(Print &out) const { out.write((const uint8_t *)data, length); }
+};
+
+// 按分隔符逐段读取（CSV）："a, b,c" → "a"、"b"、"c"（每段已 trim）
+class PayloadTokenizer
+{
+private:
+    PayloadSpan rest;
+    char separator;
+    bool finished;
+
+public:
+    PayloadTokenizer(const PayloadSpan &span, char sep = ',')
+        : rest(span), separator(sep), finished(span.length == 0) {}
+
+    // 读取下一段，没有更多时返回 false
+    bool next(PayloadSpan &token);
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "presence.h"
+
+PresenceTracker::PresenceTracker()
+    : count(0)
+{
+}
+
+void PresenceTracker::remove(uint8_t index)
+{
+    viewers[index] = viewers[--count];
+}
+
+bool PresenceTracker::handleMessage(const PayloadSpan &msg, unsigned long now)
+{
+    PayloadSpan idPart, statePart;
+    if (!msg.trim().split(':', idPart, statePart) || idPart.length == 0)
+    {
+        return false;
+    }
+
+    uint32_t id = 2166136261UL;
+    for (unsigned int i = 0; i < idPart.length; i++)
+    {
+        id = (id ^ (uint8_t)idPart.data[i]) * 16777619UL;
+    }
+
+    uint8_t index = 0;
+    while (index < count && viewers[index].id != id)
+    {
+        index++;
+    }
+
+    if (statePart.equals("0"))
+    {
+        if (index < count)
+        {
+            remove(index);
+        }
+        return true;
+    }
+    if (!statePart.equals("1"))
+    {
+        return false;
+    }
+
+    if (index == count)
+    {
+        if (count < PRESENCE_MAX_VIEWERS)
+        {
+            count++;
+        }
+        else
+        {
+            // 表满：替换最久没有心跳的
+            index = 0;
+            for (uint8_t i = 1; i < count; i++)
+            {
+                if (viewers[i].lastSeen < viewers[index].lastSeen)
+                {
+                    index = i;
+                }
+            }
+        }
+        viewers[index].id = id;
+    }
+    viewers[index].lastSeen = now;
+    return true;
+}
+
+uint8_t PresenceTracker::update(unsigned long now)
+{
+    for (uint8_t i = 0; i < count;)
+    {
+        if (now - viewers[i].lastSeen > PRESENCE_TIMEOUT_MS)
+        {
+            remove(i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+    return count;
+}
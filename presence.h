@@ -0,0 +1,41 @@
+#ifndef PRESENCE_H
+#define PRESENCE_H
+
+#include <Arduino.h>
+#include "payload_parser.h"
+
+#define PRESENCE_MAX_VIEWERS 4     // 同时跟踪的 Dashboard 数（满了替换最久没有心跳的）
+#define PRESENCE_TIMEOUT_MS 75000  // Dashboard 每 30 秒心跳一次，2.5 个周期没收到视为离开
+
+// Dashboard 在线检测（主题 <base>/presence）
+// 每个 Dashboard 连接时发送 "<viewerId>:1"，之后每 30 秒重发一次作为心跳；
+// 关闭页面时发送 "<viewerId>:0"，异常断开时由 broker 发送同样内容的 LWT。
+// 有观看者时才发送高频遥测（音频帧等），没有时降到低频。
+class PresenceTracker
+{
+private:
+    struct Viewer
+    {
+        uint32_t id; // viewerId 的 FNV-1a 哈希，不保存字符串
+        unsigned long lastSeen;
+    };
+
+    Viewer viewers[PRESENCE_MAX_VIEWERS];
+    uint8_t count;
+
+    void remove(uint8_t index);
+
+public:
+    PresenceTracker();
+
+    // 处理一条 presence 消息，格式错误返回 false
+    bool handleMessage(const PayloadSpan &msg, unsigned long now);
+
+    // 清除超时的观看者，返回当前数量
+    uint8_t update(unsigned long now);
+
+    uint8_t getViewerCount() const { return count; }
+    bool hasViewers() const { return count > 0; }
+};
+
+#endif
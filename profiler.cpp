@@ -0,0 +1,67 @@
+#include "profiler.h"
+
+#if PROFILER_ENABLED
+
+#include "log2_histogram.h"
+
+static const char *const SECTION_NAMES[PROF_SECTION_COUNT] = {
+    "music_spectrum",
+    "weather_viz",
+    "weather_anim",
+    "output_stage",
+    "mqtt_publish",
+    "strip_show"};
+
+static Log2Histogram stats[PROF_SECTION_COUNT];
+
+void Profiler::record(uint8_t section, unsigned long us)
+{
+    stats[section].record(us);
+}
+
+void Profiler::reset()
+{
+    memset(stats, 0, sizeof(stats));
+}
+
+void Profiler::print(Print &out)
+{
+    out.println("\n=== Render Profile (us) ===");
+    out.println("  section          count     p50     p99     max");
+    for (uint8_t i = 0; i < PROF_SECTION_COUNT; i++)
+    {
+        const Log2Histogram &s = stats[i];
+        char line[80];
+        snprintf(line, sizeof(line), "  %-14s %7lu %7lu %7lu %7lu",
+                 SECTION_NAMES[i],
+                 (unsigned long)s.count,
+                 (unsigned long)s.percentile(50),
+                 (unsigned long)s.percentile(99),
+                 (unsigned long)s.maxMicros);
+        out.println(line);
+    }
+    out.println("===========================\n");
+}
+
+int Profiler::toJson(char *buffer, size_t size)
+{
+    int len = snprintf(buffer, size, "{");
+    for (uint8_t i = 0; i < PROF_SECTION_COUNT && len < (int)size; i++)
+    {
+        const Log2Histogram &s = stats[i];
+        len += snprintf(buffer + len, size - len, "%s\"%s\":[%lu,%lu,%lu,%lu]",
+                        i > 0 ? "," : "",
+                        SECTION_NAMES[i],
+                        (unsigned long)s.count,
+                        (unsigned long)s.percentile(50),
+                        (unsigned long)s.percentile(99),
+                        (unsigned long)s.maxMicros);
+    }
+    if (len < (int)size)
+    {
+        len += snprintf(buffer + len, size - len, "}");
+    }
+    return len;
+}
+
+#endif
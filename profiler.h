@@ -0,0 +1,60 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+// 渲染路径性能统计
+// 用 PROFILE_SCOPE(section) 包住一段代码，离开作用域时把耗时（micros）
+// 记入该段的 log2 直方图（第 n 个桶 = [2^(n-1), 2^n) 微秒），可以估算 p50 / p99 / max。
+// 编译时定义 PROFILER_ENABLED=0 后宏展开为空，不占任何 RAM 和 CPU。
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+enum ProfileSection
+{
+    PROF_MUSIC_SPECTRUM, // LuminaireController::updateMusicSpectrum
+    PROF_WEATHER_VIZ,    // LuminaireController::updateWeatherVisualization
+    PROF_WEATHER_ANIM,   // WeatherAnimation::update
+    PROF_OUTPUT_STAGE,   // 伞灯输出级（伽马 + 抖动 + 限流）
+    PROF_MQTT_PUBLISH,   // 伞灯整帧 MQTT 发送
+    PROF_STRIP_SHOW,     // 本地灯带 strip->show()
+    PROF_SECTION_COUNT
+};
+
+#if PROFILER_ENABLED
+
+namespace Profiler
+{
+    void record(uint8_t section, unsigned long micros);
+    void reset();
+
+    // 输出到串口（表格）
+    void print(Print &out);
+
+    // 生成 JSON：{"section":[count,p50,p99,max],...}，返回写入长度
+    int toJson(char *buffer, size_t size);
+}
+
+class ProfileScope
+{
+private:
+    uint8_t section;
+    unsigned long start;
+
+public:
+    explicit ProfileScope(uint8_t s) : section(s), start(micros()) {}
+    ~ProfileScope() { Profiler::record(section, micros() - start); }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(section) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(section)
+
+#else
+
+#define PROFILE_SCOPE(section)
+
+#endif
+
+#endif
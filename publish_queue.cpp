@@ -0,0 +1,206 @@
+#include "publish_queue.h"
+
+static const uint32_t TOKEN = 1000; // 一条消息消耗的令牌
+
+PublishQueue::PublishQueue()
+    : nextOrder(0),
+      queued(0),
+      sent(0),
+      coalesced(0),
+      stale(0),
+      overflow(0),
+      failed(0),
+      abandoned(0)
+{
+    for (uint8_t i = 0; i < PUBLISH_QUEUE_SLOTS; i++)
+    {
+        entries[i].used = false;
+    }
+
+    // 默认限速：控制回显不限速；帧每秒 200 条（每把伞灯一条 + 帧信息，一起算）；
+    // info 突发 10 条后每秒 5 条；遥测每秒 30 条（音频帧最高 25 帧/秒 + 性能统计）
+    setRate(PUB_CONTROL, 0, 0);
+    setRate(PUB_FRAME, 200, 10);
+    setRate(PUB_INFO, 5, 10);
+    setRate(PUB_TELEMETRY, 30, 4);
+}
+
+void PublishQueue::setRate(PublishClass cls, uint16_t perSecond, uint16_t burst)
+{
+    Bucket &bucket = buckets[cls];
+    bucket.rate = perSecond;
+    bucket.burst = burst > 0 ? burst : 1;
+    bucket.tokens = (uint32_t)bucket.burst * TOKEN;
+    bucket.lastRefill = millis();
+}
+
+void PublishQueue::refill(Bucket &bucket, unsigned long now)
+{
+    unsigned long elapsed = now - bucket.lastRefill;
+    bucket.lastRefill = now;
+
+    // rate 条/秒 = rate 个令牌/毫秒（× 1000 之后）
+    uint32_t limit = (uint32_t)bucket.burst * TOKEN;
+    uint32_t add = elapsed > 60000 ? limit : (uint32_t)elapsed * bucket.rate;
+    bucket.tokens = (bucket.tokens + add > limit) ? limit : bucket.tokens + add;
+}
+
+bool PublishQueue::push(const char *topic, const uint8_t *payload, uint16_t length, bool retained, PublishClass cls, unsigned long now)
+{
+    if (length > PUBLISH_PAYLOAD_SIZE || strlen(topic) >= PUBLISH_TOPIC_SIZE)
+    {
+        overflow++;
+        return false;
+    }
+
+    // 同主题已在队列中：覆盖内容，保留原来的位置（帧和帧信息的先后顺序不变）
+    Entry *slot = nullptr;
+    for (uint8_t i = 0; i < PUBLISH_QUEUE_SLOTS; i++)
+    {
+        if (entries[i].used && strcmp(entries[i].topic, topic) == 0)
+        {
+            slot = &entries[i];
+            coalesced++;
+            break;
+        }
+    }
+
+    if (!slot)
+    {
+        for (uint8_t i = 0; i < PUBLISH_QUEUE_SLOTS; i++)
+        {
+            if (!entries[i].used)
+            {
+                slot = &entries[i];
+                break;
+            }
+        }
+        if (!slot)
+        {
+            overflow++;
+            return false;
+        }
+
+        strcpy(slot->topic, topic);
+        slot->used = true;
+        slot->order = nextOrder++;
+    }
+
+    // 覆盖后内容是新的：重新计算过期时间和发送次数
+    slot->queuedAt = now;
+    slot->attempts = 0;
+    memcpy(slot->payload, payload, length);
+    slot->length = length;
+    slot->cls = cls;
+    slot->retained = retained;
+    queued++;
+    return true;
+}
+
+const PublishQueue::Entry *PublishQueue::peek(unsigned long now)
+{
+    // 过期帧直接丢弃：宁可跳帧，也不让旧画面占用带宽、拖慢控制消息
+    for (uint8_t i = 0; i < PUBLISH_QUEUE_SLOTS; i++)
+    {
+        Entry &entry = entries[i];
+        if (entry.used && entry.cls == PUB_FRAME && now - entry.queuedAt > PUBLISH_FRAME_MAX_AGE)
+        {
+            entry.used = false;
+            stale++;
+        }
+    }
+
+    for (uint8_t cls = 0; cls < PUB_CLASS_COUNT; cls++)
+    {
+        Bucket &bucket = buckets[cls];
+        if (bucket.rate > 0)
+        {
+            refill(bucket, now);
+            if (bucket.tokens < TOKEN)
+            {
+                continue;
+            }
+        }
+
+        const Entry *oldest = nullptr;
+        for (uint8_t i = 0; i < PUBLISH_QUEUE_SLOTS; i++)
+        {
+            const Entry &entry = entries[i];
+            if (entry.used && entry.cls == cls && (!oldest || (int32_t)(entry.order - oldest->order) < 0))
+            {
+                oldest = &entry;
+            }
+        }
+        if (oldest)
+        {
+            return oldest;
+        }
+    }
+    return nullptr;
+}
+
+void PublishQueue::pop(const Entry *entry)
+{
+    Bucket &bucket = buckets[entry->cls];
+    if (bucket.rate > 0)
+    {
+        bucket.tokens -= TOKEN;
+    }
+
+    entries[entry - entries].used = false;
+    sent++;
+}
+
+void PublishQueue::fail(const Entry *entry)
+{
+    Entry &slot = entries[entry - entries];
+    failed++;
+    if (++slot.attempts >= PUBLISH_MAX_ATTEMPTS)
+    {
+        slot.used = false;
+        abandoned++;
+    }
+}
+
+void PublishQueue::clear()
+{
+    for (uint8_t i = 0; i < PUBLISH_QUEUE_SLOTS; i++)
+    {
+        entries[i].used = false;
+    }
+}
+
+uint8_t PublishQueue::size() const
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < PUBLISH_QUEUE_SLOTS; i++)
+    {
+        if (entries[i].used)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+void PublishQueue::printStatus(Print &out) const
+{
+    out.print("[MQTT] Queue: ");
+    out.print(size());
+    out.print("/");
+    out.print(PUBLISH_QUEUE_SLOTS);
+    out.print(" pending, queued ");
+    out.print(queued);
+    out.print(", sent ");
+    out.print(sent);
+    out.print(", coalesced ");
+    out.print(coalesced);
+    out.print(", stale ");
+    out.print(stale);
+    out.print(", overflow ");
+    out.print(overflow);
+    out.print(", failed ");
+    out.print(failed);
+    out.print(", abandoned ");
+    out.println(abandoned);
+}
@@ -0,0 +1,93 @@
+#ifndef PUBLISH_QUEUE_H
+#define PUBLISH_QUEUE_H
+
+#include <Arduino.h>
+
+#define PUBLISH_QUEUE_SLOTS 10       // 队列槽数（预分配）
+#define PUBLISH_TOPIC_SIZE 64        // 主题最大长度（含结尾 0）
+#define PUBLISH_PAYLOAD_SIZE 320     // 单条消息最大长度；更长的消息直接同步发送
+#define PUBLISH_FRAME_MAX_AGE 100    // 帧在队列里超过这个时间（ms）就丢弃，不再发送
+#define PUBLISH_MAX_ATTEMPTS 3       // 发送失败这么多次后放弃这条消息
+
+// 发送类别（按优先级排列，数值越小越先发送）
+enum PublishClass
+{
+    PUB_CONTROL,   // status / mode 回显，不限速
+    PUB_FRAME,     // 伞灯帧 + 帧信息，过期丢弃
+    PUB_INFO,      // info/* 状态
+    PUB_TELEMETRY, // 音频数据、性能统计等周期数据
+    PUB_CLASS_COUNT
+};
+
+// MQTT 发送队列
+// - 同一主题只保留最新的一条（latest-value-wins），被覆盖的旧消息计入 coalesced
+// - 每个类别一个令牌桶限速（rate 条/秒，最多积累 burst 条）
+// - MQTTManager::loop() 在时间预算内按优先级取出发送
+class PublishQueue
+{
+public:
+    struct Entry
+    {
+        char topic[PUBLISH_TOPIC_SIZE];
+        uint8_t payload[PUBLISH_PAYLOAD_SIZE];
+        uint16_t length;
+        uint8_t cls;
+        bool retained;
+        bool used;
+        uint32_t order;         // 入队顺序（同类别内先进先出）
+        unsigned long queuedAt; // 最近一次写入时间（ms，被覆盖时更新）
+        uint8_t attempts;       // 已失败的发送次数
+    };
+
+private:
+    struct Bucket
+    {
+        uint16_t rate;         // 条 / 秒（0 = 不限速）
+        uint16_t burst;        // 最多积累的条数
+        uint32_t tokens;       // 当前令牌（× 1000）
+        unsigned long lastRefill;
+    };
+
+    Entry entries[PUBLISH_QUEUE_SLOTS];
+    Bucket buckets[PUB_CLASS_COUNT];
+    uint32_t nextOrder;
+
+    // 统计
+    uint32_t queued;
+    uint32_t sent;
+    uint32_t coalesced; // 被同主题新消息覆盖
+    uint32_t stale;     // 帧过期丢弃
+    uint32_t overflow;  // 队列满 / 消息过大
+    uint32_t failed;    // 发送失败次数（消息留在队列里重试）
+    uint32_t abandoned; // 失败 PUBLISH_MAX_ATTEMPTS 次后放弃
+
+    void refill(Bucket &bucket, unsigned long now);
+
+public:
+    PublishQueue();
+
+    // 设置类别限速
+    void setRate(PublishClass cls, uint16_t perSecond, uint16_t burst);
+
+    // 入队；消息过大或队列已满返回 false（调用方决定直接发送还是丢弃）
+    bool push(const char *topic, const uint8_t *payload, uint16_t length, bool retained, PublishClass cls, unsigned long now);
+
+    // 取出下一条允许发送的消息（优先级 + 令牌桶），没有则返回 nullptr；顺便丢弃过期帧
+    const Entry *peek(unsigned long now);
+
+    // 发送完 peek() 返回的消息后调用：扣除令牌并释放槽
+    void pop(const Entry *entry);
+
+    // 发送失败：不扣令牌，消息留在队列里下次重试，失败太多次才丢弃
+    void fail(const Entry *entry);
+
+    // 清空（断线时调用，旧帧和状态不再有意义）
+    void clear();
+
+    uint8_t size() const;
+    void recordOverflow() { overflow++; }
+    uint32_t getDropped() const { return stale + overflow + abandoned; }
+    void printStatus(Print &out) const;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "reconnect_backoff.h"
+
+ReconnectBackoff::ReconnectBackoff(unsigned long baseMs, unsigned long capMs)
+    : baseMs(baseMs),
+      capMs(capMs),
+      previous(baseMs),
+      rng(0x9E3779B9)
+{
+}
+
+void ReconnectBackoff::seed(uint32_t value)
+{
+    // xorshift 的状态不能为 0
+    rng = value ? value : 0x9E3779B9;
+}
+
+void ReconnectBackoff::reset()
+{
+    previous = baseMs;
+}
+
+uint32_t ReconnectBackoff::nextRandom()
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+unsigned long ReconnectBackoff::next()
+{
+    unsigned long upper = previous * 3;
+    if (upper > capMs)
+    {
+        upper = capMs;
+    }
+
+    // [base, upper) 内均匀分布
+    unsigned long delay = baseMs;
+    if (upper > baseMs)
+    {
+        delay += nextRandom() % (upper - baseMs);
+    }
+
+    previous = delay;
+    return delay;
+}
@@ -0,0 +1,34 @@
+#ifndef RECONNECT_BACKOFF_H
+#define RECONNECT_BACKOFF_H
+
+#include <Arduino.h>
+
+// 重连退避（decorrelated jitter）：delay = min(cap, random(base, 上一次 delay × 3))
+// 固定间隔重连时，broker 重启后所有设备在同一时刻一起重连；
+// 每台设备用自己的种子（MAC）生成随机数，重连时间自然错开，连续失败时间隔逐渐变长。
+// 自带 xorshift32 随机数，不影响 Arduino random() 的序列。
+class ReconnectBackoff
+{
+private:
+    unsigned long baseMs;
+    unsigned long capMs;
+    unsigned long previous; // 上一次返回的间隔
+    uint32_t rng;
+
+    uint32_t nextRandom();
+
+public:
+    ReconnectBackoff(unsigned long baseMs, unsigned long capMs);
+
+    void seed(uint32_t value);
+
+    // 连接成功后调用，下一次失败从 base 重新开始
+    void reset();
+
+    // 下一次重连前等待的时间（毫秒）
+    unsigned long next();
+
+    unsigned long getLast() const { return previous; }
+};
+
+#endif
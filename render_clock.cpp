@@ -0,0 +1,29 @@
+#include "render_clock.h"
+
+RenderClock renderClock;
+
+RenderClock::RenderClock()
+    : virtualMode(false),
+      virtualTime(0)
+{
+}
+
+void RenderClock::freeze()
+{
+    if (!virtualMode)
+    {
+        virtualTime = millis();
+        virtualMode = true;
+    }
+}
+
+void RenderClock::advance(unsigned long ms)
+{
+    freeze();
+    virtualTime += ms;
+}
+
+void RenderClock::useRealTime()
+{
+    virtualMode = false;
+}
@@ -0,0 +1,40 @@
+#ifndef RENDER_CLOCK_H
+#define RENDER_CLOCK_H
+
+#include <Arduino.h>
+
+// 渲染时钟
+// 所有动画 / 可视化都从这里取时间，而不是直接调用 millis()。
+// 默认跟随 millis()；切换到虚拟时间后可以逐帧步进，
+// 用于在串口上冻结画面、逐帧检查渲染结果（配合 frame_dump）。
+class RenderClock
+{
+private:
+    bool virtualMode;
+    unsigned long virtualTime;
+
+public:
+    RenderClock();
+
+    unsigned long now() const { return virtualMode ? virtualTime : millis(); }
+
+    // 冻结在当前时间，之后只由 advance() 推进
+    void freeze();
+    void advance(unsigned long ms);
+
+    // 恢复跟随 millis()
+    void useRealTime();
+
+    bool isVirtual() const { return virtualMode; }
+
+    // 周期相位：从 since 开始，每 periodMs 走完一圈（0-255）
+    // 动画速度只取决于经过的时间，与 loop() 调用频率和丢帧无关
+    uint8_t phase8(unsigned long periodMs, unsigned long since = 0) const
+    {
+        return (uint8_t)(((now() - since) % periodMs) * 256 / periodMs);
+    }
+};
+
+extern RenderClock renderClock;
+
+#endif
@@ -0,0 +1,150 @@
+// Aura Light 二进制控制协议编码器（主机端，header-only，C++11）
+// 协议定义见固件 binary_command.h，发送到 <base>/cmd/bin（不保留）。
+//
+// 用法：
+//   uint8_t rgb[72 * 3] = {...};
+//   AuraCommand cmd;
+//   cmd.controller(AuraCommand::CONTROLLER_LUMINAIRE).status(true).debugPixels(0, rgb, 72);
+//   mosquitto_publish(mosq, nullptr, "student/CASA0014/<user>/cmd/bin", cmd.size(), cmd.data(), 0, false);
+//
+// 每条命令最多 255 字节参数；debugPixels() 超过 84 个像素时自动拆成多条命令。
+
+#ifndef AURA_COMMAND_H
+#define AURA_COMMAND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class AuraCommand
+{
+public:
+    enum
+    {
+        VERSION = 1,
+        MAX_PIXELS_PER_COMMAND = (255 - 1) / 3 // 84
+    };
+
+    enum Type : uint8_t
+    {
+        STATUS = 0x01,
+        MODE = 0x02,
+        CONTROLLER = 0x03,
+        IDLE_COLOR = 0x04,
+        VOLUME_RANGE = 0x05,
+        DEBUG_PIXELS = 0x10,
+        DEBUG_FILL = 0x11,
+        DEBUG_BRIGHTNESS = 0x12,
+        DEBUG_CLEAR = 0x13
+    };
+
+    enum Mode : uint8_t
+    {
+        MODE_TIMER = 0,
+        MODE_WEATHER = 1,
+        MODE_IDLE = 2,
+        MODE_MUSIC = 3
+    };
+
+    enum Controller : uint8_t
+    {
+        CONTROLLER_LOCAL = 0,
+        CONTROLLER_LUMINAIRE = 1
+    };
+
+    AuraCommand() { clear(); }
+
+    void clear()
+    {
+        bytes.assign(1, (uint8_t)VERSION);
+    }
+
+    AuraCommand &status(bool on) { return add1(STATUS, on ? 1 : 0); }
+    AuraCommand &mode(Mode m) { return add1(MODE, m); }
+    AuraCommand &controller(Controller c) { return add1(CONTROLLER, c); }
+
+    // color: 0xRRGGBB
+    AuraCommand &idleColor(uint32_t color)
+    {
+        header(IDLE_COLOR, 3);
+        rgb(color);
+        return *this;
+    }
+
+    AuraCommand &volumeRange(uint8_t minDb, uint8_t maxDb)
+    {
+        header(VOLUME_RANGE, 2);
+        bytes.push_back(minDb);
+        bytes.push_back(maxDb);
+        return *this;
+    }
+
+    // rgb: count × 3 字节
+    AuraCommand &debugPixels(uint8_t start, const uint8_t *rgbData, int count)
+    {
+        while (count > 0)
+        {
+            int n = count < MAX_PIXELS_PER_COMMAND ? count : MAX_PIXELS_PER_COMMAND;
+            header(DEBUG_PIXELS, (uint8_t)(1 + n * 3));
+            bytes.push_back(start);
+            bytes.insert(bytes.end(), rgbData, rgbData + n * 3);
+            start = (uint8_t)(start + n);
+            rgbData += n * 3;
+            count -= n;
+        }
+        return *this;
+    }
+
+    AuraCommand &debugFill(uint8_t start, uint8_t count, uint32_t color)
+    {
+        header(DEBUG_FILL, 5);
+        bytes.push_back(start);
+        bytes.push_back(count);
+        rgb(color);
+        return *this;
+    }
+
+    AuraCommand &debugBrightness(uint8_t start, uint8_t count, uint8_t value)
+    {
+        header(DEBUG_BRIGHTNESS, 3);
+        bytes.push_back(start);
+        bytes.push_back(count);
+        bytes.push_back(value);
+        return *this;
+    }
+
+    AuraCommand &debugClear()
+    {
+        header(DEBUG_CLEAR, 0);
+        return *this;
+    }
+
+    const uint8_t *data() const { return bytes.data(); }
+    int size() const { return (int)bytes.size(); }
+    bool isEmpty() const { return bytes.size() <= 1; }
+
+private:
+    std::vector<uint8_t> bytes;
+
+    void header(uint8_t type, uint8_t length)
+    {
+        bytes.push_back(type);
+        bytes.push_back(length);
+    }
+
+    AuraCommand &add1(uint8_t type, uint8_t value)
+    {
+        header(type, 1);
+        bytes.push_back(value);
+        return *this;
+    }
+
+    void rgb(uint32_t color)
+    {
+        bytes.push_back((color >> 16) & 0xFF);
+        bytes.push_back((color >> 8) & 0xFF);
+        bytes.push_back(color & 0xFF);
+    }
+};
+
+#endif
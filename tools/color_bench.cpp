@@ -0,0 +1,197 @@
+// 定点颜色运算的主机基准测试
+// 把渲染路径上原来的浮点写法和 color_math.h 的 scale8 / blend8 / rgbScale8 / rgbBlend8 / sin8 放在一起计时，
+// 每组都对一整帧伞灯（216 字节）运算，并报告两种写法结果的最大差值。
+//
+// 编译和运行：
+//   make -C tools bench
+//
+// 注意：主机 CPU 有硬件浮点，浮点写法在这里几乎不吃亏，数值只能看相对大小。
+// 编译时关闭自动向量化（Cortex-M0+ 没有 SIMD），否则逐字节的循环会被向量化，和设备上的情况差得更远。
+// MKR WiFi 1010 的 Cortex-M0+ 没有 FPU，每次浮点乘法、int / float 转换和 sin() 都是软件模拟的函数调用，
+// 设备上的差距比这里大得多。
+
+#include "color_math.h"
+#include "umbrella_geometry.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+static const int FRAME_SIZE = Umbrella::FRAME_SIZE;
+static const int ITERATIONS = 20000; // 每组运算的帧数
+static const int REPEATS = 7;        // 取中位数
+
+static uint8_t source[FRAME_SIZE];
+static uint8_t target[FRAME_SIZE];
+static uint8_t floatResult[FRAME_SIZE];
+static uint8_t fixedResult[FRAME_SIZE];
+static volatile uint32_t sink; // 防止编译器把整个循环优化掉
+
+// ============ 被比较的写法（浮点版本与改用定点运算之前的渲染代码相同）============
+
+// 亮度缩放：每通道一次浮点乘法
+__attribute__((noinline)) static void scaleFloat(const uint8_t *in, uint8_t *out, float brightness)
+{
+    for (int i = 0; i < FRAME_SIZE; i++)
+    {
+        out[i] = (uint8_t)(in[i] * brightness);
+    }
+}
+
+__attribute__((noinline)) static void scaleFixed(const uint8_t *in, uint8_t *out, uint8_t brightness)
+{
+    for (int i = 0; i < FRAME_SIZE; i++)
+    {
+        out[i] = scale8(in[i], brightness);
+    }
+}
+
+// 同样的缩放，按打包像素一次处理三个通道
+__attribute__((noinline)) static void scalePacked(const uint8_t *in, uint8_t *out, uint8_t brightness)
+{
+    for (int i = 0; i < FRAME_SIZE; i += 3)
+    {
+        rgbWrite(out + i, rgbScale8(rgbRead(in + i), brightness));
+    }
+}
+
+// 两个颜色插值：原 WeatherAnimation::blendColors()
+__attribute__((noinline)) static void blendFloat(const uint8_t *a, const uint8_t *b, uint8_t *out, float ratio)
+{
+    for (int i = 0; i < FRAME_SIZE; i++)
+    {
+        out[i] = a[i] + (b[i] - a[i]) * ratio;
+    }
+}
+
+__attribute__((noinline)) static void blendFixed(const uint8_t *a, const uint8_t *b, uint8_t *out, uint8_t amount)
+{
+    for (int i = 0; i < FRAME_SIZE; i++)
+    {
+        out[i] = blend8(a[i], b[i], amount);
+    }
+}
+
+__attribute__((noinline)) static void blendPacked(const uint8_t *a, const uint8_t *b, uint8_t *out, uint8_t amount)
+{
+    for (int i = 0; i < FRAME_SIZE; i += 3)
+    {
+        rgbWrite(out + i, rgbBlend8(rgbRead(a + i), rgbRead(b + i), amount));
+    }
+}
+
+// 雾的亮度波动：原 updateFogAnimation() 每个位置一次 sin()
+__attribute__((noinline)) static void waveFloat(uint8_t *out, int phaseDegrees)
+{
+    for (int i = 0; i < FRAME_SIZE; i++)
+    {
+        float wave = sin(((phaseDegrees + i * 30) % 360) * PI / 180.0);
+        out[i] = 100 + (int)(20 * wave);
+    }
+}
+
+__attribute__((noinline)) static void waveFixed(uint8_t *out, int phaseDegrees)
+{
+    for (int i = 0; i < FRAME_SIZE; i++)
+    {
+        uint8_t phase = (uint8_t)(((phaseDegrees + i * 30) % 360) * 256 / 360);
+        int wave = (int)sin8(phase) - 128;
+        out[i] = 100 + ((20 * wave) >> 7);
+    }
+}
+
+// ============ 计时 ============
+
+template <typename Body>
+static double timeNsPerFrame(Body body)
+{
+    std::vector<double> runs;
+    for (int r = 0; r < REPEATS; r++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; i++)
+        {
+            body(i);
+        }
+        runs.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ITERATIONS);
+    }
+    std::sort(runs.begin(), runs.end());
+    return runs[REPEATS / 2];
+}
+
+static int maxDifference(const uint8_t *a, const uint8_t *b)
+{
+    int worst = 0;
+    for (int i = 0; i < FRAME_SIZE; i++)
+    {
+        worst = std::max(worst, abs(a[i] - b[i]));
+    }
+    return worst;
+}
+
+static void report(const char *name, double floatNs, double fixedNs, int maxError)
+{
+    printf("[ColorBench] %-14s float %8.1f ns  fixed %8.1f ns  x%.2f  max diff %d\n",
+           name, floatNs, fixedNs, floatNs / fixedNs, maxError);
+}
+
+int main()
+{
+    srand(1);
+    for (int i = 0; i < FRAME_SIZE; i++)
+    {
+        source[i] = rand() & 0xFF;
+        target[i] = rand() & 0xFF;
+    }
+
+    printf("[ColorBench] %d frames of %d bytes per run, median of %d runs (host timings, see header)\n",
+           ITERATIONS, FRAME_SIZE, REPEATS);
+
+    // 亮度与插值比例每帧变化，结果累加进 sink
+    double floatNs = timeNsPerFrame([](int i) { scaleFloat(source, floatResult, (i & 0xFF) / 255.0f); sink += floatResult[i % FRAME_SIZE]; });
+    double fixedNs = timeNsPerFrame([](int i) { scaleFixed(source, fixedResult, i & 0xFF); sink += fixedResult[i % FRAME_SIZE]; });
+    double packedNs = timeNsPerFrame([](int i) { scalePacked(source, fixedResult, i & 0xFF); sink += fixedResult[i % FRAME_SIZE]; });
+    int scaleError = 0, packedError = 0;
+    for (int level = 0; level < 256; level++)
+    {
+        scaleFloat(source, floatResult, level / 255.0f);
+        scaleFixed(source, fixedResult, level);
+        scaleError = std::max(scaleError, maxDifference(floatResult, fixedResult));
+        scalePacked(source, fixedResult, level);
+        packedError = std::max(packedError, maxDifference(floatResult, fixedResult));
+    }
+    report("scale8", floatNs, fixedNs, scaleError);
+    report("rgbScale8", floatNs, packedNs, packedError);
+
+    floatNs = timeNsPerFrame([](int i) { blendFloat(source, target, floatResult, (i & 0xFF) / 255.0f); sink += floatResult[i % FRAME_SIZE]; });
+    fixedNs = timeNsPerFrame([](int i) { blendFixed(source, target, fixedResult, i & 0xFF); sink += fixedResult[i % FRAME_SIZE]; });
+    packedNs = timeNsPerFrame([](int i) { blendPacked(source, target, fixedResult, i & 0xFF); sink += fixedResult[i % FRAME_SIZE]; });
+    int blendError = 0;
+    packedError = 0;
+    for (int amount = 0; amount < 256; amount++)
+    {
+        blendFloat(source, target, floatResult, amount / 255.0f);
+        blendFixed(source, target, fixedResult, amount);
+        blendError = std::max(blendError, maxDifference(floatResult, fixedResult));
+        blendPacked(source, target, fixedResult, amount);
+        packedError = std::max(packedError, maxDifference(floatResult, fixedResult));
+    }
+    report("blend8", floatNs, fixedNs, blendError);
+    report("rgbBlend8", floatNs, packedNs, packedError);
+
+    floatNs = timeNsPerFrame([](int i) { waveFloat(floatResult, i % 360); sink += floatResult[i % FRAME_SIZE]; });
+    fixedNs = timeNsPerFrame([](int i) { waveFixed(fixedResult, i % 360); sink += fixedResult[i % FRAME_SIZE]; });
+    int waveError = 0;
+    for (int phase = 0; phase < 360; phase++)
+    {
+        waveFloat(floatResult, phase);
+        waveFixed(fixedResult, phase);
+        waveError = std::max(waveError, maxDifference(floatResult, fixedResult));
+    }
+    report("sin8", floatNs, fixedNs, waveError);
+
+    return 0;
+}
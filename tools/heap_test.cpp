@@ -0,0 +1,199 @@
+// 消息处理的堆分配测试（不需要硬件和 broker）
+// 把 Aura_Light.ino 和固件源码一起编译到主机上（Arduino 部分见 tools/host），替换全局 operator new 统计分配次数。
+// setup() 完成后，每一轮把下面每个订阅主题的消息各投递一次，再运行几次 loop()，共 ROUNDS 轮；
+// 这期间出现任何堆分配（包括 String）都算失败。长时间运行的设备上反复分配会让堆碎片化。
+//
+// 编译和运行：
+//   make -C tools heap_test
+//
+// WiFi 连接、城市定位和天气获取需要网络，这里用空实现代替（它们只在启动和重连时运行）。
+
+#include "binary_command.h"
+#include "geography.h"
+#include "mqtt_manager.h"
+#include "weather_manager.h"
+#include "wifi_manager.h"
+
+#include <new>
+#include <stdlib.h>
+
+// Aura_Light.ino
+void setup();
+void loop();
+extern MQTTManager mqtt;
+
+static const int ROUNDS = 100;
+static const unsigned long STEP_MS = 20;
+
+// ============ 分配计数 ============
+
+static bool counting = false;
+static unsigned long allocations = 0;
+
+void *operator new(size_t size)
+{
+    if (counting)
+    {
+        allocations++;
+    }
+    void *p = malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+// ============ 需要网络的部分 ============
+
+void setupWiFi() {}
+bool checkWiFiConnection() { return true; }
+void reconnectWiFi() {}
+String getCurrentCity() { return String("London"); }
+
+WeatherManager::WeatherManager() : mqtt(nullptr), lastUpdate(0) {}
+void WeatherManager::begin(MQTTManager *mqttManager, const String &cityName)
+{
+    mqtt = mqttManager;
+    city = cityName;
+}
+void WeatherManager::loop() {}
+void WeatherManager::fetchAndPublishWeather() {}
+bool WeatherManager::hasReceivedWeather() const { return true; }
+
+// ============ 测试消息 ============
+
+struct Message
+{
+    const char *path; // TOPIC_BASE 之后的部分
+    const char *text; // 文本消息（nullptr = 使用 binary）
+    const uint8_t *binary;
+    unsigned int binaryLength;
+};
+
+// 状态 / IDLE 颜色 / 调试像素各一条，再加一条参数长度不对的（应被跳过）
+static const uint8_t BINARY_COMMANDS[] = {
+    BINARY_COMMAND_VERSION,
+    BIN_CMD_STATUS, 1, 1,
+    BIN_CMD_IDLE_COLOR, 3, 0x10, 0x20, 0x30,
+    BIN_CMD_DEBUG_FILL, 5, 0, 6, 255, 0, 0,
+    BIN_CMD_DEBUG_BRIGHTNESS, 2, 0, 0,
+    BIN_CMD_DEBUG_CLEAR, 0};
+
+// 两个控制器都要走到：先在 local 下发送一遍控制命令，切到 luminaire 再发送一遍
+static const Message MESSAGES[] = {
+    {"controller", "local"},
+    {"status", "on"},
+    {"mode", "timer"},
+    {"mode", "weather"},
+    {"mode", "idle"},
+    {"mode", "music"},
+    {"debug/color", "0:#FF0000"},
+    {"debug/brightness", "1:128"},
+    {"debug/index", "clear"},
+    {"controller", "luminaire"},
+    {"status", "on"},
+    {"mode", "timer"},
+    {"mode", "weather"},
+    {"mode", "idle"},
+    {"mode", "music"},
+    {"debug/color", "0:#FF0000"},
+    {"debug/brightness", "1:128"},
+    {"debug/index", "clear"},
+    {"power/budget", "1500"},
+    {"idle/color", "#112233"},
+    {"idle/color", "bad"},
+    {"audio/volume_range", "30,120"},
+    {"audio/rate", "10"},
+    {"presence", "viewer1:1"},
+    {"presence", "viewer1:0"},
+    {"metrics/interval", "10"},
+    {"info/weather",
+     "{\"temp_C\":\"9\",\"FeelsLikeC\":6,\"humidity\":\"93\",\"windspeedKmph\":30,\"winddir16Point\":\"SW\","
+     "\"visibility\":\"6\",\"cloudcover\":100,\"precipMM\":\"2.4\",\"weatherCode\":296,\"weatherDesc\":\"Light rain\"}"},
+    {"refresh", "all"},
+    {"cmd/bin", nullptr, BINARY_COMMANDS, sizeof(BINARY_COMMANDS)},
+    {"palette/spectrum", "fire"},
+    {"palette/vu", "#FF0000,#00FF00,#0000FF"},
+    {"curve", "idle:sine"},
+    {"recorder", "start"},
+    {"recorder", "status"},
+    {"recorder", "replay 2"},
+    {"recorder", "stop"},
+    {"luminaire/units", "16,17:3,18@30m"},
+    {"luminaire/units", "16"},
+    {"mode", "weather"},
+    {"status", "off"},
+};
+static const int MESSAGE_COUNT = sizeof(MESSAGES) / sizeof(MESSAGES[0]);
+
+static void deliver(const Message &message)
+{
+    char topic[PUBLISH_TOPIC_SIZE];
+    snprintf(topic, sizeof(topic), "%s/%s", TOPIC_BASE, message.path);
+    if (message.text)
+    {
+        hostDeliver(topic, (const uint8_t *)message.text, strlen(message.text));
+    }
+    else
+    {
+        hostDeliver(topic, message.binary, message.binaryLength);
+    }
+}
+
+static void runLoop(int steps)
+{
+    for (int i = 0; i < steps; i++)
+    {
+        hostAdvance(STEP_MS);
+        loop();
+    }
+}
+
+int main()
+{
+    setup();
+
+    // 等连接状态机走到 CONNECTED，启动阶段的一次性分配不计入
+    runLoop(100);
+    if (!mqtt.isConnected())
+    {
+        printf("[HeapTest] ✗ MQTT state machine did not reach CONNECTED\n");
+        return 2;
+    }
+
+    // 第一轮不计数：静态对象的延迟初始化等只发生一次
+    for (int i = 0; i < MESSAGE_COUNT; i++)
+    {
+        deliver(MESSAGES[i]);
+        runLoop(2);
+    }
+
+    counting = true;
+    int reported = 0;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int i = 0; i < MESSAGE_COUNT; i++)
+        {
+            unsigned long before = allocations;
+            deliver(MESSAGES[i]);
+            runLoop(2);
+            if (allocations != before && reported++ < 10)
+            {
+                printf("[HeapTest] ✗ %s \"%s\": %lu allocation(s)\n", MESSAGES[i].path,
+                       MESSAGES[i].text ? MESSAGES[i].text : "<binary>", allocations - before);
+            }
+        }
+    }
+    counting = false;
+
+    printf("[HeapTest] %s %lu allocation(s) in %d rounds of %d messages\n",
+           allocations ? "✗" : "✓", allocations, ROUNDS, MESSAGE_COUNT);
+    return allocations ? 1 : 0;
+}
@@ -0,0 +1,45 @@
+// 主机编译用的 Adafruit_NeoPixel 子集：像素保存在内存里，show() 什么都不做
+#ifndef HOST_ADAFRUIT_NEOPIXEL_H
+#define HOST_ADAFRUIT_NEOPIXEL_H
+
+#include <Arduino.h>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel
+{
+private:
+    static const uint16_t MAX_PIXELS = 64;
+    uint32_t pixels[MAX_PIXELS];
+    uint16_t count;
+    uint8_t brightness;
+
+public:
+    Adafruit_NeoPixel(uint16_t n, int16_t pin = 6, uint16_t type = NEO_GRB + NEO_KHZ800)
+        : count(n < MAX_PIXELS ? n : MAX_PIXELS), brightness(255)
+    {
+        clear();
+    }
+
+    void begin() {}
+    void show() {}
+    void clear() { memset(pixels, 0, sizeof(pixels)); }
+    void setBrightness(uint8_t value) { brightness = value; }
+    uint8_t getBrightness() const { return brightness; }
+
+    void setPixelColor(uint16_t n, uint32_t c)
+    {
+        if (n < count)
+        {
+            pixels[n] = c;
+        }
+    }
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) { setPixelColor(n, Color(r, g, b)); }
+    uint32_t getPixelColor(uint16_t n) const { return n < count ? pixels[n] : 0; }
+    uint16_t numPixels() const { return count; }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+};
+
+#endif
@@ -0,0 +1,175 @@
+// 主机（Linux）编译用的 Arduino 核心子集
+// 只实现固件源码里用到的部分，供 tools/ 下的主机程序（render_host、heap_test 等）链接固件代码。
+// - millis() 是虚拟时间，由 hostAdvance() 推进，结果可复现
+// - micros() 是真实的单调时钟，用于测量渲染耗时
+// - String 与 Arduino 一样每次都在堆上分配（没有短字符串优化），堆计数测试才能看到它
+// - Serial 默认不输出，设置环境变量 HOST_SERIAL=1 时打印到 stdout
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <type_traits>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HEX 16
+#define DEC 10
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define A0 14
+#define PI 3.1415926535897932384626433832795
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Arduino 的 min / max 是宏；这里用模板，避免和 <algorithm> 等标准头冲突
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type min(A a, B b) { return a < b ? a : b; }
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type max(A a, B b) { return a > b ? a : b; }
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+int analogRead(int pin);
+int digitalRead(int pin);
+void digitalWrite(int pin, int value);
+void pinMode(int pin, int mode);
+
+// 主机端控制
+void hostAdvance(unsigned long ms); // 推进虚拟 millis()
+void hostSetMillis(unsigned long ms);
+
+class String
+{
+private:
+    char *buffer;
+    unsigned int len;
+
+    void assign(const char *text, unsigned int n);
+    void append(const char *text, unsigned int n);
+
+public:
+    String() : buffer(nullptr), len(0) {}
+    String(const char *text);
+    String(const String &other);
+    String(char c);
+    String(int value, unsigned char base = 10);
+    String(unsigned int value, unsigned char base = 10);
+    String(long value, unsigned char base = 10);
+    String(unsigned long value, unsigned char base = 10);
+    String(unsigned char value, unsigned char base = 10) : String((unsigned int)value, base) {}
+    String(float value, unsigned char decimals = 2);
+    String(double value, unsigned char decimals = 2);
+    ~String();
+
+    String &operator=(const String &other);
+    String &operator=(const char *text);
+
+    const char *c_str() const { return buffer ? buffer : ""; }
+    unsigned int length() const { return len; }
+    bool reserve(unsigned int size);
+
+    String &operator+=(const String &other);
+    String &operator+=(const char *text);
+    String &operator+=(char c);
+    String &concat(const String &other) { return *this += other; }
+
+    bool operator==(const String &other) const { return strcmp(c_str(), other.c_str()) == 0; }
+    bool operator==(const char *text) const { return strcmp(c_str(), text) == 0; }
+    bool operator!=(const String &other) const { return !(*this == other); }
+    bool operator!=(const char *text) const { return !(*this == text); }
+    char operator[](unsigned int i) const { return i < len ? buffer[i] : 0; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+
+    bool equals(const String &other) const { return *this == other; }
+    bool equalsIgnoreCase(const String &other) const;
+    bool startsWith(const String &prefix) const;
+    bool endsWith(const String &suffix) const;
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String &text, unsigned int from = 0) const;
+    String substring(unsigned int from) const { return substring(from, len); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return atof(c_str()); }
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+};
+
+String operator+(const String &a, const String &b);
+String operator+(const String &a, const char *b);
+String operator+(const char *a, const String &b);
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *data, size_t size);
+    size_t write(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    size_t write(const char *data, size_t size) { return write((const uint8_t *)data, size); }
+
+    size_t print(const char *text) { return write(text); }
+    size_t print(const String &text) { return write(text.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int decimals = 2);
+
+    size_t println() { return write((uint8_t)'\n'); }
+    template <typename T>
+    size_t println(T value) { return print(value) + println(); }
+    template <typename T>
+    size_t println(T value, int format) { return print(value, format) + println(); }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+    void setTimeout(unsigned long) {}
+    String readStringUntil(char terminator);
+};
+
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long) {}
+    operator bool() const { return true; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *data, size_t size) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
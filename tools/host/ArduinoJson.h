@@ -0,0 +1,148 @@
+// 主机编译用的 ArduinoJson 6 子集
+// 只支持固件实际用到的部分：一层 JSON 对象，按键读取字符串 / 数字字段。
+// 嵌套的对象和数组会被跳过（读取结果为 null）。与 ArduinoJson 一样不分配堆内存：
+// 输入复制进文档自带的缓冲区，字符串原地解码。
+
+#ifndef HOST_ARDUINOJSON_H
+#define HOST_ARDUINOJSON_H
+
+#include <Arduino.h>
+
+class DeserializationError
+{
+public:
+    enum Code
+    {
+        Ok,
+        EmptyInput,
+        IncompleteInput,
+        InvalidInput,
+        NoMemory
+    };
+
+    DeserializationError(Code c = Ok) : code(c) {}
+    explicit operator bool() const { return code != Ok; }
+    const char *c_str() const
+    {
+        static const char *names[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory"};
+        return names[code];
+    }
+
+private:
+    Code code;
+};
+
+class JsonVariantConst
+{
+public:
+    enum Type
+    {
+        TYPE_NULL,
+        TYPE_STRING,
+        TYPE_NUMBER,
+        TYPE_BOOL,
+        TYPE_NESTED
+    };
+
+    JsonVariantConst() : type(TYPE_NULL), text(nullptr) {}
+    JsonVariantConst(Type t, const char *value) : type(t), text(value) {}
+
+    bool isNull() const { return type == TYPE_NULL; }
+
+    template <typename T>
+    bool is() const;
+
+    template <typename T>
+    T as() const;
+
+private:
+    Type type;
+    const char *text;
+};
+
+template <>
+inline bool JsonVariantConst::is<float>() const { return type == TYPE_NUMBER; }
+template <>
+inline bool JsonVariantConst::is<double>() const { return type == TYPE_NUMBER; }
+template <>
+inline bool JsonVariantConst::is<int>() const { return type == TYPE_NUMBER && strpbrk(text, ".eE") == nullptr; }
+template <>
+inline bool JsonVariantConst::is<bool>() const { return type == TYPE_BOOL; }
+template <>
+inline bool JsonVariantConst::is<const char *>() const { return type == TYPE_STRING; }
+
+template <>
+inline float JsonVariantConst::as<float>() const { return type == TYPE_NUMBER ? strtof(text, nullptr) : 0; }
+template <>
+inline double JsonVariantConst::as<double>() const { return type == TYPE_NUMBER ? strtod(text, nullptr) : 0; }
+template <>
+inline int JsonVariantConst::as<int>() const { return type == TYPE_NUMBER ? atoi(text) : 0; }
+template <>
+inline long JsonVariantConst::as<long>() const { return type == TYPE_NUMBER ? atol(text) : 0; }
+template <>
+inline bool JsonVariantConst::as<bool>() const { return type == TYPE_BOOL && text[0] == 't'; }
+template <>
+inline const char *JsonVariantConst::as<const char *>() const { return type == TYPE_STRING ? text : nullptr; }
+
+class JsonDocument
+{
+private:
+    static const uint8_t MAX_MEMBERS = 32;
+
+    struct Member
+    {
+        const char *key;
+        JsonVariantConst value;
+    };
+
+    char *buffer;
+    size_t capacity;
+    Member members[MAX_MEMBERS];
+    uint8_t memberCount;
+
+    friend DeserializationError deserializeJson(JsonDocument &doc, const char *input, size_t length);
+
+protected:
+    JsonDocument(char *storage, size_t size) : buffer(storage), capacity(size), memberCount(0) {}
+
+public:
+    JsonVariantConst operator[](const char *key) const
+    {
+        for (uint8_t i = 0; i < memberCount; i++)
+        {
+            if (strcmp(members[i].key, key) == 0)
+            {
+                return members[i].value;
+            }
+        }
+        return JsonVariantConst();
+    }
+
+    bool containsKey(const char *key) const { return !(*this)[key].isNull(); }
+    size_t size() const { return memberCount; }
+    void clear() { memberCount = 0; }
+};
+
+template <size_t N>
+class StaticJsonDocument : public JsonDocument
+{
+private:
+    char storage[N];
+
+public:
+    StaticJsonDocument() : JsonDocument(storage, N) {}
+};
+
+DeserializationError deserializeJson(JsonDocument &doc, const char *input, size_t length);
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const uint8_t *input, size_t length)
+{
+    return deserializeJson(doc, (const char *)input, length);
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const char *input)
+{
+    return deserializeJson(doc, input, strlen(input));
+}
+
+#endif
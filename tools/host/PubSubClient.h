@@ -0,0 +1,76 @@
+// 主机编译用的 PubSubClient 子集
+// connect() 总是成功；publish() 交给 hostSetPublishHook() 设置的回调（用于抓取伞灯帧），
+// hostDeliver() 把一条消息当作从 broker 收到的，直接调用 setCallback() 注册的回调。
+
+#ifndef HOST_PUBSUBCLIENT_H
+#define HOST_PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include <WiFiNINA.h>
+
+#define MQTT_CALLBACK_SIGNATURE void (*callback)(char *, uint8_t *, unsigned int)
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+#define MQTT_CONNECT_BAD_PROTOCOL 1
+#define MQTT_CONNECT_BAD_CLIENT_ID 2
+#define MQTT_CONNECT_UNAVAILABLE 3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED 5
+
+typedef void (*HostPublishHook)(const char *topic, const uint8_t *payload, unsigned int length, bool retained);
+
+class PubSubClient
+{
+private:
+    Client *client;
+    bool isConnected;
+    uint16_t bufferSize;
+
+public:
+    PubSubClient(Client &c) : client(&c), isConnected(false), bufferSize(256) {}
+
+    PubSubClient &setServer(const char *domain, uint16_t port) { return *this; }
+    PubSubClient &setKeepAlive(uint16_t seconds) { return *this; }
+    PubSubClient &setSocketTimeout(uint16_t seconds) { return *this; }
+    PubSubClient &setCallback(MQTT_CALLBACK_SIGNATURE);
+    PubSubClient &setClient(Client &c)
+    {
+        client = &c;
+        return *this;
+    }
+    bool setBufferSize(uint16_t size)
+    {
+        bufferSize = size;
+        return true;
+    }
+    uint16_t getBufferSize() { return bufferSize; }
+
+    bool connect(const char *id, const char *user, const char *pass, const char *willTopic, uint8_t willQos, bool willRetain, const char *willMessage)
+    {
+        isConnected = true;
+        return true;
+    }
+    void disconnect() { isConnected = false; }
+    bool connected() { return isConnected; }
+    bool loop() { return isConnected; }
+    int state() { return isConnected ? MQTT_CONNECTED : MQTT_DISCONNECTED; }
+
+    bool publish(const char *topic, const char *payload) { return publish(topic, payload, false); }
+    bool publish(const char *topic, const char *payload, bool retained) { return publish(topic, (const uint8_t *)payload, strlen(payload), retained); }
+    bool publish(const char *topic, const uint8_t *payload, unsigned int length) { return publish(topic, payload, length, false); }
+    bool publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained);
+
+    bool subscribe(const char *topic) { return isConnected; }
+    bool subscribe(const char *topic, uint8_t qos) { return isConnected; }
+    bool unsubscribe(const char *topic) { return isConnected; }
+};
+
+// 主机端
+void hostSetPublishHook(HostPublishHook hook);
+void hostDeliver(const char *topic, const uint8_t *payload, unsigned int length);
+
+#endif
@@ -0,0 +1,79 @@
+// 主机编译用的 WiFiNINA 子集
+// WiFi 总是处于已连接状态；所有 WiFiClient 共用一条环回“连接”：
+// 写入完整的 SUBSCRIBE 报文后自动回复 SUBACK（全部授予 QoS 0），写入 MQTT 5 CONNECT 后回复 CONNACK
+// （Topic Alias Maximum = HOST_TOPIC_ALIAS_MAX），这样 MQTTManager 和 MQTT5Publisher 的连接状态机可以原样跑到连接完成。
+
+#ifndef HOST_WIFININA_H
+#define HOST_WIFININA_H
+
+#include <Arduino.h>
+#include "utility/wl_definitions.h"
+
+class IPAddress
+{
+private:
+    uint32_t address;
+
+public:
+    IPAddress() : address(0) {}
+    IPAddress(uint32_t value) : address(value) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+    operator uint32_t() const { return address; }
+    uint8_t operator[](int index) const { return (address >> (index * 8)) & 0xFF; }
+    String toString() const;
+};
+
+class Client : public Stream
+{
+public:
+    virtual int connect(const char *host, uint16_t port) = 0;
+    virtual int connected() = 0;
+    virtual void stop() = 0;
+    virtual void flush() {}
+};
+
+class WiFiClient : public Client
+{
+private:
+    uint8_t sock;
+
+public:
+    WiFiClient() : sock(NO_SOCKET_AVAIL) {}
+    WiFiClient(uint8_t socket) : sock(socket) {}
+
+    int connect(const char *host, uint16_t port) override;
+    int connected() override { return sock != NO_SOCKET_AVAIL; }
+    void stop() override { sock = NO_SOCKET_AVAIL; }
+    operator bool() { return connected(); }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *data, size_t size) override;
+    using Print::write;
+
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size);
+    int peek() override;
+};
+
+class WiFiClass
+{
+public:
+    int status() { return WL_CONNECTED; }
+    const char *SSID() { return "host"; }
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    int32_t RSSI() { return -50; }
+    uint8_t *macAddress(uint8_t *mac);
+    int hostByName(const char *host, IPAddress &result);
+};
+
+extern WiFiClass WiFi;
+
+#define HOST_TOPIC_ALIAS_MAX 10
+
+// 主机端
+typedef void (*HostWriteHook)(const uint8_t *data, size_t size);
+void hostSetWriteHook(HostWriteHook hook); // 每次 WiFiClient::write() 写出的字节
+void hostSetSegmentSize(size_t bytes);     // 回复按 bytes 字节一段到达，millis() 每变化一次到达一段（0 = 立即全部可读）
+
+#endif
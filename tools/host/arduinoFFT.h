@@ -0,0 +1,25 @@
+// 主机编译用的 arduinoFFT 接口；主机程序用 host_audio.cpp 代替 FFT 分析，这里只需要类型
+#ifndef HOST_ARDUINOFFT_H
+#define HOST_ARDUINOFFT_H
+
+enum class FFTWindow
+{
+    Hamming
+};
+
+enum class FFTDirection
+{
+    Forward
+};
+
+template <typename T>
+class ArduinoFFT
+{
+public:
+    ArduinoFFT(T *vReal, T *vImag, unsigned int samples, T samplingFrequency) {}
+    void windowing(FFTWindow window, FFTDirection direction) {}
+    void compute(FFTDirection direction) {}
+    void complexToMagnitude() {}
+};
+
+#endif
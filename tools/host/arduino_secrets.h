@@ -0,0 +1,23 @@
+// 主机程序用的占位配置（固件的 arduino_secrets.h 不在仓库里）
+#ifndef HOST_ARDUINO_SECRETS_H
+#define HOST_ARDUINO_SECRETS_H
+
+#define MQTT_SERVER "localhost"
+#define MQTT_PORT 1883
+#define MQTT_USERNAME ""
+#define MQTT_PASSWORD ""
+#define MQTT_USER "host"
+
+struct WiFiCredentials
+{
+    const char *ssid;
+    const char *password;
+};
+
+const WiFiCredentials WIFI_NETWORKS[] = {{"host", ""}};
+const int WIFI_NETWORK_COUNT = 1;
+
+#define SECRET_SSID WIFI_NETWORKS[0].ssid
+#define SECRET_PASS WIFI_NETWORKS[0].password
+
+#endif
@@ -0,0 +1,402 @@
+// tools/host/Arduino.h 的实现
+#include <Arduino.h>
+
+#include <chrono>
+
+static unsigned long virtualMillis = 0;
+static uint32_t randomState = 1;
+
+unsigned long millis()
+{
+    return virtualMillis;
+}
+
+unsigned long micros()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void delay(unsigned long ms)
+{
+    virtualMillis += ms;
+}
+
+void delayMicroseconds(unsigned int) {}
+
+void hostAdvance(unsigned long ms)
+{
+    virtualMillis += ms;
+}
+
+void hostSetMillis(unsigned long ms)
+{
+    virtualMillis = ms;
+}
+
+// xorshift32：与平台的 rand() 无关，同一种子在任何机器上得到同样的序列
+long random(long howBig)
+{
+    if (howBig <= 0)
+    {
+        return 0;
+    }
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState % howBig;
+}
+
+long random(long howSmall, long howBig)
+{
+    return howSmall >= howBig ? howSmall : howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed)
+{
+    randomState = seed ? (uint32_t)seed : 1;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+int analogRead(int) { return 0; }
+int digitalRead(int) { return HIGH; }
+void digitalWrite(int, int) {}
+void pinMode(int, int) {}
+
+// ===== String =====
+
+void String::assign(const char *text, unsigned int n)
+{
+    delete[] buffer;
+    buffer = nullptr;
+    len = 0;
+    append(text, n);
+}
+
+void String::append(const char *text, unsigned int n)
+{
+    if (n == 0 && buffer != nullptr)
+    {
+        return;
+    }
+    char *grown = new char[len + n + 1];
+    if (buffer != nullptr)
+    {
+        memcpy(grown, buffer, len);
+    }
+    memcpy(grown + len, text, n);
+    len += n;
+    grown[len] = '\0';
+    delete[] buffer;
+    buffer = grown;
+}
+
+String::String(const char *text) : buffer(nullptr), len(0)
+{
+    if (text != nullptr)
+    {
+        append(text, strlen(text));
+    }
+}
+
+String::String(const String &other) : buffer(nullptr), len(0)
+{
+    if (other.buffer != nullptr)
+    {
+        append(other.buffer, other.len);
+    }
+}
+
+String::String(char c) : buffer(nullptr), len(0)
+{
+    append(&c, 1);
+}
+
+static void formatInteger(char *out, size_t size, unsigned long value, bool negative, unsigned char base)
+{
+    char digits[34];
+    int n = 0;
+    do
+    {
+        int d = value % base;
+        digits[n++] = d < 10 ? '0' + d : 'a' + d - 10;
+        value /= base;
+    } while (value > 0);
+
+    size_t pos = 0;
+    if (negative && pos + 1 < size)
+    {
+        out[pos++] = '-';
+    }
+    while (n > 0 && pos + 1 < size)
+    {
+        out[pos++] = digits[--n];
+    }
+    out[pos] = '\0';
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) : buffer(nullptr), len(0)
+{
+    char text[36];
+    bool negative = value < 0 && base == 10;
+    formatInteger(text, sizeof(text), negative ? -(unsigned long)value : (unsigned long)value, negative, base);
+    append(text, strlen(text));
+}
+
+String::String(unsigned long value, unsigned char base) : buffer(nullptr), len(0)
+{
+    char text[36];
+    formatInteger(text, sizeof(text), value, false, base);
+    append(text, strlen(text));
+}
+
+String::String(float value, unsigned char decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned char decimals) : buffer(nullptr), len(0)
+{
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", decimals, value);
+    append(text, strlen(text));
+}
+
+String::~String()
+{
+    delete[] buffer;
+}
+
+String &String::operator=(const String &other)
+{
+    if (this != &other)
+    {
+        assign(other.c_str(), other.len);
+    }
+    return *this;
+}
+
+String &String::operator=(const char *text)
+{
+    assign(text ? text : "", text ? strlen(text) : 0);
+    return *this;
+}
+
+bool String::reserve(unsigned int size)
+{
+    if (buffer == nullptr || size > len)
+    {
+        char *grown = new char[size + 1];
+        memcpy(grown, c_str(), len + 1);
+        delete[] buffer;
+        buffer = grown;
+    }
+    return true;
+}
+
+String &String::operator+=(const String &other)
+{
+    append(other.c_str(), other.len);
+    return *this;
+}
+
+String &String::operator+=(const char *text)
+{
+    append(text, strlen(text));
+    return *this;
+}
+
+String &String::operator+=(char c)
+{
+    append(&c, 1);
+    return *this;
+}
+
+bool String::equalsIgnoreCase(const String &other) const
+{
+    return strcasecmp(c_str(), other.c_str()) == 0;
+}
+
+bool String::startsWith(const String &prefix) const
+{
+    return prefix.len <= len && strncmp(c_str(), prefix.c_str(), prefix.len) == 0;
+}
+
+bool String::endsWith(const String &suffix) const
+{
+    return suffix.len <= len && strcmp(c_str() + len - suffix.len, suffix.c_str()) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const
+{
+    for (unsigned int i = from; i < len; i++)
+    {
+        if (buffer[i] == c)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int String::indexOf(const String &text, unsigned int from) const
+{
+    if (from > len)
+    {
+        return -1;
+    }
+    const char *found = strstr(c_str() + from, text.c_str());
+    return found ? (int)(found - c_str()) : -1;
+}
+
+String String::substring(unsigned int from, unsigned int to) const
+{
+    if (from > to)
+    {
+        unsigned int t = from;
+        from = to;
+        to = t;
+    }
+    if (to > len)
+    {
+        to = len;
+    }
+    String result;
+    if (from < to)
+    {
+        result.append(buffer + from, to - from);
+    }
+    return result;
+}
+
+void String::toLowerCase()
+{
+    for (unsigned int i = 0; i < len; i++)
+    {
+        buffer[i] = tolower(buffer[i]);
+    }
+}
+
+void String::toUpperCase()
+{
+    for (unsigned int i = 0; i < len; i++)
+    {
+        buffer[i] = toupper(buffer[i]);
+    }
+}
+
+void String::trim()
+{
+    unsigned int start = 0, end = len;
+    while (start < end && isspace((unsigned char)buffer[start]))
+    {
+        start++;
+    }
+    while (end > start && isspace((unsigned char)buffer[end - 1]))
+    {
+        end--;
+    }
+    if (start > 0 || end < len)
+    {
+        memmove(buffer, buffer + start, end - start);
+        len = end - start;
+        buffer[len] = '\0';
+    }
+}
+
+String operator+(const String &a, const String &b)
+{
+    String result(a);
+    result += b;
+    return result;
+}
+
+String operator+(const String &a, const char *b)
+{
+    String result(a);
+    result += b;
+    return result;
+}
+
+String operator+(const char *a, const String &b)
+{
+    String result(a);
+    result += b;
+    return result;
+}
+
+// ===== Print / Stream =====
+
+size_t Print::write(const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        write(data[i]);
+    }
+    return size;
+}
+
+size_t Print::print(long value, int base)
+{
+    char text[36];
+    bool negative = value < 0 && base == DEC;
+    formatInteger(text, sizeof(text), negative ? -(unsigned long)value : (unsigned long)value, negative, base);
+    return write(text);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char text[36];
+    formatInteger(text, sizeof(text), value, false, base);
+    return write(text);
+}
+
+size_t Print::print(double value, int decimals)
+{
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", decimals, value);
+    return write(text);
+}
+
+String Stream::readStringUntil(char terminator)
+{
+    String result;
+    int c;
+    while ((c = read()) >= 0 && c != terminator)
+    {
+        result += (char)c;
+    }
+    return result;
+}
+
+// ===== Serial =====
+
+static bool serialEnabled()
+{
+    static const bool enabled = getenv("HOST_SERIAL") != nullptr;
+    return enabled;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (serialEnabled())
+    {
+        fputc(c, stdout);
+    }
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *data, size_t size)
+{
+    if (serialEnabled())
+    {
+        fwrite(data, 1, size, stdout);
+    }
+    return size;
+}
+
+HardwareSerial Serial;
@@ -0,0 +1,92 @@
+// 主机程序用的 AudioAnalyzer：不采样、不做 FFT，频段由渲染时钟合成
+// 每个频段是一条频率不同的正弦（整数 sin8），同一时刻的结果在任何机器上都相同，
+// 所以 Music 模式的画面可以和 golden 帧逐字节比较。
+#include "audio_analyzer.h"
+#include "color_math.h"
+#include "render_clock.h"
+
+AudioAnalyzer::AudioAnalyzer()
+    : minDecibel(MIN_DB),
+      maxDecibel(MAX_DB),
+      FFT(ArduinoFFT<double>(vReal, vImag, SAMPLES, SAMPLING_FREQUENCY)),
+      sampling_period_us(1000000 / SAMPLING_FREQUENCY),
+      lastFFTTime(0),
+      analysisCount(0),
+      currentVolume(0.0),
+      smoothedVolume(0.0),
+      lastRawADC(0)
+{
+    for (int i = 0; i < NUM_BANDS; i++)
+    {
+        spectrumBands[i] = 0.0;
+        smoothedBands[i] = 0.0;
+    }
+}
+
+void AudioAnalyzer::begin()
+{
+}
+
+void AudioAnalyzer::loop()
+{
+    unsigned long now = renderClock.now();
+    if (now - lastFFTTime < AUDIO_ANALYSIS_INTERVAL_MS)
+    {
+        return;
+    }
+    lastFFTTime = now;
+    analysisCount++;
+
+    unsigned int total = 0;
+    for (int i = 0; i < NUM_BANDS; i++)
+    {
+        // 低频慢、高频快；相位错开让相邻频段不同步
+        uint8_t level = sin8((uint8_t)(now * (i + 2) / 16 + i * 37));
+        spectrumBands[i] = level / 255.0f;
+        smoothedBands[i] = spectrumBands[i];
+        total += level;
+    }
+    currentVolume = total / (255.0f * NUM_BANDS);
+    smoothedVolume = currentVolume;
+    lastRawADC = total * 1023 / (255 * NUM_BANDS);
+}
+
+void AudioAnalyzer::setVolumeRange(float minDb, float maxDb)
+{
+    minDecibel = minDb;
+    maxDecibel = maxDb;
+}
+
+void AudioAnalyzer::getVolumeRange(float &minDb, float &maxDb) const
+{
+    minDb = minDecibel;
+    maxDb = maxDecibel;
+}
+
+float AudioAnalyzer::getVolume() const
+{
+    return smoothedVolume;
+}
+
+float AudioAnalyzer::getVolumeDecibel() const
+{
+    return minDecibel + (maxDecibel - minDecibel) * smoothedVolume;
+}
+
+int AudioAnalyzer::getVolumeLevel(int maxLevels) const
+{
+    return constrain((int)(smoothedVolume * maxLevels), 0, maxLevels - 1);
+}
+
+void AudioAnalyzer::getVirtualBands(float bands[NUM_BANDS]) const
+{
+    for (int i = 0; i < NUM_BANDS; i++)
+    {
+        bands[i] = smoothedBands[i];
+    }
+}
+
+float AudioAnalyzer::getVirtualBand(int index) const
+{
+    return index >= 0 && index < NUM_BANDS ? smoothedBands[index] : 0.0f;
+}
@@ -0,0 +1,199 @@
+// tools/host/ArduinoJson.h 的解析器
+#include <ArduinoJson.h>
+
+namespace
+{
+    struct Cursor
+    {
+        char *pos;
+        char *end;
+
+        void skipSpace()
+        {
+            while (pos < end && isspace((unsigned char)*pos))
+            {
+                pos++;
+            }
+        }
+
+        bool consume(char c)
+        {
+            skipSpace();
+            if (pos < end && *pos == c)
+            {
+                pos++;
+                return true;
+            }
+            return false;
+        }
+    };
+
+    // 原地解码字符串（只处理常见转义），返回起始位置；失败返回 nullptr
+    char *readString(Cursor &in)
+    {
+        if (!in.consume('"'))
+        {
+            return nullptr;
+        }
+        char *start = in.pos, *out = in.pos;
+        while (in.pos < in.end && *in.pos != '"')
+        {
+            char c = *in.pos++;
+            if (c == '\\' && in.pos < in.end)
+            {
+                c = *in.pos++;
+                c = c == 'n' ? '\n' : c == 't' ? '\t' : c == 'r' ? '\r' : c;
+            }
+            *out++ = c;
+        }
+        if (in.pos >= in.end)
+        {
+            return nullptr;
+        }
+        in.pos++;
+        *out = '\0';
+        return start;
+    }
+
+    // 跳过嵌套的对象 / 数组
+    bool skipNested(Cursor &in)
+    {
+        int depth = 0;
+        bool inString = false;
+        for (; in.pos < in.end; in.pos++)
+        {
+            char c = *in.pos;
+            if (inString)
+            {
+                if (c == '\\')
+                {
+                    in.pos++;
+                }
+                else if (c == '"')
+                {
+                    inString = false;
+                }
+            }
+            else if (c == '"')
+            {
+                inString = true;
+            }
+            else if (c == '{' || c == '[')
+            {
+                depth++;
+            }
+            else if ((c == '}' || c == ']') && --depth == 0)
+            {
+                in.pos++;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, const char *input, size_t length)
+{
+    doc.memberCount = 0;
+    if (length == 0)
+    {
+        return DeserializationError::EmptyInput;
+    }
+    if (length >= doc.capacity)
+    {
+        return DeserializationError::NoMemory;
+    }
+    memcpy(doc.buffer, input, length);
+    doc.buffer[length] = '\0';
+
+    Cursor in = {doc.buffer, doc.buffer + length};
+    if (!in.consume('{'))
+    {
+        return DeserializationError::InvalidInput;
+    }
+    if (in.consume('}'))
+    {
+        return DeserializationError::Ok;
+    }
+
+    do
+    {
+        char *key = readString(in);
+        if (key == nullptr || !in.consume(':'))
+        {
+            return DeserializationError::InvalidInput;
+        }
+        in.skipSpace();
+        if (in.pos >= in.end)
+        {
+            return DeserializationError::IncompleteInput;
+        }
+
+        JsonVariantConst value;
+        char c = *in.pos;
+        if (c == '"')
+        {
+            char *text = readString(in);
+            if (text == nullptr)
+            {
+                return DeserializationError::IncompleteInput;
+            }
+            value = JsonVariantConst(JsonVariantConst::TYPE_STRING, text);
+        }
+        else if (c == '{' || c == '[')
+        {
+            if (!skipNested(in))
+            {
+                return DeserializationError::IncompleteInput;
+            }
+            value = JsonVariantConst(JsonVariantConst::TYPE_NESTED, nullptr);
+        }
+        else
+        {
+            // 数字 / true / false / null：截到分隔符为止
+            char *start = in.pos;
+            while (in.pos < in.end && *in.pos != ',' && *in.pos != '}' && !isspace((unsigned char)*in.pos))
+            {
+                in.pos++;
+            }
+            char separator = in.pos < in.end ? *in.pos : '\0';
+            *in.pos = '\0';
+
+            if (strcmp(start, "true") == 0 || strcmp(start, "false") == 0)
+            {
+                value = JsonVariantConst(JsonVariantConst::TYPE_BOOL, start);
+            }
+            else if (strcmp(start, "null") != 0)
+            {
+                char *numberEnd;
+                strtod(start, &numberEnd);
+                if (numberEnd == start || *numberEnd != '\0')
+                {
+                    return DeserializationError::InvalidInput;
+                }
+                value = JsonVariantConst(JsonVariantConst::TYPE_NUMBER, start);
+            }
+
+            // 分隔符被 '\0' 覆盖了，放回去给下面的 consume() 读取
+            if (separator == ',' || separator == '}')
+            {
+                *in.pos = separator;
+            }
+            else if (in.pos < in.end)
+            {
+                in.pos++;
+            }
+        }
+
+        if (doc.memberCount < JsonDocument::MAX_MEMBERS)
+        {
+            doc.members[doc.memberCount++] = {key, value};
+        }
+        else
+        {
+            return DeserializationError::NoMemory;
+        }
+    } while (in.consume(','));
+
+    return in.consume('}') ? DeserializationError::Ok : DeserializationError::InvalidInput;
+}
@@ -0,0 +1,227 @@
+// tools/host 下 WiFiNINA / PubSubClient 的实现
+#include <PubSubClient.h>
+#include <WiFiNINA.h>
+
+WiFiClass WiFi;
+
+// 环回连接：tx 收集客户端写出的字节，rx 是等待客户端读取的回复
+static uint8_t txBuffer[1024];
+static size_t txLength = 0;
+static uint8_t rxBuffer[256];
+static size_t rxHead = 0, rxLength = 0;
+static size_t rxVisible = 0;   // 分段到达时已经到达的字节（rxBuffer 下标）
+static size_t segmentSize = 0; // 0 = 不分段
+static unsigned long segmentMillis = 0;
+static HostWriteHook writeHook = nullptr;
+
+void hostSetWriteHook(HostWriteHook hook)
+{
+    writeHook = hook;
+}
+
+void hostSetSegmentSize(size_t bytes)
+{
+    segmentSize = bytes;
+}
+
+// 已到达、可以读的末尾：分段时虚拟时间每前进一次多到达一段
+static size_t rxEnd()
+{
+    if (segmentSize == 0)
+    {
+        return rxLength;
+    }
+    if (millis() != segmentMillis)
+    {
+        segmentMillis = millis();
+        rxVisible = min(rxVisible + segmentSize, rxLength);
+    }
+    return rxVisible;
+}
+
+static void queueReply(const uint8_t *data, size_t size)
+{
+    if (rxLength + size > sizeof(rxBuffer))
+    {
+        return;
+    }
+    memcpy(rxBuffer + rxLength, data, size);
+    rxLength += size;
+}
+
+// tx 里是一个完整的 SUBSCRIBE 报文时回复 SUBACK（每个主题一个返回码 0x00），
+// 是 MQTT 5 CONNECT 时回复带 Topic Alias Maximum 的 CONNACK
+static void answer()
+{
+    if (txLength >= 9 && txBuffer[0] == 0x10)
+    {
+        // 固定头之后：协议名 "MQTT"（2 + 4 字节）、协议版本；PubSubClient 替身不写 CONNECT，这里只会是 MQTT5Publisher
+        size_t pos = 1;
+        while (pos < txLength && (txBuffer[pos] & 0x80))
+        {
+            pos++;
+        }
+        if (pos + 7 < txLength && txBuffer[pos + 7] == 5)
+        {
+            static const uint8_t CONNACK[] = {0x20, 6, 0x00, 0x00, 3, 0x22, 0x00, HOST_TOPIC_ALIAS_MAX};
+            queueReply(CONNACK, sizeof(CONNACK));
+        }
+        txLength = 0;
+        return;
+    }
+    if (txLength < 2 || txBuffer[0] != 0x82)
+    {
+        txLength = 0; // 其他报文不需要回复
+        return;
+    }
+
+    size_t remaining = 0, pos = 1;
+    for (int shift = 0; pos < txLength; shift += 7)
+    {
+        uint8_t digit = txBuffer[pos++];
+        remaining |= (size_t)(digit & 0x7F) << shift;
+        if (!(digit & 0x80))
+        {
+            break;
+        }
+    }
+    if (txLength < pos + remaining)
+    {
+        return; // 还没写完
+    }
+
+    size_t end = pos + remaining;
+    uint8_t reply[64] = {0x90, 2, txBuffer[pos], txBuffer[pos + 1]};
+    size_t filters = 0;
+    pos += 2;
+    while (pos + 2 <= end && filters < sizeof(reply) - 4)
+    {
+        pos += 2 + ((txBuffer[pos] << 8) | txBuffer[pos + 1]) + 1;
+        reply[4 + filters++] = 0x00;
+    }
+    reply[1] = 2 + filters;
+    queueReply(reply, 4 + filters);
+    txLength = 0;
+}
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+    sock = 0;
+    return 1;
+}
+
+size_t WiFiClient::write(const uint8_t *data, size_t size)
+{
+    if (txLength + size > sizeof(txBuffer))
+    {
+        txLength = 0;
+        return 0;
+    }
+    if (writeHook != nullptr)
+    {
+        writeHook(data, size);
+    }
+    memcpy(txBuffer + txLength, data, size);
+    txLength += size;
+    answer();
+    return size;
+}
+
+int WiFiClient::available()
+{
+    return rxEnd() - rxHead;
+}
+
+int WiFiClient::read()
+{
+    if (rxHead >= rxEnd())
+    {
+        return -1;
+    }
+    int c = rxBuffer[rxHead++];
+    if (rxHead == rxLength)
+    {
+        rxHead = rxLength = rxVisible = 0;
+    }
+    return c;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    int c;
+    while (n < size && (c = read()) >= 0)
+    {
+        buffer[n++] = c;
+    }
+    return n;
+}
+
+int WiFiClient::peek()
+{
+    return rxHead < rxEnd() ? rxBuffer[rxHead] : -1;
+}
+
+String IPAddress::toString() const
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", address & 0xFF, (address >> 8) & 0xFF, (address >> 16) & 0xFF, address >> 24);
+    return String(text);
+}
+
+uint8_t *WiFiClass::macAddress(uint8_t *mac)
+{
+    static const uint8_t HOST_MAC[6] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB};
+    memcpy(mac, HOST_MAC, 6);
+    return mac;
+}
+
+int WiFiClass::hostByName(const char *host, IPAddress &result)
+{
+    result = IPAddress(127, 0, 0, 1);
+    return 1;
+}
+
+// ===== PubSubClient =====
+
+static void (*deliverCallback)(char *, uint8_t *, unsigned int) = nullptr;
+static HostPublishHook publishHook = nullptr;
+
+PubSubClient &PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE)
+{
+    deliverCallback = callback;
+    return *this;
+}
+
+bool PubSubClient::publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained)
+{
+    if (!isConnected)
+    {
+        return false;
+    }
+    if (publishHook != nullptr)
+    {
+        publishHook(topic, payload, length, retained);
+    }
+    return true;
+}
+
+void hostSetPublishHook(HostPublishHook hook)
+{
+    publishHook = hook;
+}
+
+void hostDeliver(const char *topic, const uint8_t *payload, unsigned int length)
+{
+    if (deliverCallback == nullptr)
+    {
+        return;
+    }
+    // 与 PubSubClient 一样，回调拿到的是接收缓冲区里的可写副本
+    static char topicBuffer[128];
+    static uint8_t payloadBuffer[512];
+    snprintf(topicBuffer, sizeof(topicBuffer), "%s", topic);
+    length = min(length, (unsigned int)sizeof(payloadBuffer));
+    memcpy(payloadBuffer, payload, length);
+    deliverCallback(topicBuffer, payloadBuffer, length);
+}
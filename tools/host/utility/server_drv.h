@@ -0,0 +1,19 @@
+// 主机编译用的 ServerDrv 子集：socket 立即进入 ESTABLISHED
+#ifndef HOST_SERVER_DRV_H
+#define HOST_SERVER_DRV_H
+
+#include <stdint.h>
+#include "wl_definitions.h"
+
+#define TCP_MODE 0
+
+class ServerDrv
+{
+public:
+    static uint8_t getSocket() { return 0; }
+    static void startClient(uint32_t ip, uint16_t port, uint8_t sock, uint8_t mode = TCP_MODE) {}
+    static void stopClient(uint8_t sock) {}
+    static uint8_t getClientState(uint8_t sock) { return ESTABLISHED; }
+};
+
+#endif
@@ -0,0 +1,450 @@
+// 伞灯接收端模拟器（主机程序）
+// 订阅 student/CASA0014/luminaire/<id>，还原 72 LED 帧（可选在终端显示），
+// 并配合固件的帧信息（<base>/info/luminaire/frame，见 luminaire_group.h）统计丢帧、抖动和延迟。
+//
+// 编译（需要 libmosquitto）：
+//   g++ -O2 -std=c++11 luminaire_emulator.cpp -lmosquitto -o luminaire_emulator
+// 运行：
+//   ./luminaire_emulator -h localhost -i 16 -b student/CASA0014/<user> --show
+//
+// 延迟说明：设备和主机的时钟不同步，无法得到绝对单程延迟。
+// 这里用每个统计窗口内 (到达时间 - sendMicros) 的最小值作为基线，
+// 报告的网络延迟是相对最快一帧的额外延迟；加上设备端的渲染耗时即为端到端延迟的可变部分。
+
+#include <mosquitto.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const int NUM_RIBS = 12;
+static const int NUM_POSITIONS = 6;
+static const int FRAME_SIZE = NUM_RIBS * NUM_POSITIONS * 3;
+static const int FRAME_META_SIZE = 12;
+static const uint8_t FRAME_META_REPLAY = 0x01;
+
+struct Options
+{
+    std::string host = "localhost";
+    int port = 1883;
+    std::string id = "16";
+    std::string base; // 设备的 TOPIC_BASE，为空时不订阅帧信息
+    std::string username;
+    std::string password;
+    bool show = false;
+    int reportSeconds = 5;
+};
+
+struct Stats
+{
+    // 窗口统计（每次报告后清零）
+    uint64_t frames = 0;
+    uint64_t replayFrames = 0;
+    uint64_t badFrames = 0;  // 长度不是 216 字节
+    uint64_t lost = 0;       // 序号跳变
+    uint64_t metaMissing = 0; // 帧到了，帧信息没到
+    uint64_t frameMissing = 0; // 帧信息到了，帧没到
+    uint64_t reordered = 0;
+    std::vector<int64_t> offsets; // 到达时间 - 设备发送时间（us，含未知的时钟差）
+    std::vector<int64_t> renders; // 设备端渲染耗时（us）
+
+    void clearWindow()
+    {
+        frames = replayFrames = badFrames = lost = metaMissing = frameMissing = reordered = 0;
+        offsets.clear();
+        renders.clear();
+    }
+};
+
+struct Emulator
+{
+    Options options;
+    std::string frameTopic;
+    std::string metaTopic;
+
+    uint8_t frame[FRAME_SIZE];
+
+    // 等待与帧信息配对的帧
+    bool pendingFrame = false;
+    int64_t pendingArrival = 0;
+
+    // 序号 / 设备时钟
+    bool haveSeq = false;
+    uint32_t lastSeq = 0;
+    uint32_t lastSendRaw = 0;
+    int64_t deviceMicros = 0; // 展开后的设备 micros()（处理 32 位回绕）
+    int64_t lastArrival = 0;
+    int64_t lastDevice = 0;
+    double jitter = 0.0; // RFC 3550 到达间隔抖动（us）
+
+    int64_t lastDraw = 0;
+    Stats stats;
+    uint64_t totalFrames = 0;
+    uint64_t totalLost = 0;
+};
+
+static int64_t nowMicros()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static uint32_t readLE(const uint8_t *in, int bytes)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++)
+    {
+        value |= (uint32_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static int64_t percentile(std::vector<int64_t> values, int pct)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = (values.size() - 1) * pct / 100;
+    return values[index];
+}
+
+// 每条伞骨一行，中心在左，伞沿在右（24 位真彩色）
+static void drawFrame(const uint8_t *frame)
+{
+    std::string out = "\x1b[H";
+    char cell[48];
+    for (int rib = 0; rib < NUM_RIBS; rib++)
+    {
+        snprintf(cell, sizeof(cell), "rib %2d ", rib);
+        out += cell;
+        for (int pos = 0; pos < NUM_POSITIONS; pos++)
+        {
+            const uint8_t *p = frame + (rib * NUM_POSITIONS + pos) * 3;
+            snprintf(cell, sizeof(cell), "\x1b[48;2;%d;%d;%dm  \x1b[0m", p[0], p[1], p[2]);
+            out += cell;
+        }
+        out += "\x1b[K\n";
+    }
+    fputs(out.c_str(), stdout);
+    fflush(stdout);
+}
+
+static void handleFrame(Emulator &emu, const uint8_t *payload, int length, int64_t arrival)
+{
+    if (length != FRAME_SIZE)
+    {
+        emu.stats.badFrames++;
+        return;
+    }
+
+    memcpy(emu.frame, payload, FRAME_SIZE);
+    emu.stats.frames++;
+    emu.totalFrames++;
+
+    if (!emu.metaTopic.empty())
+    {
+        if (emu.pendingFrame)
+        {
+            emu.stats.metaMissing++;
+        }
+        emu.pendingFrame = true;
+        emu.pendingArrival = arrival;
+    }
+
+    // 显示限制在 30 FPS
+    if (emu.options.show && arrival - emu.lastDraw > 33000)
+    {
+        drawFrame(emu.frame);
+        emu.lastDraw = arrival;
+    }
+}
+
+static void handleMeta(Emulator &emu, const uint8_t *payload, int length)
+{
+    if (length < FRAME_META_SIZE)
+    {
+        return;
+    }
+
+    uint32_t seq = readLE(payload, 4);
+    uint32_t sendRaw = readLE(payload + 4, 4);
+    uint32_t render = readLE(payload + 8, 2);
+    uint8_t units = payload[10];
+    uint8_t flags = payload[11];
+
+    if (!emu.pendingFrame)
+    {
+        emu.stats.frameMissing++;
+    }
+
+    // 序号检查：跳变 = 丢帧；倒退很多 = 设备重启
+    bool restarted = false;
+    if (emu.haveSeq)
+    {
+        uint32_t expected = emu.lastSeq + 1;
+        if (seq > expected && seq - expected < 100000)
+        {
+            emu.stats.lost += seq - expected;
+            emu.totalLost += seq - expected;
+        }
+        else if (seq != expected && seq <= emu.lastSeq && emu.lastSeq - seq < 16)
+        {
+            emu.stats.reordered++;
+            emu.pendingFrame = false;
+            return;
+        }
+        else if (seq != expected)
+        {
+            restarted = true;
+            printf("[Emulator] Sequence reset (%u -> %u), device restarted?\n", emu.lastSeq, seq);
+        }
+    }
+
+    if (!emu.haveSeq || restarted)
+    {
+        emu.deviceMicros = sendRaw;
+        emu.lastArrival = 0;
+        emu.jitter = 0.0;
+        emu.stats.offsets.clear();
+    }
+    else
+    {
+        emu.deviceMicros += (uint32_t)(sendRaw - emu.lastSendRaw);
+    }
+    emu.haveSeq = true;
+    emu.lastSeq = seq;
+    emu.lastSendRaw = sendRaw;
+
+    if (flags & FRAME_META_REPLAY)
+    {
+        emu.stats.replayFrames++;
+    }
+    (void)units;
+
+    if (!emu.pendingFrame)
+    {
+        return;
+    }
+    emu.pendingFrame = false;
+
+    int64_t arrival = emu.pendingArrival;
+    emu.stats.offsets.push_back(arrival - emu.deviceMicros);
+    emu.stats.renders.push_back(render);
+
+    if (emu.lastArrival != 0)
+    {
+        int64_t d = (arrival - emu.lastArrival) - (emu.deviceMicros - emu.lastDevice);
+        emu.jitter += ((double)(d < 0 ? -d : d) - emu.jitter) / 16.0;
+    }
+    emu.lastArrival = arrival;
+    emu.lastDevice = emu.deviceMicros;
+}
+
+static void printReport(Emulator &emu, double seconds)
+{
+    Stats &s = emu.stats;
+    uint64_t expected = s.frames + s.lost;
+
+    printf("[Emulator] %.1f fps, %llu frames", s.frames / seconds, (unsigned long long)s.frames);
+    if (s.replayFrames > 0)
+    {
+        printf(" (%llu replay)", (unsigned long long)s.replayFrames);
+    }
+    if (s.badFrames > 0)
+    {
+        printf(", %llu bad size", (unsigned long long)s.badFrames);
+    }
+
+    if (emu.metaTopic.empty())
+    {
+        printf("\n");
+        return;
+    }
+
+    printf(", lost %llu (%.2f%%), total lost %llu\n",
+           (unsigned long long)s.lost,
+           expected > 0 ? 100.0 * s.lost / expected : 0.0,
+           (unsigned long long)emu.totalLost);
+
+    if (s.offsets.empty())
+    {
+        printf("[Emulator]   no frame info received on %s\n", emu.metaTopic.c_str());
+        return;
+    }
+
+    // 网络延迟：相对窗口内最快一帧
+    int64_t base = *std::min_element(s.offsets.begin(), s.offsets.end());
+    std::vector<int64_t> network;
+    std::vector<int64_t> total;
+    for (size_t i = 0; i < s.offsets.size(); i++)
+    {
+        network.push_back(s.offsets[i] - base);
+        total.push_back(s.offsets[i] - base + s.renders[i]);
+    }
+
+    printf("[Emulator]   render   p50 %6.2f  p95 %6.2f  max %6.2f ms\n",
+           percentile(s.renders, 50) / 1000.0, percentile(s.renders, 95) / 1000.0, percentile(s.renders, 100) / 1000.0);
+    printf("[Emulator]   network  p50 %6.2f  p95 %6.2f  p99 %6.2f  max %6.2f ms (above fastest frame)\n",
+           percentile(network, 50) / 1000.0, percentile(network, 95) / 1000.0,
+           percentile(network, 99) / 1000.0, percentile(network, 100) / 1000.0);
+    printf("[Emulator]   total    p50 %6.2f  p95 %6.2f  p99 %6.2f ms, jitter %.2f ms\n",
+           percentile(total, 50) / 1000.0, percentile(total, 95) / 1000.0,
+           percentile(total, 99) / 1000.0, emu.jitter / 1000.0);
+    if (s.metaMissing > 0 || s.frameMissing > 0 || s.reordered > 0)
+    {
+        printf("[Emulator]   unpaired: %llu frames without info, %llu info without frame, %llu reordered\n",
+               (unsigned long long)s.metaMissing, (unsigned long long)s.frameMissing,
+               (unsigned long long)s.reordered);
+    }
+}
+
+static void onConnect(struct mosquitto *mosq, void *userdata, int rc)
+{
+    Emulator *emu = (Emulator *)userdata;
+    if (rc != 0)
+    {
+        printf("[Emulator] ✗ Connect failed: %s\n", mosquitto_connack_string(rc));
+        return;
+    }
+
+    printf("[Emulator] ✓ Connected, subscribing to %s\n", emu->frameTopic.c_str());
+    mosquitto_subscribe(mosq, nullptr, emu->frameTopic.c_str(), 0);
+    if (!emu->metaTopic.empty())
+    {
+        printf("[Emulator] ✓ Frame info: %s\n", emu->metaTopic.c_str());
+        mosquitto_subscribe(mosq, nullptr, emu->metaTopic.c_str(), 0);
+    }
+}
+
+static void onMessage(struct mosquitto *, void *userdata, const struct mosquitto_message *msg)
+{
+    Emulator *emu = (Emulator *)userdata;
+    int64_t arrival = nowMicros();
+    const uint8_t *payload = (const uint8_t *)msg->payload;
+
+    if (emu->frameTopic == msg->topic)
+    {
+        handleFrame(*emu, payload, msg->payloadlen, arrival);
+    }
+    else if (emu->metaTopic == msg->topic)
+    {
+        handleMeta(*emu, payload, msg->payloadlen);
+    }
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n", name);
+    printf("  -h <host>      broker host (default localhost)\n");
+    printf("  -p <port>      broker port (default 1883)\n");
+    printf("  -i <id>        luminaire ID (default 16)\n");
+    printf("  -b <base>      device topic base, e.g. student/CASA0014/<user> (enables latency / loss stats)\n");
+    printf("  -u <user>      broker username\n");
+    printf("  -P <password>  broker password\n");
+    printf("  -r <seconds>   report interval (default 5)\n");
+    printf("  --show         draw frames in the terminal (24-bit colour)\n");
+}
+
+int main(int argc, char **argv)
+{
+    Emulator emu;
+    Options &opt = emu.options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-h" && hasValue)
+            opt.host = argv[++i];
+        else if (arg == "-p" && hasValue)
+            opt.port = atoi(argv[++i]);
+        else if (arg == "-i" && hasValue)
+            opt.id = argv[++i];
+        else if (arg == "-b" && hasValue)
+            opt.base = argv[++i];
+        else if (arg == "-u" && hasValue)
+            opt.username = argv[++i];
+        else if (arg == "-P" && hasValue)
+            opt.password = argv[++i];
+        else if (arg == "-r" && hasValue)
+            opt.reportSeconds = std::max(1, atoi(argv[++i]));
+        else if (arg == "--show")
+            opt.show = true;
+        else
+        {
+            usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    emu.frameTopic = "student/CASA0014/luminaire/" + opt.id;
+    if (!opt.base.empty())
+    {
+        emu.metaTopic = opt.base + "/info/luminaire/frame";
+    }
+    memset(emu.frame, 0, sizeof(emu.frame));
+
+    if (opt.show)
+    {
+        printf("\x1b[2J");
+    }
+
+    mosquitto_lib_init();
+    struct mosquitto *mosq = mosquitto_new(nullptr, true, &emu);
+    if (!mosq)
+    {
+        printf("[Emulator] ✗ Out of memory\n");
+        return 1;
+    }
+    if (!opt.username.empty())
+    {
+        mosquitto_username_pw_set(mosq, opt.username.c_str(), opt.password.empty() ? nullptr : opt.password.c_str());
+    }
+    mosquitto_connect_callback_set(mosq, onConnect);
+    mosquitto_message_callback_set(mosq, onMessage);
+
+    int rc = mosquitto_connect(mosq, opt.host.c_str(), opt.port, 60);
+    if (rc != MOSQ_ERR_SUCCESS)
+    {
+        printf("[Emulator] ✗ Cannot connect to %s:%d: %s\n", opt.host.c_str(), opt.port, mosquitto_strerror(rc));
+        mosquitto_destroy(mosq);
+        mosquitto_lib_cleanup();
+        return 1;
+    }
+
+    int64_t windowStart = nowMicros();
+    while (true)
+    {
+        rc = mosquitto_loop(mosq, 100, 1);
+        if (rc != MOSQ_ERR_SUCCESS)
+        {
+            printf("[Emulator] Connection lost (%s), reconnecting...\n", mosquitto_strerror(rc));
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            mosquitto_reconnect(mosq);
+        }
+
+        int64_t now = nowMicros();
+        if (now - windowStart >= (int64_t)opt.reportSeconds * 1000000)
+        {
+            if (opt.show)
+            {
+                printf("\x1b[%d;1H\x1b[J", NUM_RIBS + 2);
+            }
+            printReport(emu, (now - windowStart) / 1e6);
+            emu.stats.clearWindow();
+            windowStart = now;
+        }
+    }
+
+    mosquitto_destroy(mosq);
+    mosquitto_lib_cleanup();
+    return 0;
+}
@@ -0,0 +1,263 @@
+// MQTT 5 帧连接的主机检查（不需要 broker）
+// 用 MQTT5_FRAME_TRANSPORT=1 把 MQTTManager / MQTT5Publisher / LuminaireGroup 原样编译到主机上（Arduino 部分见 tools/host）。
+// 环回连接的回复按 2 字节一段到达，MQTT5Publisher 必须跨 TCP 段收齐 CONNACK 才能连上。
+// 连上之后发送 FRAMES 帧（每帧一条伞灯帧 + 一条帧信息），解码写出的每个 PUBLISH 报文：
+//   - 每个主题第一次带完整主题和别名，之后主题为空、只带别名
+//   - 还原出的主题 / 内容与发送的一致（帧信息只比较序号，发送时间和帧数在发出时才填写）
+// 最后和同样的消息走 MQTT 3.1.1（PubSubClient，每条带完整主题）时的字节数比较。
+//
+// 编译和运行：
+//   make -C tools mqtt5_bytes   （make check 也会运行）
+
+#include "luminaire_group.h"
+#include "mqtt_manager.h"
+
+#include <string>
+#include <vector>
+
+#if !MQTT5_FRAME_TRANSPORT
+#error "mqtt5_bytes needs -DMQTT5_FRAME_TRANSPORT=1 (see tools/Makefile)"
+#endif
+
+static const int FRAMES = 100;
+static const unsigned long STEP_MS = 20;
+
+static std::vector<uint8_t> wire;  // 所有 WiFiClient 写出的字节
+static int legacyFrames = 0;       // 走了 PubSubClient 的伞灯帧 / 帧信息
+
+static void onWrite(const uint8_t *data, size_t size)
+{
+    wire.insert(wire.end(), data, data + size);
+}
+
+static void onLegacyPublish(const char *topic, const uint8_t *payload, unsigned int length, bool retained)
+{
+    if (strncmp(topic, LUMINAIRE_TOPIC_PREFIX, strlen(LUMINAIRE_TOPIC_PREFIX)) == 0 ||
+        strcmp(topic, TOPIC_INFO_LUMINAIRE_FRAME) == 0)
+    {
+        legacyFrames++;
+    }
+}
+
+// 变长整数占用的字节数
+static uint32_t lengthBytes(uint32_t length)
+{
+    uint32_t bytes = 1;
+    while (length >= 128)
+    {
+        length /= 128;
+        bytes++;
+    }
+    return bytes;
+}
+
+static bool readLength(const std::vector<uint8_t> &data, size_t &pos, uint32_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 28 && pos < data.size(); shift += 7)
+    {
+        uint8_t digit = data[pos++];
+        value |= (uint32_t)(digit & 0x7F) << shift;
+        if (!(digit & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+struct Message
+{
+    std::string topic;
+    std::vector<uint8_t> payload;
+    bool aliasOnly; // 只带别名（主题为空）
+};
+
+// 解码 wire 里的 PUBLISH 报文（其余报文跳过）；格式错误返回 false
+static bool decode(std::vector<Message> &messages, uint32_t &publishBytes)
+{
+    std::vector<std::string> aliases(HOST_TOPIC_ALIAS_MAX + 1);
+    size_t pos = 0;
+    publishBytes = 0;
+    while (pos < wire.size())
+    {
+        size_t start = pos;
+        uint8_t type = wire[pos++];
+        uint32_t remaining;
+        if (!readLength(wire, pos, remaining) || pos + remaining > wire.size())
+        {
+            printf("[MQTT5Bytes] ✗ Truncated packet at byte %zu\n", start);
+            return false;
+        }
+        size_t end = pos + remaining;
+        if ((type & 0xF0) != 0x30)
+        {
+            pos = end;
+            continue;
+        }
+
+        Message message;
+        uint16_t topicLength = (wire[pos] << 8) | wire[pos + 1];
+        pos += 2;
+        message.topic.assign((const char *)&wire[pos], topicLength);
+        pos += topicLength;
+
+        uint32_t propsLength;
+        if (!readLength(wire, pos, propsLength))
+        {
+            return false;
+        }
+        uint16_t alias = 0;
+        if (propsLength == 3 && wire[pos] == 0x23)
+        {
+            alias = (wire[pos + 1] << 8) | wire[pos + 2];
+        }
+        else if (propsLength != 0)
+        {
+            printf("[MQTT5Bytes] ✗ Unexpected properties in PUBLISH at byte %zu\n", start);
+            return false;
+        }
+        pos += propsLength;
+
+        if (alias > HOST_TOPIC_ALIAS_MAX)
+        {
+            printf("[MQTT5Bytes] ✗ Alias %u above the broker maximum %d\n", alias, HOST_TOPIC_ALIAS_MAX);
+            return false;
+        }
+        message.aliasOnly = topicLength == 0;
+        if (alias && topicLength > 0)
+        {
+            aliases[alias] = message.topic;
+        }
+        else if (alias)
+        {
+            if (aliases[alias].empty())
+            {
+                printf("[MQTT5Bytes] ✗ Alias %u used before it was set\n", alias);
+                return false;
+            }
+            message.topic = aliases[alias];
+        }
+        else if (topicLength == 0)
+        {
+            printf("[MQTT5Bytes] ✗ PUBLISH without topic or alias at byte %zu\n", start);
+            return false;
+        }
+
+        message.payload.assign(wire.begin() + pos, wire.begin() + end);
+        messages.push_back(message);
+        publishBytes += end - start;
+        pos = end;
+    }
+    return true;
+}
+
+static void fillCanvas(byte *canvas, int frame)
+{
+    for (int i = 0; i < LuminaireGroup::FRAME_SIZE; i++)
+    {
+        canvas[i] = (uint8_t)(frame * 7 + i);
+    }
+}
+
+static int fail(const char *reason)
+{
+    printf("[MQTT5Bytes] ✗ %s\n", reason);
+    return 1;
+}
+
+int main()
+{
+    static MQTTManager mqtt;
+    static LuminaireGroup units;
+    static byte canvas[UmbrellaCanvas::FRAME_SIZE];
+
+    hostSetWriteHook(onWrite);
+    hostSetPublishHook(onLegacyPublish);
+    hostSetSegmentSize(2);
+
+    mqtt.begin();
+    units.configure(PayloadSpan("16"));
+
+    // 主连接完成后 MQTT5Publisher 才开始连接；CONNACK 分 4 段到达
+    for (int i = 0; i < 200; i++)
+    {
+        hostAdvance(STEP_MS);
+        mqtt.loop();
+    }
+    if (!mqtt.isConnected())
+    {
+        return fail("MQTT state machine did not reach CONNECTED");
+    }
+
+    wire.clear();
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        fillCanvas(canvas, frame);
+        units.publish(&mqtt, canvas);
+        hostAdvance(STEP_MS);
+        mqtt.loop();
+    }
+
+    if (legacyFrames > 0)
+    {
+        printf("[MQTT5Bytes] ✗ %d frame message(s) went over MQTT 3.1.1: the MQTT 5 connection is not ready\n", legacyFrames);
+        return 1;
+    }
+
+    std::vector<Message> messages;
+    uint32_t publishBytes;
+    if (!decode(messages, publishBytes))
+    {
+        return 1;
+    }
+    if (messages.size() != (size_t)FRAMES * 2)
+    {
+        printf("[MQTT5Bytes] ✗ Decoded %zu PUBLISH packets, expected %d\n", messages.size(), FRAMES * 2);
+        return 1;
+    }
+
+    // 帧和帧信息交替出现；3.1.1 报文 = 固定头 + 剩余长度 + 主题 (2 + n) + 内容
+    uint32_t legacy = 0;
+    int aliasOnly = 0;
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        const Message &data = messages[frame * 2];
+        const Message &meta = messages[frame * 2 + 1];
+        fillCanvas(canvas, frame);
+        if (data.topic != LUMINAIRE_TOPIC_PREFIX "16" || data.payload.size() != LuminaireGroup::FRAME_SIZE ||
+            memcmp(data.payload.data(), canvas, LuminaireGroup::FRAME_SIZE) != 0)
+        {
+            printf("[MQTT5Bytes] ✗ Frame %d decoded to a different topic or payload\n", frame);
+            return 1;
+        }
+        if (meta.topic != TOPIC_INFO_LUMINAIRE_FRAME || meta.payload.size() != FRAME_META_SIZE ||
+            (meta.payload[0] | meta.payload[1] << 8) != frame || meta.payload[FRAME_META_UNITS_OFFSET] != 1)
+        {
+            printf("[MQTT5Bytes] ✗ Frame info %d decoded to a different topic, sequence or unit count\n", frame);
+            return 1;
+        }
+        for (const Message *message : {&data, &meta})
+        {
+            uint32_t remaining = 2 + message->topic.size() + message->payload.size();
+            legacy += 1 + lengthBytes(remaining) + remaining;
+            aliasOnly += message->aliasOnly;
+        }
+    }
+    if (aliasOnly != FRAMES * 2 - 2)
+    {
+        printf("[MQTT5Bytes] ✗ %d of %d packets used an alias only, expected all but the first per topic\n",
+               aliasOnly, FRAMES * 2);
+        return 1;
+    }
+
+    printf("[MQTT5Bytes] %d frames (%d B) + %d frame infos (%d B): MQTT 3.1.1 %u bytes, MQTT 5 %u bytes (%+.1f%%)\n",
+           FRAMES, LuminaireGroup::FRAME_SIZE, FRAMES, FRAME_META_SIZE, legacy, publishBytes,
+           100.0 * ((double)publishBytes - legacy) / legacy);
+    if (publishBytes >= legacy)
+    {
+        return fail("MQTT 5 did not save any bytes");
+    }
+    printf("[MQTT5Bytes] ✓ CONNACK read across TCP segments, %d PUBLISH packets decoded\n", FRAMES * 2);
+    return 0;
+}
@@ -0,0 +1,396 @@
+// MQTT 设备群重连模拟器（主机程序）
+// 模拟 N 台设备按固件的重连策略（mqtt_manager.h / reconnect_backoff.h）连接同一个 broker：
+// 断线后按 decorrelated jitter 退避重试，连上后用一个 SUBSCRIBE 报文订阅全部主题。
+// broker 重启时统计每秒的连接尝试次数（重连风暴的峰值）和每台设备从断线到重新订阅完成的时间。
+//
+// 编译（需要 libmosquitto 1.6+）：
+//   g++ -O2 -std=c++11 mqtt_fleet_sim.cpp -lmosquitto -o mqtt_fleet_sim
+// 运行（本地 mosquitto，每 60 秒重启一次）：
+//   ./mqtt_fleet_sim -n 100 --restart-cmd "sudo systemctl restart mosquitto" --restart-every 60
+// 对比旧的固定间隔重连：
+//   ./mqtt_fleet_sim -n 100 --fixed 5000 --restart-cmd "..." --restart-every 60
+//
+// 不带 --restart-cmd 时只监视连接，可以手动重启 broker。
+
+#include <mosquitto.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 与固件一致（mqtt_manager.h）
+static const int64_t BACKOFF_BASE_MS = 1000;
+static const int64_t BACKOFF_CAP_MS = 60000;
+static const int TOPICS_PER_DEVICE = 24;
+static const int HISTOGRAM_SECONDS = 30;
+
+struct Options
+{
+    std::string host = "localhost";
+    int port = 1883;
+    std::string username;
+    std::string password;
+    int devices = 50;
+    int64_t fixedMs = 0; // > 0 时改用固定间隔重连（旧固件行为）
+    std::string restartCmd;
+    int restartEvery = 0; // 秒
+};
+
+enum DeviceState
+{
+    DEVICE_WAITING,     // 等待下一次尝试
+    DEVICE_CONNECTING,  // TCP 已连上，等待 CONNACK
+    DEVICE_SUBSCRIBING, // 等待 SUBACK
+    DEVICE_READY
+};
+
+struct Device
+{
+    struct mosquitto *mosq = nullptr;
+    bool configured = false; // 是否已调用过 mosquitto_connect()（之后用 mosquitto_reconnect()）
+    DeviceState state = DEVICE_WAITING;
+    int64_t nextAttempt = 0; // ms
+    int64_t outageStart = 0; // ms
+    int64_t previousDelay = BACKOFF_BASE_MS;
+    uint32_t rng = 0;
+    int attempts = 0; // 本次断线期间的尝试次数
+    std::vector<std::string> topics;
+};
+
+struct Fleet
+{
+    Options options;
+    std::vector<Device> devices;
+
+    // 当前一轮恢复的统计（所有设备重新订阅后输出并清零）
+    bool recovering = false;
+    int64_t outageStart = 0;
+    std::vector<int> attemptsPerSecond; // 相对 outageStart
+    std::vector<int64_t> resubscribe;   // 每台设备从断线到 SUBACK（ms）
+    std::vector<int> attempts;
+};
+
+static int64_t nowMillis()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t percentile(std::vector<int64_t> values, int pct)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = (values.size() - 1) * pct / 100;
+    return values[index];
+}
+
+// 与 ReconnectBackoff::next() 相同
+static int64_t nextDelay(Fleet &fleet, Device &dev)
+{
+    if (fleet.options.fixedMs > 0)
+    {
+        return fleet.options.fixedMs;
+    }
+
+    int64_t upper = std::min(BACKOFF_CAP_MS, dev.previousDelay * 3);
+    int64_t delay = BACKOFF_BASE_MS;
+    if (upper > BACKOFF_BASE_MS)
+    {
+        dev.rng ^= dev.rng << 13;
+        dev.rng ^= dev.rng >> 17;
+        dev.rng ^= dev.rng << 5;
+        delay += dev.rng % (upper - BACKOFF_BASE_MS);
+    }
+    dev.previousDelay = delay;
+    return delay;
+}
+
+static void startOutage(Fleet &fleet, int64_t now)
+{
+    if (fleet.recovering)
+    {
+        return;
+    }
+    fleet.recovering = true;
+    fleet.outageStart = now;
+    fleet.attemptsPerSecond.assign(HISTOGRAM_SECONDS, 0);
+    fleet.resubscribe.clear();
+    fleet.attempts.clear();
+    printf("[FleetSim] Outage detected\n");
+}
+
+static void lost(Fleet &fleet, Device &dev, int64_t now)
+{
+    startOutage(fleet, now);
+    if (dev.state == DEVICE_READY)
+    {
+        dev.outageStart = now;
+        dev.attempts = 0;
+    }
+    dev.state = DEVICE_WAITING;
+    dev.nextAttempt = now + nextDelay(fleet, dev);
+}
+
+static void onConnect(struct mosquitto *mosq, void *userdata, int rc)
+{
+    Device *dev = (Device *)userdata;
+    if (rc != 0)
+    {
+        return; // mosquitto_loop() 随后返回错误，按断线处理
+    }
+
+    // 一个 SUBSCRIBE 报文携带全部主题
+    std::vector<char *> filters;
+    for (std::string &topic : dev->topics)
+    {
+        filters.push_back(&topic[0]);
+    }
+    mosquitto_subscribe_multiple(mosq, nullptr, (int)filters.size(), filters.data(), 0, 0, nullptr);
+    dev->state = DEVICE_SUBSCRIBING;
+}
+
+static Fleet *fleetInstance = nullptr; // 订阅回调里需要全局统计
+
+static void onSubscribe(struct mosquitto *, void *userdata, int, int, const int *)
+{
+    Device *dev = (Device *)userdata;
+    Fleet &fleet = *fleetInstance;
+    int64_t now = nowMillis();
+
+    if (dev->state != DEVICE_SUBSCRIBING)
+    {
+        return;
+    }
+    dev->state = DEVICE_READY;
+    dev->previousDelay = BACKOFF_BASE_MS;
+    if (fleet.recovering)
+    {
+        fleet.resubscribe.push_back(now - dev->outageStart);
+        fleet.attempts.push_back(dev->attempts);
+    }
+}
+
+static void attempt(Fleet &fleet, Device &dev, int64_t now)
+{
+    dev.attempts++;
+    if (fleet.recovering)
+    {
+        int64_t second = (now - fleet.outageStart) / 1000;
+        if (second < HISTOGRAM_SECONDS)
+        {
+            fleet.attemptsPerSecond[second]++;
+        }
+    }
+
+    // mosquitto_connect() 失败也会保存 broker 参数，之后都用 reconnect
+    const Options &opt = fleet.options;
+    int rc = dev.configured ? mosquitto_reconnect(dev.mosq) : mosquitto_connect(dev.mosq, opt.host.c_str(), opt.port, 30);
+    dev.configured = true;
+    if (rc == MOSQ_ERR_SUCCESS)
+    {
+        dev.state = DEVICE_CONNECTING;
+    }
+    else
+    {
+        dev.nextAttempt = now + nextDelay(fleet, dev);
+    }
+}
+
+static void printRecovery(Fleet &fleet)
+{
+    int peak = 0;
+    int total = 0;
+    for (int count : fleet.attemptsPerSecond)
+    {
+        peak = std::max(peak, count);
+        total += count;
+    }
+
+    std::vector<int64_t> attempts(fleet.attempts.begin(), fleet.attempts.end());
+    printf("[FleetSim] ✓ %zu/%zu devices resubscribed\n", fleet.resubscribe.size(), fleet.devices.size());
+    printf("[FleetSim]   resubscribe p50 %6.2f  p95 %6.2f  max %6.2f s\n",
+           percentile(fleet.resubscribe, 50) / 1000.0, percentile(fleet.resubscribe, 95) / 1000.0,
+           percentile(fleet.resubscribe, 100) / 1000.0);
+    printf("[FleetSim]   attempts per device p50 %lld  max %lld, peak %d connects/s\n",
+           (long long)percentile(attempts, 50), (long long)percentile(attempts, 100), peak);
+
+    // 每秒连接尝试次数（柱状图）
+    int last = HISTOGRAM_SECONDS - 1;
+    while (last > 0 && fleet.attemptsPerSecond[last] == 0)
+    {
+        last--;
+    }
+    for (int s = 0; s <= last; s++)
+    {
+        int count = fleet.attemptsPerSecond[s];
+        int bar = peak > 0 ? count * 50 / peak : 0;
+        printf("[FleetSim]   %2ds %4d %s\n", s, count, std::string(bar, '#').c_str());
+    }
+    if (total == 0)
+    {
+        printf("[FleetSim]   no reconnect attempts recorded\n");
+    }
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n", name);
+    printf("  -h <host>              broker host (default localhost)\n");
+    printf("  -p <port>              broker port (default 1883)\n");
+    printf("  -u <user>              broker username\n");
+    printf("  -P <password>          broker password\n");
+    printf("  -n <devices>           number of simulated devices (default 50)\n");
+    printf("  --fixed <ms>           fixed reconnect interval instead of jittered backoff\n");
+    printf("  --restart-cmd <cmd>    shell command that restarts the broker\n");
+    printf("  --restart-every <s>    run --restart-cmd every <s> seconds once the fleet is connected\n");
+}
+
+int main(int argc, char **argv)
+{
+    Fleet fleet;
+    Options &opt = fleet.options;
+    fleetInstance = &fleet;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-h" && hasValue)
+            opt.host = argv[++i];
+        else if (arg == "-p" && hasValue)
+            opt.port = atoi(argv[++i]);
+        else if (arg == "-u" && hasValue)
+            opt.username = argv[++i];
+        else if (arg == "-P" && hasValue)
+            opt.password = argv[++i];
+        else if (arg == "-n" && hasValue)
+            opt.devices = std::max(1, atoi(argv[++i]));
+        else if (arg == "--fixed" && hasValue)
+            opt.fixedMs = atoi(argv[++i]);
+        else if (arg == "--restart-cmd" && hasValue)
+            opt.restartCmd = argv[++i];
+        else if (arg == "--restart-every" && hasValue)
+            opt.restartEvery = atoi(argv[++i]);
+        else
+        {
+            usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    mosquitto_lib_init();
+
+    fleet.devices.resize(opt.devices);
+    int64_t now = nowMillis();
+    for (int i = 0; i < opt.devices; i++)
+    {
+        Device &dev = fleet.devices[i];
+        char id[32];
+        snprintf(id, sizeof(id), "AuraSim_%04d", i);
+
+        dev.rng = 0x9E3779B9u ^ (uint32_t)(i * 2654435761u) ^ (uint32_t)now;
+        dev.outageStart = now;
+        dev.nextAttempt = now + i * 10; // 启动时错开，避免第一轮就成为风暴
+        for (int t = 0; t < TOPICS_PER_DEVICE; t++)
+        {
+            char topic[64];
+            snprintf(topic, sizeof(topic), "fleet-sim/%s/topic%02d", id, t);
+            dev.topics.push_back(topic);
+        }
+
+        dev.mosq = mosquitto_new(id, true, &dev);
+        if (!dev.mosq)
+        {
+            printf("[FleetSim] ✗ Out of memory\n");
+            return 1;
+        }
+        if (!opt.username.empty())
+        {
+            mosquitto_username_pw_set(dev.mosq, opt.username.c_str(), opt.password.empty() ? nullptr : opt.password.c_str());
+        }
+        mosquitto_connect_callback_set(dev.mosq, onConnect);
+        mosquitto_subscribe_callback_set(dev.mosq, onSubscribe);
+    }
+
+    printf("[FleetSim] %d devices, %s reconnect, broker %s:%d\n", opt.devices,
+           opt.fixedMs > 0 ? "fixed interval" : "jittered backoff", opt.host.c_str(), opt.port);
+
+    int64_t lastRestart = 0;
+    bool allReady = false;
+    while (true)
+    {
+        now = nowMillis();
+        int ready = 0;
+
+        for (Device &dev : fleet.devices)
+        {
+            if (dev.state == DEVICE_WAITING)
+            {
+                if (now >= dev.nextAttempt)
+                {
+                    attempt(fleet, dev, now);
+                }
+                continue;
+            }
+
+            int rc = mosquitto_loop(dev.mosq, 0, 1);
+            if (rc != MOSQ_ERR_SUCCESS)
+            {
+                lost(fleet, dev, now);
+            }
+            else if (dev.state == DEVICE_READY)
+            {
+                ready++;
+            }
+        }
+
+        if (ready == opt.devices && !allReady)
+        {
+            allReady = true;
+            lastRestart = now;
+            if (fleet.recovering)
+            {
+                printRecovery(fleet);
+                fleet.recovering = false;
+            }
+            else
+            {
+                printf("[FleetSim] ✓ All %d devices connected\n", opt.devices);
+            }
+        }
+        else if (ready < opt.devices)
+        {
+            allReady = false;
+        }
+
+        if (allReady && !opt.restartCmd.empty() && opt.restartEvery > 0 &&
+            now - lastRestart >= (int64_t)opt.restartEvery * 1000)
+        {
+            printf("[FleetSim] Restarting broker: %s\n", opt.restartCmd.c_str());
+            startOutage(fleet, nowMillis());
+            if (system(opt.restartCmd.c_str()) != 0)
+            {
+                printf("[FleetSim] ✗ Restart command failed\n");
+            }
+            lastRestart = nowMillis();
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (Device &dev : fleet.devices)
+    {
+        mosquitto_destroy(dev.mosq);
+    }
+    mosquitto_lib_cleanup();
+    return 0;
+}
@@ -0,0 +1,489 @@
+// 伞灯渲染的主机测试（不需要硬件和 broker）
+// 把固件的 LuminaireController / WeatherAnimation / MQTTManager 原样编译到主机上（Arduino 部分见 tools/host），
+// 用 RenderClock 的虚拟时间按固定步长推进，抓取每一帧实际发往伞灯的数据：
+//   --write  生成 golden 帧（tools/golden/<场景>.ppm，每行一个抓取的帧，每把伞灯 72 像素宽）
+//   --check  与 golden 帧逐字节比较，任何差异都报告并返回 1
+// 同时记录每一步 luminaire.loop() 的耗时（渲染 + 输出级 + 入队，主机上的数值，只用于比较修改前后的变化）。
+//
+// 编译和运行：
+//   make -C tools check
+// 修改了渲染效果之后重新生成：
+//   make -C tools golden
+//
+// 每个场景在单独的子进程里运行，固件里的静态变量（限速计时器等）不会在场景之间传递。
+
+#include "audio_analyzer.h"
+#include "frame_dump.h"
+#include "luminaire_controller.h"
+#include "mqtt_manager.h"
+#include "music_mode.h"
+#include "render_clock.h"
+#include "weather_animation.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+static const char *LUMINAIRE_ID = "16";
+static const unsigned long STEP_MS = 20;     // 主循环步长（50 fps）
+static const unsigned long CAPTURE_MS = 100; // 每隔多久抓取一帧写入 golden
+static const int FRAME_SIZE = Umbrella::FRAME_SIZE;
+
+struct Scene
+{
+    const char *name;
+    const char *mode;
+    const char *weather; // 天气 JSON（nullptr = 不更新）
+    unsigned long durationMs;
+    const char *units; // 伞灯组配置（/luminaire/units 格式，nullptr = 只有 LUMINAIRE_ID 一把）
+};
+
+// 天气场景各跑 10 秒：前 5 秒是六环静态可视化，后 5 秒是天气动画
+// 数值字段一半用字符串（wttr.in 格式），一半用 JSON 数字，两种解析路径都覆盖
+static const Scene SCENES[] = {
+    {"idle", "idle", nullptr, 6000},
+    {"music", "music", nullptr, 4000},
+    {"sunny", "weather",
+     "{\"temp_C\":\"24\",\"FeelsLikeC\":\"27\",\"humidity\":\"35\",\"windspeedKmph\":\"8\",\"winddir16Point\":\"S\","
+     "\"visibility\":\"10\",\"cloudcover\":\"0\",\"precipMM\":\"0.0\",\"weatherCode\":\"113\",\"weatherDesc\":\"Sunny\"}",
+     10000},
+    {"cloudy", "weather",
+     "{\"temp_C\":14,\"FeelsLikeC\":12,\"humidity\":70,\"windspeedKmph\":22,\"winddir16Point\":\"WSW\","
+     "\"visibility\":10,\"cloudcover\":75,\"precipMM\":0.0,\"weatherCode\":116,\"weatherDesc\":\"Partly cloudy\"}",
+     10000},
+    {"rain", "weather",
+     "{\"temp_C\":\"9\",\"FeelsLikeC\":\"6\",\"humidity\":\"93\",\"windspeedKmph\":\"30\",\"winddir16Point\":\"SW\","
+     "\"visibility\":\"6\",\"cloudcover\":\"100\",\"precipMM\":\"2.4\",\"weatherCode\":\"296\",\"weatherDesc\":\"Light rain\"}",
+     10000},
+    {"snow", "weather",
+     "{\"temp_C\":-3,\"FeelsLikeC\":-8,\"humidity\":88,\"windspeedKmph\":12,\"winddir16Point\":\"N\","
+     "\"visibility\":4,\"cloudcover\":100,\"precipMM\":1.2,\"weatherCode\":338,\"weatherDesc\":\"Heavy snow\"}",
+     10000},
+    {"thunderstorm", "weather",
+     "{\"temp_C\":\"21\",\"FeelsLikeC\":\"23\",\"humidity\":\"85\",\"windspeedKmph\":\"41\",\"winddir16Point\":\"E\","
+     "\"visibility\":\"5\",\"cloudcover\":\"100\",\"precipMM\":\"6.8\",\"weatherCode\":\"389\",\"weatherDesc\":\"Thunder\"}",
+     10000},
+    {"fog", "weather",
+     "{\"temp_C\":6,\"FeelsLikeC\":4,\"humidity\":98,\"windspeedKmph\":3,\"winddir16Point\":\"NNE\","
+     "\"visibility\":1,\"cloudcover\":60,\"precipMM\":0,\"weatherCode\":248,\"weatherDesc\":\"Fog\"}",
+     10000},
+    // 三把伞共用 36 条伞骨的画布：风速光点依次经过每把伞，第二把旋转 3 条伞骨，第三把镜像
+    {"rain_units", "weather",
+     "{\"temp_C\":\"9\",\"FeelsLikeC\":\"6\",\"humidity\":\"93\",\"windspeedKmph\":\"30\",\"winddir16Point\":\"SW\","
+     "\"visibility\":\"6\",\"cloudcover\":\"100\",\"precipMM\":\"2.4\",\"weatherCode\":\"296\",\"weatherDesc\":\"Light rain\"}",
+     10000, "16,17:3,18m"},
+};
+static const int SCENE_COUNT = sizeof(SCENES) / sizeof(SCENES[0]);
+
+enum RunMode
+{
+    RUN_CHECK,
+    RUN_WRITE,
+    RUN_TIMES_ONLY
+};
+
+struct Options
+{
+    RunMode mode = RUN_CHECK;
+    std::string goldenDir = "golden";
+    std::string timesPath;  // 每帧渲染耗时 CSV（为空不写）
+    std::string polarDir;   // 抓取的帧另存为极坐标 PPM（为空不写）
+    bool recorder = false;  // 整个场景打开帧录制，最后报告录制的帧数和占用字节
+    std::vector<std::string> scenes;
+};
+
+// 固件对象（与 Aura_Light.ino 相同的组合）
+static MQTTManager mqtt;
+static LuminaireController luminaire;
+static WeatherAnimation weatherAnim;
+static MusicMode musicMode;
+static AudioAnalyzer audioAnalyzer;
+
+static uint8_t lastFrame[LUMINAIRE_MAX_UNITS * FRAME_SIZE]; // 最近一次发往每把伞灯的帧（按配置顺序）
+static char frameTopics[LUMINAIRE_MAX_UNITS][64];
+static int unitCount;
+static unsigned recorderFrames, recorderBytes; // 最近一次 info/recorder 状态
+
+static void onPublish(const char *topic, const uint8_t *payload, unsigned int length, bool retained)
+{
+    for (int unit = 0; unit < unitCount && length == FRAME_SIZE; unit++)
+    {
+        if (strcmp(topic, frameTopics[unit]) == 0)
+        {
+            memcpy(lastFrame + unit * FRAME_SIZE, payload, FRAME_SIZE);
+        }
+    }
+    if (strcmp(topic, TOPIC_BASE "/info/recorder") == 0)
+    {
+        std::string status((const char *)payload, length);
+        sscanf(status.c_str(), "{\"state\":\"%*[a-z]\",\"frames\":%u,\"bytes\":%u}", &recorderFrames, &recorderBytes);
+    }
+}
+
+// 从伞灯组配置里取出每把伞的主题（ID 到 '@' / ':' / 'm' 为止）
+static void setFrameTopics(const char *units)
+{
+    unitCount = 0;
+    while (*units && unitCount < LUMINAIRE_MAX_UNITS)
+    {
+        size_t idLength = strcspn(units, "@:m,");
+        snprintf(frameTopics[unitCount++], sizeof(frameTopics[0]), "%s%.*s", LUMINAIRE_TOPIC_PREFIX, (int)idLength, units);
+        units += strcspn(units, ",");
+        units += *units == ',';
+    }
+}
+
+// FrameDump 输出到文件
+class FilePrint : public Print
+{
+private:
+    FILE *file;
+
+public:
+    FilePrint(FILE *f) : file(f) {}
+    size_t write(uint8_t c) override { return fputc(c, file) == EOF ? 0 : 1; }
+    size_t write(const uint8_t *data, size_t size) override { return fwrite(data, 1, size, file); }
+    using Print::write;
+};
+
+static std::string goldenPath(const Options &opt, const Scene &scene)
+{
+    return opt.goldenDir + "/" + scene.name + ".ppm";
+}
+
+// golden 帧：二进制 PPM (P6)，宽 = 伞灯数 × LED 数，每行是一个抓取的帧（每把伞按 LED 编号排列，依次拼接）
+static bool writeGolden(const std::string &path, const std::vector<uint8_t> &frames)
+{
+    const int rowSize = unitCount * FRAME_SIZE;
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        printf("[RenderHost] ✗ Cannot write %s\n", path.c_str());
+        return false;
+    }
+    fprintf(file, "P6\n%d %zu\n255\n", unitCount * Umbrella::NUM_LEDS, frames.size() / rowSize);
+    fwrite(frames.data(), 1, frames.size(), file);
+    fclose(file);
+    return true;
+}
+
+static bool readGolden(const std::string &path, std::vector<uint8_t> &frames)
+{
+    const int rowSize = unitCount * FRAME_SIZE;
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        printf("[RenderHost] ✗ Missing golden %s (run make -C tools golden)\n", path.c_str());
+        return false;
+    }
+    int width = 0, rows = 0, maxValue = 0;
+    bool ok = fscanf(file, "P6 %d %d %d", &width, &rows, &maxValue) == 3 && fgetc(file) != EOF &&
+              width == unitCount * Umbrella::NUM_LEDS && maxValue == 255;
+    if (ok)
+    {
+        frames.resize((size_t)rows * rowSize);
+        ok = fread(frames.data(), 1, frames.size(), file) == frames.size();
+    }
+    fclose(file);
+    if (!ok)
+    {
+        printf("[RenderHost] ✗ Bad golden %s\n", path.c_str());
+    }
+    return ok;
+}
+
+// 逐帧比较；报告每个不同的帧里第一个不同的 LED（最多 10 帧）
+static bool compareFrames(const Scene &scene, const std::vector<uint8_t> &expected, const std::vector<uint8_t> &actual)
+{
+    const size_t rowSize = unitCount * FRAME_SIZE;
+    if (expected.size() != actual.size())
+    {
+        printf("[RenderHost] ✗ %s: golden has %zu frames, rendered %zu\n",
+               scene.name, expected.size() / rowSize, actual.size() / rowSize);
+        return false;
+    }
+
+    int badFrames = 0;
+    for (size_t frame = 0; frame < actual.size() / rowSize; frame++)
+    {
+        const uint8_t *e = expected.data() + frame * rowSize;
+        const uint8_t *a = actual.data() + frame * rowSize;
+        if (memcmp(e, a, rowSize) == 0)
+        {
+            continue;
+        }
+        if (++badFrames > 10)
+        {
+            continue;
+        }
+        int led = 0;
+        while (memcmp(e + led * 3, a + led * 3, 3) == 0)
+        {
+            led++;
+        }
+        int unitLed = led % Umbrella::NUM_LEDS;
+        printf("[RenderHost] ✗ %s frame %zu (t=%lu ms) unit %d LED %d (rib %d, pos %d): expected #%02X%02X%02X, got #%02X%02X%02X\n",
+               scene.name, frame, (frame + 1) * CAPTURE_MS, led / Umbrella::NUM_LEDS, unitLed,
+               unitLed / Umbrella::NUM_POSITIONS, unitLed % Umbrella::NUM_POSITIONS,
+               e[led * 3], e[led * 3 + 1], e[led * 3 + 2], a[led * 3], a[led * 3 + 1], a[led * 3 + 2]);
+    }
+    if (badFrames > 0)
+    {
+        printf("[RenderHost] ✗ %s: %d of %zu frames differ\n", scene.name, badFrames, actual.size() / rowSize);
+    }
+    return badFrames == 0;
+}
+
+static void printTimes(std::vector<double> times)
+{
+    if (times.empty())
+    {
+        return;
+    }
+    double sum = 0;
+    for (double t : times)
+    {
+        sum += t;
+    }
+    std::sort(times.begin(), times.end());
+    printf("[RenderHost]   loop() us: mean %.2f, p50 %.2f, p99 %.2f, max %.2f (%zu steps)\n",
+           sum / times.size(), times[times.size() / 2], times[times.size() * 99 / 100], times.back(), times.size());
+}
+
+static void connectMqtt()
+{
+    mqtt.begin();
+    for (int i = 0; i < 1000 && !mqtt.isConnected(); i++)
+    {
+        mqtt.loop();
+        hostAdvance(10);
+    }
+    if (!mqtt.isConnected())
+    {
+        printf("[RenderHost] ✗ MQTT state machine did not reach CONNECTED\n");
+        exit(2);
+    }
+}
+
+// 在子进程里运行一个场景；返回进程退出码
+static int runScene(const Options &opt, const Scene &scene)
+{
+    randomSeed(1);
+    hostSetMillis(0);
+    setFrameTopics(scene.units ? scene.units : LUMINAIRE_ID);
+    hostSetPublishHook(onPublish);
+
+    connectMqtt();
+
+    luminaire.begin(&mqtt, LUMINAIRE_ID);
+    musicMode.begin(&audioAnalyzer);
+    luminaire.setMusicMode(&musicMode, &audioAnalyzer);
+    weatherAnim.begin(&luminaire);
+    luminaire.setWeatherAnimation(&weatherAnim);
+    luminaire.setActive(true);
+    if (scene.units)
+    {
+        luminaire.handleUnitsCommand(PayloadSpan(scene.units));
+    }
+
+    // 从这里开始渲染时间只由下面的循环推进
+    renderClock.freeze();
+
+    if (scene.weather)
+    {
+        luminaire.updateWeatherData(PayloadSpan(scene.weather));
+    }
+    luminaire.handleMode((const byte *)scene.mode, strlen(scene.mode));
+    luminaire.handleStatus((const byte *)"on", 2);
+    if (opt.recorder)
+    {
+        luminaire.handleRecorderCommand(PayloadSpan("start"));
+    }
+    mqtt.loop();
+
+    std::vector<uint8_t> frames;
+    std::vector<double> times;
+    FILE *timesFile = opt.timesPath.empty() ? nullptr : fopen(opt.timesPath.c_str(), "a");
+
+    for (unsigned long t = STEP_MS; t <= scene.durationMs; t += STEP_MS)
+    {
+        hostAdvance(STEP_MS);
+        renderClock.advance(STEP_MS);
+
+        audioAnalyzer.loop();
+        auto start = std::chrono::steady_clock::now();
+        luminaire.loop();
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        mqtt.loop();
+
+        times.push_back(micros);
+        if (timesFile)
+        {
+            fprintf(timesFile, "%s,%lu,%.3f\n", scene.name, t, micros);
+        }
+
+        if (t % CAPTURE_MS == 0)
+        {
+            frames.insert(frames.end(), lastFrame, lastFrame + unitCount * FRAME_SIZE);
+
+            for (int unit = 0; unit < unitCount && !opt.polarDir.empty(); unit++)
+            {
+                char path[256];
+                if (unitCount > 1)
+                {
+                    snprintf(path, sizeof(path), "%s/%s_%d_%05lu.ppm", opt.polarDir.c_str(), scene.name, unit, t);
+                }
+                else
+                {
+                    snprintf(path, sizeof(path), "%s/%s_%05lu.ppm", opt.polarDir.c_str(), scene.name, t);
+                }
+                FILE *file = fopen(path, "w");
+                if (file)
+                {
+                    FilePrint out(file);
+                    FrameDump::writePolar(out, lastFrame + unit * FRAME_SIZE);
+                    fclose(file);
+                }
+            }
+        }
+    }
+    if (timesFile)
+    {
+        fclose(timesFile);
+    }
+    if (opt.recorder)
+    {
+        // 状态经 info 队列发出（限速），多跑几次 loop
+        luminaire.handleRecorderCommand(PayloadSpan("status"));
+        for (int i = 0; i < 10; i++)
+        {
+            hostAdvance(STEP_MS);
+            mqtt.loop();
+        }
+    }
+
+    bool ok = true;
+    if (opt.mode == RUN_WRITE)
+    {
+        ok = writeGolden(goldenPath(opt, scene), frames);
+        printf("[RenderHost] %s %s: %zu frames\n", ok ? "✓" : "✗", scene.name, frames.size() / (unitCount * FRAME_SIZE));
+    }
+    else if (opt.mode == RUN_CHECK)
+    {
+        std::vector<uint8_t> expected;
+        ok = readGolden(goldenPath(opt, scene), expected) && compareFrames(scene, expected, frames);
+        printf("[RenderHost] %s %s: %zu frames\n", ok ? "✓" : "✗", scene.name, frames.size() / (unitCount * FRAME_SIZE));
+    }
+    else
+    {
+        printf("[RenderHost] %s\n", scene.name);
+    }
+    printTimes(times);
+    if (opt.recorder)
+    {
+        printf("[RenderHost]   recorder: %u frames in %u bytes (%.1f frames/KB, ring %d bytes)\n",
+               recorderFrames, recorderBytes, recorderBytes ? recorderFrames * 1024.0 / recorderBytes : 0.0, RECORDER_BUFFER_SIZE);
+    }
+    fflush(stdout);
+    return ok ? 0 : 1;
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options] [scene...]\n", name);
+    printf("  --check              compare rendered frames with the golden files (default)\n");
+    printf("  --write              regenerate the golden files\n");
+    printf("  --times-only         only report render times\n");
+    printf("  --golden <dir>       golden directory (default golden)\n");
+    printf("  --times <csv>        append per-frame render times (scene,t_ms,render_us)\n");
+    printf("  --polar <dir>        also write every captured frame as a polar PPM\n");
+    printf("  --recorder           record each scene with the frame recorder and report frames per KB\n");
+    printf("Scenes:");
+    for (int i = 0; i < SCENE_COUNT; i++)
+    {
+        printf(" %s", SCENES[i].name);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--check")
+            opt.mode = RUN_CHECK;
+        else if (arg == "--write")
+            opt.mode = RUN_WRITE;
+        else if (arg == "--times-only")
+            opt.mode = RUN_TIMES_ONLY;
+        else if (arg == "--golden" && hasValue)
+            opt.goldenDir = argv[++i];
+        else if (arg == "--times" && hasValue)
+            opt.timesPath = argv[++i];
+        else if (arg == "--polar" && hasValue)
+            opt.polarDir = argv[++i];
+        else if (arg == "--recorder")
+            opt.recorder = true;
+        else if (arg[0] != '-')
+            opt.scenes.push_back(arg);
+        else
+        {
+            usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (!opt.timesPath.empty())
+    {
+        FILE *file = fopen(opt.timesPath.c_str(), "w");
+        if (file)
+        {
+            fprintf(file, "scene,t_ms,render_us\n");
+            fclose(file);
+        }
+    }
+
+    int failed = 0, run = 0;
+    for (int i = 0; i < SCENE_COUNT; i++)
+    {
+        const Scene &scene = SCENES[i];
+        if (!opt.scenes.empty() && std::find(opt.scenes.begin(), opt.scenes.end(), scene.name) == opt.scenes.end())
+        {
+            continue;
+        }
+        run++;
+
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            _exit(runScene(opt, scene));
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            if (!WIFEXITED(status))
+            {
+                printf("[RenderHost] ✗ %s crashed\n", scene.name);
+            }
+            failed++;
+        }
+    }
+
+    if (run == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    printf("[RenderHost] %s %d/%d scenes passed\n", failed ? "✗" : "✓", run - failed, run);
+    return failed ? 1 : 0;
+}
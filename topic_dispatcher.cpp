@@ -0,0 +1,108 @@
+#include "topic_dispatcher.h"
+
+static const uint32_t FNV_PRIME = 16777619UL;
+
+TopicDispatcher::TopicDispatcher()
+    : base(""),
+      baseLength(0),
+      routeCount(0)
+{
+    memset(table, EMPTY, sizeof(table));
+}
+
+void TopicDispatcher::begin(const char *baseTopic)
+{
+    base = baseTopic;
+    baseLength = strlen(baseTopic);
+}
+
+uint32_t TopicDispatcher::hash(const char *text, uint32_t seed)
+{
+    uint32_t h = seed;
+    while (*text)
+    {
+        h ^= (uint8_t)*text++;
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+bool TopicDispatcher::matches(const Route &route, const char *topic) const
+{
+    if (strncmp(topic, base, baseLength) != 0 || topic[baseLength] != '/')
+    {
+        return false;
+    }
+    topic += baseLength + 1;
+
+    size_t pathLength = strlen(route.path);
+    if (strncmp(topic, route.path, pathLength) != 0)
+    {
+        return false;
+    }
+    return strcmp(topic + pathLength, route.leaf ? route.leaf : "") == 0;
+}
+
+bool TopicDispatcher::add(const char *path, TopicHandler handler, uint8_t arg, const char *leaf)
+{
+    if (routeCount >= DISPATCH_MAX_ROUTES)
+    {
+        Serial.print("[MQTT] ✗ Too many topic handlers, ignoring: ");
+        Serial.println(path);
+        return false;
+    }
+
+    uint32_t h = hash(path, hash("/", hash(base)));
+    if (leaf)
+    {
+        h = hash(leaf, h);
+    }
+
+    uint8_t slot = h & (DISPATCH_TABLE_SIZE - 1);
+    while (table[slot] != EMPTY)
+    {
+        const Route &existing = routes[table[slot]];
+        if (existing.hash == h && strcmp(existing.path, path) == 0 &&
+            strcmp(existing.leaf ? existing.leaf : "", leaf ? leaf : "") == 0)
+        {
+            Serial.print("[MQTT] ✗ Topic handler already registered: ");
+            Serial.println(path);
+            return false;
+        }
+        slot = (slot + 1) & (DISPATCH_TABLE_SIZE - 1);
+    }
+
+    Route &route = routes[routeCount];
+    route.hash = h;
+    route.path = path;
+    route.leaf = leaf;
+    route.handler = handler;
+    route.arg = arg;
+    table[slot] = routeCount++;
+    return true;
+}
+
+bool TopicDispatcher::dispatch(const char *topic, const byte *payload, unsigned int length) const
+{
+    uint32_t h = hash(topic);
+
+    uint8_t slot = h & (DISPATCH_TABLE_SIZE - 1);
+    while (table[slot] != EMPTY)
+    {
+        const Route &route = routes[table[slot]];
+        if (route.hash == h && matches(route, topic))
+        {
+            route.handler(payload, length, route.arg);
+            return true;
+        }
+        slot = (slot + 1) & (DISPATCH_TABLE_SIZE - 1);
+    }
+    return false;
+}
+
+size_t TopicDispatcher::routeTopic(uint8_t index, char *buffer, size_t size) const
+{
+    const Route &route = routes[index];
+    int written = snprintf(buffer, size, "%s/%s%s", base, route.path, route.leaf ? route.leaf : "");
+    return (written > 0 && (size_t)written < size) ? written : 0;
+}
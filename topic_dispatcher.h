@@ -0,0 +1,59 @@
+#ifndef TOPIC_DISPATCHER_H
+#define TOPIC_DISPATCHER_H
+
+#include <Arduino.h>
+
+#define DISPATCH_MAX_ROUTES 32 // 最多注册的主题数
+#define DISPATCH_TABLE_SIZE 64 // 哈希表大小（2 的幂，至少为路由数的 2 倍）
+
+// 主题处理函数：arg 为注册时给定的参数（例如调色板用途）
+typedef void (*TopicHandler)(const byte *payload, unsigned int length, uint8_t arg);
+
+// 主题分发表
+// 主题 = base + "/" + path [+ leaf]，path / leaf 必须是常量字符串（只保存指针）。
+// 注册时计算 FNV-1a 哈希放进开放寻址表；收到消息时对主题算一次哈希、
+// 再逐字节确认一次，不构造 String，也不分配堆内存。
+class TopicDispatcher
+{
+private:
+    struct Route
+    {
+        uint32_t hash;
+        const char *path;
+        const char *leaf;
+        TopicHandler handler;
+        uint8_t arg;
+    };
+
+    const char *base;
+    uint8_t baseLength;
+
+    Route routes[DISPATCH_MAX_ROUTES];
+    uint8_t routeCount;
+    uint8_t table[DISPATCH_TABLE_SIZE]; // 路由下标，EMPTY = 空
+
+    static const uint8_t EMPTY = 0xFF;
+
+    bool matches(const Route &route, const char *topic) const;
+
+public:
+    TopicDispatcher();
+
+    void begin(const char *baseTopic);
+
+    // 注册主题（重复注册或表满返回 false）
+    bool add(const char *path, TopicHandler handler, uint8_t arg = 0, const char *leaf = nullptr);
+
+    // 分发消息，找不到处理函数返回 false
+    bool dispatch(const char *topic, const byte *payload, unsigned int length) const;
+
+    // 已注册主题（用于订阅）：写入 base/path[leaf]，返回长度；buffer 不够时返回 0
+    uint8_t getRouteCount() const { return routeCount; }
+    size_t routeTopic(uint8_t index, char *buffer, size_t size) const;
+
+    // FNV-1a（32 位），可以分段连续计算
+    static const uint32_t FNV_OFFSET = 2166136261UL;
+    static uint32_t hash(const char *text, uint32_t seed = FNV_OFFSET);
+};
+
+#endif
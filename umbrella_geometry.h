@@ -0,0 +1,127 @@
+#ifndef UMBRELLA_GEOMETRY_H
+#define UMBRELLA_GEOMETRY_H
+
+#include <Arduino.h>
+#include "color_math.h"
+
+// 伞状灯具几何模型（编译期常量）
+// 每条伞骨 POSITIONS 个 LED，LED 编号 = rib * POSITIONS + position
+// position: 0 = 中心（伞顶）, POSITIONS-1 = 边缘（伞沿）
+// 所有渲染器（Luminaire 可视化、天气动画、频谱）共用这一份映射，
+// 换别的伞型只需要修改下面的模板参数。
+template <uint8_t RIBS, uint8_t POSITIONS>
+struct UmbrellaGeometry
+{
+    enum : uint16_t
+    {
+        NUM_RIBS = RIBS,
+        NUM_POSITIONS = POSITIONS,
+        EDGE_POSITION = POSITIONS - 1,
+        NUM_LEDS = RIBS * POSITIONS,
+        FRAME_SIZE = RIBS * POSITIONS * 3
+    };
+
+    // 伞骨 + 位置 → LED 编号（不做范围检查）
+    static constexpr uint16_t index(uint8_t rib, uint8_t position)
+    {
+        return (uint16_t)rib * POSITIONS + position;
+    }
+
+    static constexpr bool contains(int rib, int position)
+    {
+        return (unsigned)rib < RIBS && (unsigned)position < POSITIONS;
+    }
+
+    // 伞骨编号环绕（支持负数）
+    static constexpr uint8_t wrapRib(int rib)
+    {
+        return (uint8_t)(((rib % RIBS) + RIBS) % RIBS);
+    }
+
+    // ===== 帧缓冲写入（frame 为 FRAME_SIZE 字节的 RGB 数据）=====
+
+    static void setPixel(byte *frame, int rib, int position, uint8_t r, uint8_t g, uint8_t b)
+    {
+        if (!contains(rib, position))
+        {
+            return;
+        }
+        byte *p = frame + index(rib, position) * 3;
+        p[0] = r;
+        p[1] = g;
+        p[2] = b;
+    }
+
+    // 打包颜色版本（0xRRGGBB）
+    static void setPixel(byte *frame, int rib, int position, uint32_t color)
+    {
+        setPixel(frame, rib, position, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+    }
+
+    // 径向环：前 ribs 条伞骨的同一位置（画布只用到实际接入的伞数，见 LuminaireGroup::getCanvasRibs）
+    static void setRing(byte *frame, uint8_t position, uint32_t color, uint8_t ribs = RIBS)
+    {
+        if (position >= POSITIONS)
+        {
+            return;
+        }
+        byte *p = frame + position * 3;
+        for (uint8_t rib = 0; rib < ribs; rib++, p += POSITIONS * 3)
+        {
+            rgbWrite(p, color);
+        }
+    }
+
+    static void setRing(byte *frame, uint8_t position, uint8_t r, uint8_t g, uint8_t b)
+    {
+        setRing(frame, position, rgbPack(r, g, b));
+    }
+
+    // ===== 亚像素绘制（Q8.8 坐标，亮度按距离分配到相邻两个 LED，饱和叠加）=====
+
+    // 沿伞骨：position 为 Q8.8 位置（0 = 中心）
+    static void splatRib(byte *frame, int rib, int16_t position, uint32_t color)
+    {
+        int pos = position >> 8; // 算术右移，负数向下取整
+        uint8_t frac = position & 0xFF;
+        addPixel(frame, rib, pos, rgbScale8(color, 255 - frac));
+        if (frac > 0)
+        {
+            addPixel(frame, rib, pos + 1, rgbScale8(color, frac));
+        }
+    }
+
+    // 沿环：angle 为 Q8.8 伞骨编号，在前 ribs 条伞骨内环绕
+    static void splatRing(byte *frame, uint8_t position, uint16_t angle, uint32_t color, uint8_t ribs = RIBS)
+    {
+        uint8_t rib = (angle >> 8) % ribs;
+        uint8_t frac = angle & 0xFF;
+        addPixel(frame, rib, position, rgbScale8(color, 255 - frac));
+        if (frac > 0)
+        {
+            addPixel(frame, (rib + 1) % ribs, position, rgbScale8(color, frac));
+        }
+    }
+
+    // 饱和叠加到已有颜色上
+    static void addPixel(byte *frame, int rib, int position, uint32_t color)
+    {
+        if (!contains(rib, position))
+        {
+            return;
+        }
+        byte *p = frame + index(rib, position) * 3;
+        rgbWrite(p, rgbAdd(rgbRead(p), color));
+    }
+};
+
+// 当前灯具：12 条伞骨 × 6 个 LED = 72 LED
+typedef UmbrellaGeometry<12, 6> Umbrella;
+
+// 多把伞灯共用的画布：最多 UMBRELLA_CANVAS_UNITS 把伞并排展开成一把“宽伞”，
+// 伞骨连续编号（画布伞骨 = 第几把 × 12 + 伞骨）。LED 排列与单把伞相同，
+// 所以第 n 把伞的默认切片正好是画布的第 n 段 Umbrella::FRAME_SIZE 字节（见 luminaire_group.h）
+#define UMBRELLA_CANVAS_UNITS 4
+typedef UmbrellaGeometry<Umbrella::NUM_RIBS * UMBRELLA_CANVAS_UNITS, Umbrella::NUM_POSITIONS> UmbrellaCanvas;
+
+#endif
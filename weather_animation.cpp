@@ -1,63 +1,119 @@
 #include "weather_animation.h"
 #include "luminaire_controller.h"
+#include "umbrella_geometry.h"
+#include "color_math.h"
+#include "render_clock.h"
+#include "noise.h"
+#include "curves.h"
+#include "profiler.h"
 
 WeatherAnimation::WeatherAnimation()
     : controller(nullptr),
-      weatherCode("113"),
+      weatherCode(113),
       weatherType(WEATHER_SUNNY),
       cloudCover(0),
       precipitation(0.0),
       visibility(10),
-      lastAnimUpdate(0),
       animStartTime(0),
-      sunBreathPhase(0),
-      cloudFlowOffset(0),
-      lastCloudFlow(0),
-      sunPeekOut(false),
-      lastRainSpawn(0),
-      lastSnowSpawn(0),
       lastLightning(0),
-      lightningInterval(0),
-      fogFlowPhase(0),
-      lastFogUpdate(0)
+      lightningInterval(0)
 {
     // 初始化本地缓存
     memset(localBuffer, 0, sizeof(localBuffer));
     
-    // 初始化雨滴
-    for (int i = 0; i < MAX_RAINDROPS; i++)
-    {
-        raindrops[i].active = false;
-    }
-    
-    // 初始化雪花
-    for (int i = 0; i < MAX_SNOWFLAKES; i++)
-    {
-        snowflakes[i].active = false;
-    }
-    
     // 初始化闪电
     lightning.active = false;
+    lightning.sparked = false;
 }
 
 void WeatherAnimation::begin(LuminaireController *ctrl)
 {
     controller = ctrl;
-    animStartTime = millis();
+    animStartTime = renderClock.now();
 }
 
-void WeatherAnimation::updateWeatherData(const String &code, int cloud, float precip, int vis)
+void WeatherAnimation::updateWeatherData(int code, int cloud, float precip, int vis)
 {
+    WeatherType newType = parseWeatherCode(code);
+
+    // 天气类型变化时清空旧粒子
+    if (newType != weatherType)
+    {
+        particles.clear();
+    }
+
     weatherCode = code;
     cloudCover = cloud;
     precipitation = precip;
     visibility = vis;
-    weatherType = parseWeatherCode(code);
+    weatherType = newType;
+
+    configureEmitters();
 }
 
-WeatherType WeatherAnimation::parseWeatherCode(const String &code)
+void WeatherAnimation::configureEmitters()
+{
+    particles.disableEmitters();
+
+    if (weatherType == WEATHER_RAIN)
+    {
+        // 根据降水量决定雨滴生成频率和初速度
+        ParticleEmitter rain = {};
+        if (precipitation < 1.0)
+            rain.spawnInterval = 800; // 小雨
+        else if (precipitation < 5.0)
+            rain.spawnInterval = 400; // 中雨
+        else if (precipitation < 10.0)
+            rain.spawnInterval = 200; // 大雨
+        else
+            rain.spawnInterval = 100; // 暴雨
+        rain.spawnCount = precipitation < 10.0 ? 1 : 2;
+        rain.startPosition = 0;
+        rain.velocity = precipitation < 5.0 ? PARTICLE_FIXED(5.0) : PARTICLE_FIXED(6.5);
+        rain.acceleration = PARTICLE_FIXED(3.0); // 重力加速
+        rain.landPosition = PARTICLE_FIXED(Umbrella::EDGE_POSITION);
+        rain.endPosition = PARTICLE_FIXED(Umbrella::EDGE_POSITION);
+        rain.color = 0x3264FF;
+        particles.setEmitter(EMITTER_RAIN, rain);
+    }
+    else if (weatherType == WEATHER_SNOW)
+    {
+        // 雪花比雨慢 3 倍，落到边缘后停留（积雪）
+        ParticleEmitter snow = {};
+        if (precipitation < 1.0)
+            snow.spawnInterval = 1200;
+        else if (precipitation < 5.0)
+            snow.spawnInterval = 800;
+        else
+            snow.spawnInterval = 500;
+        snow.spawnCount = 1;
+        snow.startPosition = 0;
+        snow.velocity = PARTICLE_FIXED(1.5);
+        snow.acceleration = 0;
+        snow.landPosition = PARTICLE_FIXED(Umbrella::EDGE_POSITION);
+        snow.endPosition = PARTICLE_FIXED(Umbrella::EDGE_POSITION + 2);
+        snow.swayChance = 13; // 约 5%
+        snow.color = 0xC8DCFF;
+        particles.setEmitter(EMITTER_SNOW, snow);
+    }
+    else if (weatherType == WEATHER_THUNDERSTORM)
+    {
+        // 闪电击中边缘后迸出的火花（手动发射），向中心弹回并迅速熄灭
+        ParticleEmitter spark = {};
+        spark.spawnInterval = 0;
+        spark.startPosition = PARTICLE_FIXED(Umbrella::EDGE_POSITION);
+        spark.velocity = PARTICLE_FIXED(-6.0);
+        spark.acceleration = PARTICLE_FIXED(4.0);
+        spark.landPosition = PARTICLE_FIXED(Umbrella::NUM_POSITIONS); // 不会落地
+        spark.endPosition = PARTICLE_FIXED(Umbrella::NUM_POSITIONS);
+        spark.decay = 600;
+        spark.color = 0xFFF0C8;
+        particles.setEmitter(EMITTER_SPARK, spark);
+    }
+}
+
+WeatherType WeatherAnimation::parseWeatherCode(int codeNum)
 {
-    int codeNum = code.toInt();
     
     // 晴天
     if (codeNum == 113)
@@ -88,12 +144,17 @@ WeatherType WeatherAnimation::parseWeatherCode(const String &code)
 
 void WeatherAnimation::update()
 {
+    PROFILE_SCOPE(PROF_WEATHER_ANIM);
+
     if (!controller) return;
     
-    unsigned long now = millis();
+    unsigned long now = renderClock.now();
     
     // 清空本地缓存
     memset(localBuffer, 0, sizeof(localBuffer));
+
+    // 所有粒子共用一个时间步
+    particles.update(now);
     
     // 根据天气类型更新动画
     switch (weatherType)
@@ -127,224 +188,122 @@ void WeatherAnimation::update()
 // ============ 晴天动画 ============
 void WeatherAnimation::updateSunnyAnimation()
 {
-    unsigned long now = millis();
-    
-    // 3秒周期的呼吸效果
-    float breathCycle = (now % 3000) / 3000.0; // 0.0 - 1.0
-    float brightness = (sin(breathCycle * 2 * PI - PI/2) + 1.0) / 2.0; // 0.0 - 1.0
+    // 3秒周期的脉动（相位 0-255 为一整圈，从最暗开始，曲线见 curves.h）
+    uint8_t breathPhase = renderClock.phase8(3000);
+    uint8_t brightness = Curves::forEffect(CURVE_EFFECT_SUN, breathPhase); // 0 - 255
+    uint8_t dimness = 255 - brightness;
     
     // LED 0: 黄色高亮脉动（太阳核心，中心）
     int coreR = 255;
-    int coreG = 200 + (int)(55 * brightness);
+    int coreG = 200 + scale8(55, brightness);
     int coreB = 0;
-    setRadialRing(0, coreR, coreG, coreB);
+    Umbrella::setRing(localBuffer, 0, coreR, coreG, coreB);
     
     // LED 1: 金色光束
-    int beam1R = 220 - (int)(60 * (1.0 - brightness));
-    int beam1G = 160 - (int)(40 * (1.0 - brightness));
+    int beam1R = 220 - scale8(60, dimness);
+    int beam1G = 160 - scale8(40, dimness);
     int beam1B = 0;
-    setRadialRing(1, beam1R, beam1G, beam1B);
+    Umbrella::setRing(localBuffer, 1, beam1R, beam1G, beam1B);
     
     // LED 2: 金色光束（更淡）
-    int beam2R = 180 - (int)(60 * (1.0 - brightness));
-    int beam2G = 120 - (int)(40 * (1.0 - brightness));
+    int beam2R = 180 - scale8(60, dimness);
+    int beam2G = 120 - scale8(40, dimness);
     int beam2B = 0;
-    setRadialRing(2, beam2R, beam2G, beam2B);
+    Umbrella::setRing(localBuffer, 2, beam2R, beam2G, beam2B);
     
     // 其他LED保持暗
-    for (int pos = 3; pos < 6; pos++)
+    for (int pos = 3; pos < Umbrella::NUM_POSITIONS; pos++)
     {
-        setRadialRing(pos, 0, 0, 0);
+        Umbrella::setRing(localBuffer, pos, 0, 0, 0);
     }
 }
 
 // ============ 多云动画 ============
 void WeatherAnimation::updateCloudyAnimation()
 {
-    unsigned long now = millis();
-    
-    // 云团流动（每500ms更新）
-    if (now - lastCloudFlow > 500)
-    {
-        cloudFlowOffset = (cloudFlowOffset + 1) % 3;
-        lastCloudFlow = now;
-        
-        // 每3秒决定是否露出阳光
-        if ((now / 3000) % 2 == 0)
-            sunPeekOut = true;
-        else
-            sunPeekOut = false;
-    }
+    unsigned long now = renderClock.now();
     
     // 计算云的厚度（基于cloudCover）
     int grayLevel = map(cloudCover, 0, 100, 80, 200);
     
-    // LED 0: 中心（阳光或云）
-    if (sunPeekOut)
-    {
-        setRadialRing(0, 255, 220, 100); // 金色阳光
-    }
-    else
-    {
-        setRadialRing(0, grayLevel, grayLevel, grayLevel); // 灰白云
-    }
-    
-    // LED 1: 云团
-    int cloud1 = grayLevel - 20 + (cloudFlowOffset == 0 ? 30 : 0);
-    setRadialRing(1, cloud1, cloud1, cloud1);
+    // 云量越多，噪声阈值越低，阳光越少
+    int coverBias = map(cloudCover, 0, 100, -60, 90);
     
-    // LED 2: 云团
-    int cloud2 = grayLevel - 40 + (cloudFlowOffset == 1 ? 30 : 0);
-    setRadialRing(2, cloud2, cloud2, cloud2);
+    // 云团缓慢水平漂移，同时自身形状变化
+    uint16_t drift = now / 12;
+    uint16_t morph = now / 16;
     
-    // LED 3: 云团边缘
-    int cloud3 = grayLevel - 60 + (cloudFlowOffset == 2 ? 30 : 0);
-    setRadialRing(3, cloud3, cloud3, cloud3);
-    
-    // LED 4-5: 暗
-    for (int pos = 4; pos < 6; pos++)
+    for (uint8_t rib = 0; rib < Umbrella::NUM_RIBS; rib++)
     {
-        setRadialRing(pos, 0, 0, 0);
+        for (uint8_t pos = 0; pos < Umbrella::NUM_POSITIONS; pos++)
+        {
+            uint16_t x, y;
+            Noise::ledPosition(rib, pos, 96, x, y);
+            
+            // 云密度：噪声拉伸后加上云量偏置
+            int density = ((int)Noise::fbm8(x + drift, y, morph) - 128) * 3 + 128 + coverBias;
+            density = constrain(density, 0, 255);
+            
+            // 越靠近边缘越暗（中心：金色阳光 / 灰白云）
+            uint8_t falloff = 255 - pos * 255 / Umbrella::NUM_POSITIONS;
+            uint32_t sun = rgbScale8(0xFFDC64, falloff);
+            uint8_t gray = scale8(grayLevel, falloff);
+            
+            Umbrella::setPixel(localBuffer, rib, pos, rgbBlend8(sun, rgbPack(gray, gray, gray), density));
+        }
     }
 }
 
 // ============ 雨天动画 ============
 void WeatherAnimation::updateRainAnimation()
 {
-    unsigned long now = millis();
-    
-    // 根据降水量决定雨滴生成频率
-    int spawnInterval;
-    if (precipitation < 1.0)
-        spawnInterval = 800; // 小雨
-    else if (precipitation < 5.0)
-        spawnInterval = 400; // 中雨
-    else
-        spawnInterval = 200; // 大雨
-    
-    // 生成新雨滴
-    if (now - lastRainSpawn > spawnInterval)
-    {
-        spawnRaindrop();
-        lastRainSpawn = now;
-    }
-    
+    // 雨滴的生成和运动由粒子系统处理（发射频率由降水量配置）
     // 注意：不需要清空，因为 update() 已经清空了 localBuffer
-    
-    // 更新并绘制雨滴
-    for (int i = 0; i < MAX_RAINDROPS; i++)
-    {
-        if (!raindrops[i].active) continue;
-        
-        // 更新位置（加速下落）
-        unsigned long dt = now - raindrops[i].lastUpdate;
-        raindrops[i].position += raindrops[i].speed * dt / 1000.0;
-        raindrops[i].speed += 3.0 * dt / 1000.0; // 重力加速
-        raindrops[i].lastUpdate = now;
-        
-        // 检查是否到达底部（位置5是边缘）
-        if (raindrops[i].position >= 5.0)
-        {
-            // 产生涟漪效果（LED 5闪烁）
-            setRadialRing(5, 100, 150, 255);
-            raindrops[i].active = false;
-            continue;
-        }
-        
-        // 绘制雨滴
-        int pos = (int)raindrops[i].position;
-        setUmbrellaPixel(raindrops[i].rib, pos, 50, 100, 255);
-    }
+    renderParticles();
 }
 
-void WeatherAnimation::spawnRaindrop()
+// ============ 雪天动画 ============
+void WeatherAnimation::updateSnowAnimation()
 {
-    // 找到空闲的雨滴槽
-    for (int i = 0; i < MAX_RAINDROPS; i++)
-    {
-        if (!raindrops[i].active)
-        {
-            raindrops[i].rib = random(0, 12);
-            raindrops[i].position = 0.0;
-            raindrops[i].speed = 5.0; // 初始速度
-            raindrops[i].active = true;
-            raindrops[i].lastUpdate = millis();
-            break;
-        }
-    }
+    renderParticles();
 }
 
-// ============ 雪天动画 ============
-void WeatherAnimation::updateSnowAnimation()
+// ============ 粒子绘制 ============
+void WeatherAnimation::renderParticles()
 {
-    unsigned long now = millis();
-    
-    // 生成新雪花（比雨慢）
-    if (now - lastSnowSpawn > 1200)
-    {
-        spawnSnowflake();
-        lastSnowSpawn = now;
-    }
-    
-    // 注意：不需要清空，因为 update() 已经清空了 localBuffer
-    
-    // 更新并绘制雪花
-    for (int i = 0; i < MAX_SNOWFLAKES; i++)
+    for (uint8_t i = 0; i < particles.size(); i++)
     {
-        if (!snowflakes[i].active) continue;
-        
-        // 更新位置（慢速飘落）
-        unsigned long dt = now - snowflakes[i].lastUpdate;
-        snowflakes[i].position += snowflakes[i].speed * dt / 1000.0;
-        snowflakes[i].lastUpdate = now;
-        
-        // 摇摆效果（跳到相邻伞骨）
-        if (random(0, 100) < 5 && snowflakes[i].position > 1.0)
-        {
-            snowflakes[i].rib = (snowflakes[i].rib + (random(0, 2) ? 1 : -1) + 12) % 12;
-        }
-        
-        // 检查是否到达底部（位置5是边缘）
-        if (snowflakes[i].position >= 5.0)
+        uint8_t id = particles.emitterOf(i);
+        uint8_t rib = particles.rib(i);
+
+        if (particles.landed(i))
         {
-            // 积雪效果（在LED 5停留）
-            setUmbrellaPixel(snowflakes[i].rib, 5, 200, 220, 255);
-            
-            // 延迟失活
-            if (snowflakes[i].position >= 7.0)
+            if (id == EMITTER_RAIN)
+            {
+                // 产生涟漪效果（边缘一圈闪烁）
+                Umbrella::setRing(localBuffer, Umbrella::EDGE_POSITION, 100, 150, 255);
+            }
+            else if (id == EMITTER_SNOW)
             {
-                snowflakes[i].active = false;
+                // 积雪效果（在边缘停留）
+                Umbrella::setPixel(localBuffer, rib, Umbrella::EDGE_POSITION, 200, 220, 255);
             }
             continue;
         }
-        
-        // 绘制雪花（白色/淡蓝）
-        int pos = (int)snowflakes[i].position;
-        setUmbrellaPixel(snowflakes[i].rib, pos, 200, 220, 255);
-    }
-}
 
-void WeatherAnimation::spawnSnowflake()
-{
-    for (int i = 0; i < MAX_SNOWFLAKES; i++)
-    {
-        if (!snowflakes[i].active)
-        {
-            snowflakes[i].rib = random(0, 12);
-            snowflakes[i].position = 0.0;
-            snowflakes[i].speed = 1.5; // 比雨慢3倍
-            snowflakes[i].active = true;
-            snowflakes[i].lastUpdate = millis();
-            snowflakes[i].swayDirection = 0;
-            break;
-        }
+        uint32_t color = rgbScale8(particles.emitter(id).color, particles.life(i));
+
+        // 亚像素绘制：亮度分配到相邻两个 LED，20 FPS 下也能平滑移动
+        Umbrella::splatRib(localBuffer, rib, particles.position(i), color);
     }
 }
 
 // ============ 雷暴动画 ============
+static const unsigned long LIGHTNING_DURATION = 50; // 闪电从中心到边缘的时间（ms）
+
 void WeatherAnimation::updateThunderstormAnimation()
 {
-    unsigned long now = millis();
+    unsigned long now = renderClock.now();
     
     // 触发新闪电（随机间隔2-5秒）
     if (!lightning.active && now - lastLightning > lightningInterval)
@@ -356,9 +315,9 @@ void WeatherAnimation::updateThunderstormAnimation()
     
     // 绘制背景云层（注意：update() 已经清空了 localBuffer，所以直接绘制）
     int grayLevel = 60;
-    for (int pos = 0; pos < 6; pos++)
+    for (int pos = 0; pos < Umbrella::NUM_POSITIONS; pos++)
     {
-        setRadialRing(pos, grayLevel, grayLevel, grayLevel);
+        Umbrella::setRing(localBuffer, pos, grayLevel, grayLevel, grayLevel);
     }
     
     // 更新闪电动画
@@ -366,25 +325,38 @@ void WeatherAnimation::updateThunderstormAnimation()
     {
         unsigned long elapsed = now - lightning.startTime;
         
-        if (elapsed < 50) // 闪电持续50ms
+        // 闪电持续 LIGHTNING_DURATION；即使这段时间内一帧都没渲染（卡顿 / 丢帧），
+        // 也保证至少画出一帧完整闪电（打到边缘并迸出火花）后才结束
+        if (elapsed < LIGHTNING_DURATION || !lightning.sparked)
         {
-            lightning.progress = elapsed / 50.0;
+            lightning.progress = elapsed >= LIGHTNING_DURATION ? 255 : elapsed * 255 / LIGHTNING_DURATION;
             
-            // 闪电从LED 0冲向LED 5（中心到边缘）
-            int lightningPos = (int)(lightning.progress * 5);
+            // 闪电从中心冲向边缘
+            int lightningPos = lightning.progress * Umbrella::EDGE_POSITION / 255;
             
             for (int i = 0; i < lightning.ribCount; i++)
             {
                 for (int pos = 0; pos <= lightningPos; pos++)
                 {
-                    setUmbrellaPixel(lightning.ribs[i], pos, 255, 255, 255);
+                    Umbrella::setPixel(localBuffer, lightning.ribs[i], pos, 255, 255, 255);
                 }
             }
             
-            // LED 5（边缘）全体爆闪
-            if (lightningPos >= 4)
+            // 边缘全体爆闪
+            if (lightningPos >= Umbrella::EDGE_POSITION - 1)
             {
-                setRadialRing(5, 255, 255, 255);
+                Umbrella::setRing(localBuffer, Umbrella::EDGE_POSITION, 255, 255, 255);
+
+                // 击中边缘时在两侧伞骨迸出火花
+                if (!lightning.sparked)
+                {
+                    for (int i = 0; i < lightning.ribCount; i++)
+                    {
+                        particles.emit(EMITTER_SPARK, Umbrella::wrapRib(lightning.ribs[i] - 1));
+                        particles.emit(EMITTER_SPARK, Umbrella::wrapRib(lightning.ribs[i] + 1));
+                    }
+                    lightning.sparked = true;
+                }
             }
         }
         else
@@ -392,80 +364,60 @@ void WeatherAnimation::updateThunderstormAnimation()
             lightning.active = false;
         }
     }
+
+    // 火花
+    renderParticles();
 }
 
 void WeatherAnimation::triggerLightning()
 {
     lightning.ribCount = random(1, 3); // 1-2条闪电
-    lightning.ribs[0] = random(0, 12);
+    lightning.ribs[0] = random(0, Umbrella::NUM_RIBS);
     if (lightning.ribCount == 2)
     {
-        lightning.ribs[1] = (lightning.ribs[0] + random(2, 6)) % 12;
+        lightning.ribs[1] = Umbrella::wrapRib(lightning.ribs[0] + random(2, 6));
     }
-    lightning.progress = 0.0;
+    lightning.progress = 0;
     lightning.active = true;
-    lightning.startTime = millis();
+    lightning.sparked = false;
+    lightning.startTime = renderClock.now();
 }
 
 // ============ 雾天动画 ============
 void WeatherAnimation::updateFogAnimation()
 {
-    unsigned long now = millis();
-    
-    // 雾气流动（每100ms更新）
-    if (now - lastFogUpdate > 100)
-    {
-        fogFlowPhase = (fogFlowPhase + 1) % 360;
-        lastFogUpdate = now;
-    }
+    unsigned long now = renderClock.now();
     
     // 基于能见度决定雾的浓度
     int fogDensity = map(visibility, 0, 10, 150, 50);
     
-    // 所有LED朦胧效果（上下流动）
-    for (int pos = 0; pos < 6; pos++)
+    // 雾气缓慢飘移，同时翻滚变化
+    uint16_t flow = now / 10;
+    uint16_t churn = now / 8;
+    
+    for (uint8_t rib = 0; rib < Umbrella::NUM_RIBS; rib++)
     {
-        float wave = sin((fogFlowPhase + pos * 30) * PI / 180.0);
-        int brightness = fogDensity + (int)(20 * wave);
-        brightness = constrain(brightness, 30, 200);
-        
-        setRadialRing(pos, brightness, brightness, brightness);
+        for (uint8_t pos = 0; pos < Umbrella::NUM_POSITIONS; pos++)
+        {
+            uint16_t x, y;
+            Noise::ledPosition(rib, pos, 80, x, y);
+            
+            int wave = (int)Noise::noise8(x, y - flow, churn) - 128; // -128 - 127
+            int brightness = fogDensity + ((40 * wave) >> 7);
+            brightness = constrain(brightness, 30, 200);
+            
+            Umbrella::setPixel(localBuffer, rib, pos, brightness, brightness, brightness);
+        }
     }
 }
 
 // ============ 工具函数 ============
-int WeatherAnimation::getUmbrellaLED(int rib, int position)
-{
-    if (rib < 0 || rib >= 12 || position < 0 || position >= 6)
-        return -1;
-    return rib * 6 + position;
-}
-
-void WeatherAnimation::setUmbrellaPixel(int rib, int position, int r, int g, int b)
-{
-    int ledNum = getUmbrellaLED(rib, position);
-    if (ledNum >= 0 && ledNum < 72)
-    {
-        localBuffer[ledNum * 3 + 0] = (byte)r;
-        localBuffer[ledNum * 3 + 1] = (byte)g;
-        localBuffer[ledNum * 3 + 2] = (byte)b;
-    }
-}
-
-void WeatherAnimation::setRadialRing(int position, int r, int g, int b)
-{
-    for (int rib = 0; rib < 12; rib++)
-    {
-        setUmbrellaPixel(rib, position, r, g, b);
-    }
-}
-
 void WeatherAnimation::flushToController()
 {
     if (!controller) return;
     
-    // 一次性发送所有72个LED的数据
-    controller->updateAllLEDs(localBuffer, 72 * 3);
+    // 一次性发送所有LED的数据
+    controller->updateAllLEDs(localBuffer, Umbrella::FRAME_SIZE);
     
     // 调试：每5秒打印一次动画状态
     static unsigned long lastDebug = 0;
@@ -485,20 +437,3 @@ void WeatherAnimation::clear()
     if (!controller) return;
     controller->clear();
 }
-
-uint32_t WeatherAnimation::blendColors(uint32_t color1, uint32_t color2, float ratio)
-{
-    uint8_t r1 = (color1 >> 16) & 0xFF;
-    uint8_t g1 = (color1 >> 8) & 0xFF;
-    uint8_t b1 = color1 & 0xFF;
-    
-    uint8_t r2 = (color2 >> 16) & 0xFF;
-    uint8_t g2 = (color2 >> 8) & 0xFF;
-    uint8_t b2 = color2 & 0xFF;
-    
-    uint8_t r = r1 + (r2 - r1) * ratio;
-    uint8_t g = g1 + (g2 - g1) * ratio;
-    uint8_t b = b1 + (b2 - b1) * ratio;
-    
-    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
-}